@@ -38,6 +38,7 @@ struct HydroGPUApp : public ::GLApp::GLApp {
 	std::shared_ptr<CLCommon::CLCommon> clCommon;
 	bool hasGLSharing;
 	bool hasFP64;
+	bool hasFP16;
 	
 	std::shared_ptr<ImGuiCommon::ImGuiCommon> gui;
 
@@ -81,6 +82,7 @@ struct HydroGPUApp : public ::GLApp::GLApp {
 	int currentFrame;
 	bool useFixedDT;
 	real fixedDT;
+	bool autotune;	//see Solver/Autotuner.h
 	float cfl;
 	bool showHeatMap;
 	bool showIso3D;
@@ -133,6 +135,10 @@ struct HydroGPUApp : public ::GLApp::GLApp {
 	virtual void resize(int width, int height);
 	virtual void update();
 	virtual void sdlEvent(SDL_Event &event);
+
+protected:
+	//gen, init, and resetState a solver, autotuning it first if that's enabled and there's nothing on file for it
+	SolverPtr createSolver(SolverGenFunc gen);
 };
 
 inline std::ostream& operator<<(std::ostream& o, real4 v) {
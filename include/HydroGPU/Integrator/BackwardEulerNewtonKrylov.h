@@ -0,0 +1,67 @@
+#pragma once
+
+#include "HydroGPU/Integrator/Integrator.h"
+#include "HydroGPU/Shared/Common.h"	//cl shared header
+
+namespace HydroGPU {
+namespace Integrator {
+
+/*
+implicit backward Euler, solving F(u) = u - u^n - dt L(u) = 0 with Newton's method,
+whose linear systems J x = -F(u) are solved with BiCGStab, using the Jacobian-vector products
+J v = v - dt (L(u + eps v) - L(u)) / eps
+where L is whatever the solver's integrate callback computes, so no Jacobian is ever built.
+all the dot products and BiCGStab coefficients stay on the device (scalarsBuffer, the KRYLOV_* of Shared/Common.h),
+the host only reads back a residual norm for each convergence check.
+*/
+struct BackwardEulerNewtonKrylov : public Integrator {
+	typedef Integrator Super;
+	BackwardEulerNewtonKrylov(HydroGPU::Solver::Solver* solver);
+	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback);
+
+protected:
+	cl::Buffer oldStateBuffer;	//u^n
+	cl::Buffer uBuffer;	//the Newton iterate.  the state buffer holds it too, except while a Jacobian-vector product perturbs it
+	cl::Buffer derivUBuffer;	//L(u)
+	cl::Buffer derivPerturbedBuffer;	//L(u + eps v)
+	cl::Buffer rBuffer;
+	cl::Buffer rHatBuffer;
+	cl::Buffer pBuffer;
+	cl::Buffer vBuffer;
+	cl::Buffer tBuffer;
+	cl::Buffer xBuffer;
+
+	cl::Buffer scalarsBuffer;
+	cl::Buffer partialsBuffer;
+	size_t numPartials;
+
+	cl::Kernel multAddKernel;
+	cl::Kernel dotBufferKernel;
+	cl::Kernel reduceScalarKernel;
+	cl::Kernel krylovInitKernel;
+	cl::Kernel krylovUpdatePKernel;
+	cl::Kernel krylovAlphaKernel;
+	cl::Kernel krylovOmegaKernel;
+	cl::Kernel krylovUpdateSKernel;
+	cl::Kernel krylovUpdateXRKernel;
+	cl::Kernel krylovPerturbKernel;
+	cl::Kernel krylovJacobianVectorKernel;
+
+	int newtonMaxIter;
+	real newtonTolerance;
+	int krylovMaxIter;
+	real krylovTolerance;
+
+	//scalarsBuffer[slot] = a . b.  if prevSlot >= 0 then the old value goes there first
+	void dot(cl::Buffer a, cl::Buffer b, int slot, int prevSlot = -1);
+	real readScalar(int slot);
+	void calcDeriv(cl::Buffer derivBuffer, std::function<void(cl::Buffer)> callback);
+
+	//result = J v, about u
+	void applyJacobian(cl::Buffer result, cl::Buffer v, real dt, std::function<void(cl::Buffer)> callback);
+
+	void enqueue1d(cl::Kernel& kernel);
+};
+
+}
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "HydroGPU/Integrator/Integrator.h"
+#include "HydroGPU/Solver/Solver.h"
+#include "HydroGPU/HydroGPUApp.h"
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace HydroGPU {
+namespace Integrator {
+
+/*
+explicit Runge-Kutta with an embedded lower order solution, for error-controlled step sizes
+the Tableau's last row of a has to be b (first same as last), so the last stage state is the solution,
+and the last stage deriv is only for the error estimate.
+
+each step, the error is the max over all the states of the cells of
+|dt sum_j (b_j - bhat_j) k_j| / (absTol + relTol max(|u^n|, |u^n+1|))
+(lua 'adaptiveTolerance' for relTol, 'adaptiveAbsTolerance' for absTol)
+and the steps with an error over 1 are done over (Solver::update), with a smaller dt.
+the next dt is the usual dt (safety err^(-1/(ErrorOrder+1))), and never more than the CFL dt.
+if a step calls integrate() more than once (i.e. sources) then it's the max of all of them.
+*/
+template<typename Tableau>
+struct EmbeddedRungeKutta : public Integrator {
+	enum { stages = Tableau::Stages };
+	typedef Integrator Super;
+	EmbeddedRungeKutta(HydroGPU::Solver::Solver* solver);
+	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback);
+	virtual real limitTimestep(real dt);
+	virtual void beginStep();
+	virtual bool endStep(real& dt);
+protected:
+	std::array<cl::Buffer, stages> derivBuffer;
+	cl::Buffer oldStateBuffer;	//u^n of the integrate() call
+	cl::Buffer restoreBuffer;	//the state at beginStep, for rejected steps
+	cl::Buffer errorBuffer;	//per-work-group partial error norms
+	size_t numErrorGroups;
+
+	enum { maxTerms = 8 };	//of linearCombination and embeddedErrorNorm
+	static_assert(stages <= maxTerms, "linearCombination doesn't take that many terms");
+	cl::Kernel linearCombinationKernel;
+	cl::Kernel errorNormKernel;
+
+	real relTol, absTol;
+	real error;	//of the current step
+	real nextDt;
+	bool lastRejected;
+	int numRejected;	//in a row
+};
+
+template<typename Tableau>
+EmbeddedRungeKutta<Tableau>::EmbeddedRungeKutta(HydroGPU::Solver::Solver* solver)
+: Super(solver)
+, relTol(1e-6)
+, absTol(1e-6)
+, error(0)
+, nextDt(std::numeric_limits<real>::infinity())
+, lastRejected(false)
+, numRejected(0)
+{
+	solver->app->lua["adaptiveTolerance"] >> relTol;
+	solver->app->lua["adaptiveAbsTolerance"] >> absTol;
+
+	int length = solver->numStates() * solver->getVolume();
+	size_t bufferSize = solver->storageSize * length;
+	for (int i = 0; i < stages; ++i) {
+		derivBuffer[i] = solver->cl.alloc(bufferSize, std::string() + "EmbeddedRungeKutta::derivBuffer[" + std::to_string(i) + "]");
+		if (solver->derivOverwrite) solver->cl.zero(derivBuffer[i], bufferSize);
+	}
+	oldStateBuffer = solver->cl.alloc(bufferSize, "EmbeddedRungeKutta::oldStateBuffer");
+	restoreBuffer = solver->cl.alloc(bufferSize, "EmbeddedRungeKutta::restoreBuffer");
+
+	size_t l = solver->localSize1d[0];
+	numErrorGroups = (length + l - 1) / l;
+	errorBuffer = solver->cl.alloc(solver->realSize * numErrorGroups, "EmbeddedRungeKutta::errorBuffer");
+
+	linearCombinationKernel = cl::Kernel(solver->program, "linearCombination");
+	linearCombinationKernel.setArg(0, solver->stateBuffer);
+	linearCombinationKernel.setArg(1, oldStateBuffer);
+	linearCombinationKernel.setArg(3, length);
+
+	errorNormKernel = cl::Kernel(solver->program, "embeddedErrorNorm");
+	CLCommon::setArgs(errorNormKernel, errorBuffer, oldStateBuffer, solver->stateBuffer, cl::Local(l * solver->realSize), length);
+	solver->setRealArg(errorNormKernel, 5, absTol);
+	solver->setRealArg(errorNormKernel, 6, relTol);
+
+	for (int j = 0; j < maxTerms; ++j) {
+		linearCombinationKernel.setArg(5 + 2 * j, solver->stateBuffer);
+		solver->setRealArg(linearCombinationKernel, 6 + 2 * j, 0);
+		errorNormKernel.setArg(8 + 2 * j, solver->stateBuffer);
+		solver->setRealArg(errorNormKernel, 9 + 2 * j, 0);
+	}
+}
+
+template<typename Tableau>
+void EmbeddedRungeKutta<Tableau>::integrate(real dt, std::function<void(cl::Buffer)> callback) {
+	size_t length = solver->numStates() * solver->getVolume();
+	size_t bufferSize = solver->storageSize * length;
+	size_t l = solver->localSize1d[0];
+	cl::NDRange globalSize1d(numErrorGroups * l);
+
+	//k_0 = L(u^n)
+	if (!solver->derivOverwrite) solver->cl.zero(derivBuffer[0], bufferSize);
+	callback(derivBuffer[0]);
+
+	for (int i = 1; i < stages; ++i) {
+		//u^(i) = u^n + dt sum j=0 to i-1 of a_ij k_j.  the first stage saves u^n off of the state as it goes.
+		linearCombinationKernel.setArg(5, i == 1 ? solver->stateBuffer : oldStateBuffer);
+		solver->setRealArg(linearCombinationKernel, 6, 1);
+		int count = 1;
+		for (int j = 0; j < i; ++j) {
+			if (!Tableau::a(i,j)) continue;
+			linearCombinationKernel.setArg(5 + 2 * count, derivBuffer[j]);
+			solver->setRealArg(linearCombinationKernel, 6 + 2 * count, Tableau::a(i,j) * dt);
+			++count;
+		}
+		linearCombinationKernel.setArg(2, (int)(i == 1));
+		linearCombinationKernel.setArg(4, count);
+		solver->commands.enqueueNDRangeKernel(linearCombinationKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+
+		if (!solver->derivOverwrite) solver->cl.zero(derivBuffer[i], bufferSize);
+		callback(derivBuffer[i]);
+	}
+	//the state is now the last stage, which is u^n+1
+
+	int count = 0;
+	for (int j = 0; j < stages; ++j) {
+		real e = Tableau::b(j) - Tableau::bhat(j);
+		if (!e) continue;
+		errorNormKernel.setArg(8 + 2 * count, derivBuffer[j]);
+		solver->setRealArg(errorNormKernel, 9 + 2 * count, e * dt);
+		++count;
+	}
+	errorNormKernel.setArg(7, count);
+	solver->commands.enqueueNDRangeKernel(errorNormKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+
+	std::vector<real> partialErrors(numErrorGroups);
+	solver->readReals(errorBuffer, partialErrors.data(), partialErrors.size(), solver->realSize);
+	for (real e : partialErrors) error = std::max(error, e);
+}
+
+template<typename Tableau>
+real EmbeddedRungeKutta<Tableau>::limitTimestep(real dt) {
+	return std::min(dt, nextDt);
+}
+
+template<typename Tableau>
+void EmbeddedRungeKutta<Tableau>::beginStep() {
+	error = 0;
+	solver->commands.enqueueCopyBuffer(solver->stateBuffer, restoreBuffer, 0, 0, solver->storageSize * solver->numStates() * solver->getVolume());
+}
+
+template<typename Tableau>
+bool EmbeddedRungeKutta<Tableau>::endStep(real& dt) {
+	const real safety = .9, minFactor = .2, maxFactor = 5.;
+	const int maxRejected = 10;
+
+	real factor = error > 0 ? safety * pow(error, -1. / (Tableau::ErrorOrder + 1)) : maxFactor;
+	factor = std::max(minFactor, std::min(maxFactor, factor));
+
+	if (error <= 1 || numRejected >= maxRejected) {
+		if (!(error <= 1)) std::cout << "EmbeddedRungeKutta: step still has error " << error << " after " << numRejected << " retries -- keeping it" << std::endl;
+		//don't grow right after a rejection
+		nextDt = dt * (lastRejected ? std::min<real>(factor, 1) : factor);
+		lastRejected = false;
+		numRejected = 0;
+		return true;
+	}
+
+	solver->commands.enqueueCopyBuffer(restoreBuffer, solver->stateBuffer, 0, 0, solver->storageSize * solver->numStates() * solver->getVolume());
+	dt *= std::min<real>(factor, safety);
+	error = 0;
+	lastRejected = true;
+	++numRejected;
+	return false;
+}
+
+//"A 3(2) pair of Runge-Kutta formulas" by P. Bogacki and L. F. Shampine, Appl. Math. Lett. 2 (1989)
+struct BogackiShampine32Tableau {
+	enum { Stages = 4, ErrorOrder = 2 };
+	static real a(int i, int j) { static real m[Stages][Stages] = {
+		{0, 0, 0, 0},
+		{1./2., 0, 0, 0},
+		{0, 3./4., 0, 0},
+		{2./9., 1./3., 4./9., 0},
+	}; return m[i][j]; }
+	static real b(int j) { return a(Stages-1, j); }
+	static real bhat(int j) { static real m[Stages] = {7./24., 1./4., 1./3., 1./8.}; return m[j]; }
+};
+typedef EmbeddedRungeKutta<BogackiShampine32Tableau> BogackiShampine32;
+
+//"A family of embedded Runge-Kutta formulae" by J. R. Dormand and P. J. Prince, J. Comput. Appl. Math. 6 (1980)
+struct DormandPrince54Tableau {
+	enum { Stages = 7, ErrorOrder = 4 };
+	static real a(int i, int j) { static real m[Stages][Stages] = {
+		{0, 0, 0, 0, 0, 0, 0},
+		{1./5., 0, 0, 0, 0, 0, 0},
+		{3./40., 9./40., 0, 0, 0, 0, 0},
+		{44./45., -56./15., 32./9., 0, 0, 0, 0},
+		{19372./6561., -25360./2187., 64448./6561., -212./729., 0, 0, 0},
+		{9017./3168., -355./33., 46732./5247., 49./176., -5103./18656., 0, 0},
+		{35./384., 0, 500./1113., 125./192., -2187./6784., 11./84., 0},
+	}; return m[i][j]; }
+	static real b(int j) { return a(Stages-1, j); }
+	static real bhat(int j) { static real m[Stages] = {5179./57600., 0, 7571./16695., 393./640., -92097./339200., 187./2100., 1./40.}; return m[j]; }
+};
+typedef EmbeddedRungeKutta<DormandPrince54Tableau> DormandPrince54;
+
+}
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "HydroGPU/Integrator/Integrator.h"
+#include "HydroGPU/Solver/Solver.h"
+#include <array>
+#include <cmath>
+
+namespace HydroGPU {
+namespace Integrator {
+
+/*
+implicit-explicit Runge-Kutta, for du/dt = L(u) + S(u) with a stiff per-cell source S
+L gets the explicit tableau aE/bE, S the diagonally implicit one aI/bI.  stage i is
+	u* = u^n + dt sum j<i of (aE_ij K_j + aI_ij S_j)
+	u^(i) = u* + dt aI_ii S(u^(i))	(the solver's implicitCallback, a Newton solve per cell)
+	K_i = L(u^(i))
+and u^n+1 = u^n + dt sum j of (bE_j K_j + bI_j S_j), which is the last stage already for the stiffly accurate tableaux.
+so dt is up to the CFL of L alone.
+through plain integrate() (solvers without an implicit source) it is just the explicit tableau.
+*/
+template<typename Tableau>
+struct IMEXRungeKutta : public Integrator {
+	enum { stages = Tableau::Stages };
+	typedef Integrator Super;
+	IMEXRungeKutta(HydroGPU::Solver::Solver* solver);
+	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback);
+	virtual void integrateIMEX(
+		real dt,
+		std::function<void(cl::Buffer)> explicitCallback,
+		std::function<void(cl::Buffer)> sourceCallback,
+		std::function<void(cl::Buffer, real)> implicitCallback);
+protected:
+	bool derivNeeded(int i);
+	bool sourceNeeded(int i);
+	bool stifflyAccurate(bool implicit);
+
+	std::array<cl::Buffer, stages> derivBuffer;	//K_i
+	std::array<cl::Buffer, stages> sourceBuffer;	//S_i
+	cl::Buffer oldStateBuffer;	//u^n
+
+	enum { maxTerms = 8 };	//of linearCombination
+	static_assert(1 + 2 * stages <= maxTerms, "linearCombination doesn't take that many terms");
+	cl::Kernel linearCombinationKernel;
+};
+
+template<typename Tableau>
+bool IMEXRungeKutta<Tableau>::derivNeeded(int i) {
+	if (Tableau::bE(i) != 0) return true;
+	for (int m = i + 1; m < stages; ++m) {
+		if (Tableau::aE(m,i) != 0) return true;
+	}
+	return false;
+}
+
+template<typename Tableau>
+bool IMEXRungeKutta<Tableau>::sourceNeeded(int i) {
+	if (Tableau::bI(i) != 0) return true;
+	for (int m = i + 1; m < stages; ++m) {
+		if (Tableau::aI(m,i) != 0) return true;
+	}
+	return false;
+}
+
+//whether b is the last row of a (for the implicit tableau too, if it's used), so u^n+1 is the last stage
+template<typename Tableau>
+bool IMEXRungeKutta<Tableau>::stifflyAccurate(bool implicit) {
+	for (int j = 0; j < stages; ++j) {
+		if (Tableau::bE(j) != Tableau::aE(stages-1,j)) return false;
+		if (implicit && Tableau::bI(j) != Tableau::aI(stages-1,j)) return false;
+	}
+	return true;
+}
+
+template<typename Tableau>
+IMEXRungeKutta<Tableau>::IMEXRungeKutta(HydroGPU::Solver::Solver* solver)
+: Super(solver)
+{
+	int length = solver->numStates() * solver->getVolume();
+	size_t bufferSize = solver->storageSize * length;
+	for (int i = 0; i < stages; ++i) {
+		if (derivNeeded(i)) {
+			derivBuffer[i] = solver->cl.alloc(bufferSize, std::string() + "IMEXRungeKutta::derivBuffer[" + std::to_string(i) + "]");
+			if (solver->derivOverwrite) solver->cl.zero(derivBuffer[i], bufferSize);
+		}
+		//implicitSource only writes the interior
+		sourceBuffer[i] = solver->cl.alloc(bufferSize, std::string() + "IMEXRungeKutta::sourceBuffer[" + std::to_string(i) + "]");
+		solver->cl.zero(sourceBuffer[i], bufferSize);
+	}
+	oldStateBuffer = solver->cl.alloc(bufferSize, "IMEXRungeKutta::oldStateBuffer");
+
+	linearCombinationKernel = cl::Kernel(solver->program, "linearCombination");
+	linearCombinationKernel.setArg(0, solver->stateBuffer);
+	linearCombinationKernel.setArg(1, solver->stateBuffer);
+	linearCombinationKernel.setArg(2, 0);
+	linearCombinationKernel.setArg(3, length);
+	linearCombinationKernel.setArg(5, oldStateBuffer);
+	solver->setRealArg(linearCombinationKernel, 6, 1);
+	for (int j = 1; j < maxTerms; ++j) {
+		linearCombinationKernel.setArg(5 + 2 * j, solver->stateBuffer);
+		solver->setRealArg(linearCombinationKernel, 6 + 2 * j, 0);
+	}
+}
+
+template<typename Tableau>
+void IMEXRungeKutta<Tableau>::integrate(real dt, std::function<void(cl::Buffer)> callback) {
+	integrateIMEX(dt, callback, nullptr, nullptr);
+}
+
+template<typename Tableau>
+void IMEXRungeKutta<Tableau>::integrateIMEX(
+	real dt,
+	std::function<void(cl::Buffer)> explicitCallback,
+	std::function<void(cl::Buffer)> sourceCallback,
+	std::function<void(cl::Buffer, real)> implicitCallback)
+{
+	size_t length = solver->numStates() * solver->getVolume();
+	size_t bufferSize = solver->storageSize * length;
+	size_t l = solver->localSize1d[0];
+	cl::NDRange globalSize1d((length + l - 1) / l * l);
+
+	//u^n + dt sum j<n of (aE_nj K_j + aI_nj S_j) into the state, with aE/aI as bE/bI for the final sum
+	auto combine = [&](int n, std::function<real(int)> explicitCoeff, std::function<real(int)> implicitCoeff) {
+		int count = 1;
+		for (int j = 0; j < n; ++j) {
+			if (explicitCoeff(j) != 0) {
+				linearCombinationKernel.setArg(5 + 2 * count, derivBuffer[j]);
+				solver->setRealArg(linearCombinationKernel, 6 + 2 * count, explicitCoeff(j) * dt);
+				++count;
+			}
+			if (implicitCallback && implicitCoeff(j) != 0) {
+				linearCombinationKernel.setArg(5 + 2 * count, sourceBuffer[j]);
+				solver->setRealArg(linearCombinationKernel, 6 + 2 * count, implicitCoeff(j) * dt);
+				++count;
+			}
+		}
+		linearCombinationKernel.setArg(4, count);
+		solver->commands.enqueueNDRangeKernel(linearCombinationKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+	};
+
+	solver->commands.enqueueCopyBuffer(solver->stateBuffer, oldStateBuffer, 0, 0, bufferSize);
+
+	for (int i = 0; i < stages; ++i) {
+		if (i > 0) {
+			combine(i, [&](int j) { return Tableau::aE(i,j); }, [&](int j) { return Tableau::aI(i,j); });
+		}
+
+		//the implicit solve, or just S(u*) for a zero diagonal
+		if (implicitCallback && (Tableau::aI(i,i) != 0 || sourceNeeded(i))) {
+			implicitCallback(sourceBuffer[i], Tableau::aI(i,i) * dt);
+		}
+
+		if (derivNeeded(i)) {
+			if (!solver->derivOverwrite) solver->cl.zero(derivBuffer[i], bufferSize);
+			explicitCallback(derivBuffer[i]);
+		}
+	}
+
+	if (!stifflyAccurate((bool)implicitCallback)) {
+		combine(stages, [&](int j) { return Tableau::bE(j); }, [&](int j) { return Tableau::bI(j); });
+	}
+}
+
+/*
+ARS(2,2,2), from "Implicit-explicit Runge-Kutta methods for time-dependent partial differential equations"
+by U. M. Ascher, S. J. Ruuth, R. J. Spiteri, Appl. Numer. Math. 25 (1997)
+L-stable and stiffly accurate
+*/
+struct IMEXRungeKuttaARS222Tableau {
+	enum { Stages = 3 };
+	static real gamma() { return 1. - 1. / sqrt(2.); }
+	static real delta() { return 1. - 1. / (2. * gamma()); }
+	static real aE(int i, int j) { real m[Stages][Stages] = {
+		{0, 0, 0},
+		{gamma(), 0, 0},
+		{delta(), 1. - delta(), 0},
+	}; return m[i][j]; }
+	static real bE(int j) { return aE(Stages-1, j); }
+	static real aI(int i, int j) { real m[Stages][Stages] = {
+		{0, 0, 0},
+		{0, gamma(), 0},
+		{0, 1. - gamma(), gamma()},
+	}; return m[i][j]; }
+	static real bI(int j) { return aI(Stages-1, j); }
+};
+typedef IMEXRungeKutta<IMEXRungeKuttaARS222Tableau> IMEXRungeKuttaARS222;
+
+/*
+SSP2(2,2,2), from "Implicit-explicit Runge-Kutta schemes and applications to hyperbolic systems with relaxation"
+by L. Pareschi and G. Russo, J. Sci. Comput. 25 (2005)
+the explicit part is the strong stability preserving RK2 (Heun)
+*/
+struct IMEXRungeKuttaSSP2_222Tableau {
+	enum { Stages = 2 };
+	static real gamma() { return 1. - 1. / sqrt(2.); }
+	static real aE(int i, int j) { real m[Stages][Stages] = {
+		{0, 0},
+		{1, 0},
+	}; return m[i][j]; }
+	static real bE(int j) { return .5; }
+	static real aI(int i, int j) { real m[Stages][Stages] = {
+		{gamma(), 0},
+		{1. - 2. * gamma(), gamma()},
+	}; return m[i][j]; }
+	static real bI(int j) { return .5; }
+};
+typedef IMEXRungeKutta<IMEXRungeKuttaSSP2_222Tableau> IMEXRungeKuttaSSP2_222;
+
+}
+}
@@ -12,8 +12,34 @@ namespace Integrator {
 
 struct Integrator {
 	HydroGPU::Solver::Solver* solver;
+
+	//whether the callback is to add onto what's in the buffer it's given.  otherwise it can overwrite it (see Solver::derivOverwrite)
+	enum { accumulatesDeriv = 0 };
+
 	Integrator(HydroGPU::Solver::Solver* solver);
 	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback) = 0;
+
+	/*
+	step size control, for the embedded integrators.  Solver::update caps its CFL dt with limitTimestep,
+	and calls beginStep before step() and endStep after.
+	if endStep rejects the step then it has put the state back, and set dt to retry with.
+	*/
+	virtual real limitTimestep(real dt) { return dt; }
+	virtual void beginStep() {}
+	virtual bool endStep(real& dt) { return true; }
+
+	/*
+	for du/dt = L(u) + S(u), with a stiff per-cell source S.
+	explicitCallback is L, as for integrate().  sourceCallback adds S(state) into the buffer it's given, like any other callback.
+	implicitCallback(sourceBuffer, sourceDt) replaces the state u* with the u = u* + sourceDt S(u) of each cell, and writes S(u) to sourceBuffer.
+	the IMEX integrators use the implicit one.  the rest integrate L and then S, one after the other,
+	or L + S in one callback with Solver::singlePassRHS.
+	*/
+	virtual void integrateIMEX(
+		real dt,
+		std::function<void(cl::Buffer)> explicitCallback,
+		std::function<void(cl::Buffer)> sourceCallback,
+		std::function<void(cl::Buffer, real)> implicitCallback);
 };
 
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "HydroGPU/Integrator/Integrator.h"
+
+namespace HydroGPU {
+namespace Integrator {
+
+/*
+2N-storage Runge-Kutta, from "Low-Storage Runge-Kutta Schemes" by J. H. Williamson, J. Comput. Phys. 35 (1980)
+each stage i does
+	k = A_i k + L(u)
+	u = u + dt B_i k
+so the only buffer besides the state is the register k, whatever the number of stages.
+(Williamson's dq = dt k, which is the same thing for a fixed dt, and lets the callback accumulate into k as usual)
+Tableau needs a Stages enum and A(i) and B(i) static methods.  A(0) is always 0.
+*/
+template<typename Tableau>
+struct LowStorageRungeKutta : public Integrator {
+	enum { stages = Tableau::Stages };
+	enum { accumulatesDeriv = 1 };
+	typedef Integrator Super;
+	LowStorageRungeKutta(HydroGPU::Solver::Solver* solver);
+	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback);
+protected:
+	cl::Buffer registerBuffer;
+	cl::Kernel scaleKernel;
+	cl::Kernel multAddKernel;
+};
+
+template<typename Tableau>
+LowStorageRungeKutta<Tableau>::LowStorageRungeKutta(HydroGPU::Solver::Solver* solver)
+: Super(solver)
+{
+	registerBuffer = solver->cl.alloc(solver->storageSize * solver->numStates() * solver->getVolume(), "LowStorageRungeKutta::registerBuffer");
+
+	scaleKernel = cl::Kernel(solver->program, "scale");
+	scaleKernel.setArg(0, registerBuffer);
+	scaleKernel.setArg(2, (int)(solver->numStates() * solver->getVolume()));
+
+	multAddKernel = cl::Kernel(solver->program, "multAdd");
+	multAddKernel.setArg(0, solver->stateBuffer);
+	multAddKernel.setArg(1, solver->stateBuffer);
+	multAddKernel.setArg(2, registerBuffer);
+	multAddKernel.setArg(4, (int)(solver->numStates() * solver->getVolume()));
+}
+
+template<typename Tableau>
+void LowStorageRungeKutta<Tableau>::integrate(real dt, std::function<void(cl::Buffer)> callback) {
+	size_t length = solver->numStates() * solver->getVolume();
+	size_t l = solver->localSize1d[0];
+	cl::NDRange globalSize1d((length + l - 1) / l * l);
+
+	for (int i = 0; i < stages; ++i) {
+		//k = A_i k
+		if (Tableau::A(i) == 0) {
+			solver->cl.zero(registerBuffer, solver->storageSize * length);
+		} else {
+			solver->setRealArg(scaleKernel, 1, Tableau::A(i));
+			solver->commands.enqueueNDRangeKernel(scaleKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+		}
+
+		//k += L(u)
+		callback(registerBuffer);
+
+		//u += dt B_i k
+		solver->setRealArg(multAddKernel, 3, Tableau::B(i) * dt);
+		solver->commands.enqueueNDRangeKernel(multAddKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+	}
+}
+
+//Williamson's 3-stage third order scheme, from the paper above
+struct LowStorageRungeKutta3Tableau {
+	enum { Stages = 3 };
+	static real A(int i) { static real m[Stages] = {0, -5./9., -153./128.}; return m[i]; }
+	static real B(int i) { static real m[Stages] = {1./3., 15./16., 8./15.}; return m[i]; }
+};
+typedef LowStorageRungeKutta<LowStorageRungeKutta3Tableau> LowStorageRungeKutta3;
+
+//5-stage fourth order, solution 3 of "Fourth-Order 2N-Storage Runge-Kutta Schemes" by M. H. Carpenter and C. A. Kennedy, NASA TM-109112 (1994)
+struct LowStorageRungeKutta4Tableau {
+	enum { Stages = 5 };
+	static real A(int i) { static real m[Stages] = {
+		0.,
+		-567301805773. / 1357537059087.,
+		-2404267990393. / 2016746695238.,
+		-3550918686646. / 2091501179385.,
+		-1275806237668. / 842570457699.,
+	}; return m[i]; }
+	static real B(int i) { static real m[Stages] = {
+		1432997174477. / 9575080441755.,
+		5161836677717. / 13612068292357.,
+		1720146321549. / 2090206949498.,
+		3134564353537. / 4481467310338.,
+		2277821191437. / 14882151754819.,
+	}; return m[i]; }
+};
+typedef LowStorageRungeKutta<LowStorageRungeKutta4Tableau> LowStorageRungeKutta4;
+
+}
+}
@@ -20,12 +20,35 @@ struct RungeKutta : public Integrator {
 	RungeKutta(HydroGPU::Solver::Solver* solver);
 	virtual void integrate(real dt, std::function<void(cl::Buffer)> callback);
 protected:
+	//whether u^(i) is read after the stage right after it, and so needs keeping once the state moves on
+	bool stateNeeded(int i);
+	bool derivNeeded(int i);
 
 	std::array<cl::Buffer, order> stateBuffer;
 	std::array<cl::Buffer, order> derivBuffer;
-	cl::Kernel multAddKernel;
+	
+	//each stage is one pass of this over the state, summing up to 'order' alpha and 'order' beta terms
+	enum { maxTerms = 8 };
+	static_assert(2 * order <= maxTerms, "linearCombination doesn't take that many terms");
+	cl::Kernel linearCombinationKernel;
 };
 
+template<typename Tableau>
+bool RungeKutta<Tableau>::stateNeeded(int i) {
+	for (int m = i + 1; m < order; ++m) {
+		if (Tableau::alphas(m,i) != 0) return true;
+	}
+	return false;
+}
+
+template<typename Tableau>
+bool RungeKutta<Tableau>::derivNeeded(int i) {
+	for (int m = i; m < order; ++m) {
+		if (Tableau::betas(m,i) != 0) return true;
+	}
+	return false;
+}
+
 template<typename Tableau>
 RungeKutta<Tableau>::RungeKutta(HydroGPU::Solver::Solver* solver) 
 : Super(solver)
@@ -33,92 +56,68 @@ RungeKutta<Tableau>::RungeKutta(HydroGPU::Solver::Solver* solver)
 	int volume = solver->getVolume();
 
 	for (int i = 0;  i < order; ++i) {
-		bool needed = false;
-		for (int m = i; m < order; ++m) {
-			needed |= Tableau::alphas(m,i) != 0;
-		}
-		if (needed) {
-			stateBuffer[i] = solver->cl.alloc(sizeof(real) * solver->numStates() * volume, std::string() + "RungeKutta::stateBuffer[" + std::to_string(i) + "]");
-		}
-		
-		needed = false;
-		for (int m = i; m < order; ++m) {
-			needed |= Tableau::betas(m,i) != 0;
+		if (stateNeeded(i)) {
+			stateBuffer[i] = solver->cl.alloc(solver->storageSize * solver->numStates() * volume, std::string() + "RungeKutta::stateBuffer[" + std::to_string(i) + "]");
 		}
-		if (needed) {	
-			derivBuffer[i] = solver->cl.alloc(sizeof(real) * solver->numStates() * volume, std::string() + "RungeKutta::derivBuffer[" + std::to_string(i) + "]");
+		if (derivNeeded(i)) {	
+			derivBuffer[i] = solver->cl.alloc(solver->storageSize * solver->numStates() * volume, std::string() + "RungeKutta::derivBuffer[" + std::to_string(i) + "]");
+			if (solver->derivOverwrite) solver->cl.zero(derivBuffer[i], solver->storageSize * solver->numStates() * volume);
 		}
 	}
 
-	//put this in parent class of ForwardEuler and RungeKutta?
-	multAddKernel = cl::Kernel(solver->program, "multAdd");
-	multAddKernel.setArg(0, solver->stateBuffer);
-	multAddKernel.setArg(1, solver->stateBuffer);
+	linearCombinationKernel = cl::Kernel(solver->program, "linearCombination");
+	linearCombinationKernel.setArg(0, solver->stateBuffer);
+	linearCombinationKernel.setArg(1, solver->stateBuffer);
+	linearCombinationKernel.setArg(3, (int)(solver->numStates() * volume));
+	for (int j = 0; j < maxTerms; ++j) {
+		linearCombinationKernel.setArg(5 + 2 * j, solver->stateBuffer);
+		solver->setRealArg(linearCombinationKernel, 6 + 2 * j, 0);
+	}
 }
 
+/*
+u^(i) = sum k=0 to i-1 of (alpha_ik u^(k) + dt beta_ik L(u^(k)) )
+solver->stateBuffer holds u^(i-1) going into stage i, so that term is read in place,
+and if a later stage needs u^(i-1) then the same pass saves it off before overwriting it.
+(the state buffer handle itself can't be swapped, since the solver's kernels all have it bound.)
+*/
 template<typename Tableau>
 void RungeKutta<Tableau>::integrate(real dt, std::function<void(cl::Buffer)> callback) {
 	size_t length = solver->numStates() * solver->getVolume();
-	size_t bufferSize = sizeof(real) * length;
-	cl::NDRange globalSize1d(length);
-
-	//u(0) = u^n
-	bool needed = false;
-	for (int m = 0; m < order; ++m) {
-		needed |= Tableau::alphas(m,0) != 0;
-	}
-	if (needed) {
-		solver->commands.enqueueCopyBuffer(solver->stateBuffer, stateBuffer[0], 0, 0, bufferSize);
-	}
+	size_t bufferSize = solver->storageSize * length;
+	size_t l = solver->localSize1d[0];
+	cl::NDRange globalSize1d((length + l - 1) / l * l);
 
 	//L(u^(0))
-	needed = false;
-	for (int m = 0; m < order; ++m) {
-		needed |= Tableau::betas(m,0) != 0;
-	}
-	if (needed) {
-		solver->cl.zero(derivBuffer[0], bufferSize);
+	if (derivNeeded(0)) {
+		if (!solver->derivOverwrite) solver->cl.zero(derivBuffer[0], bufferSize);
 		callback(derivBuffer[0]);
 	}
 	
 	for (int i = 1; i <= order; ++i) {
-		//u^(i) = sum k=0 to i-1 of (alpha_ik u^(k) + dt beta_ik L(u^(k)) )
-		solver->cl.zero(solver->stateBuffer, bufferSize);
+		int count = 0;
 		for (int k = 0; k < i; ++k) {
 			if (Tableau::alphas(i-1,k)) {
-				multAddKernel.setArg(2, stateBuffer[k]);
-				multAddKernel.setArg(3, Tableau::alphas(i-1,k));
-				solver->commands.enqueueNDRangeKernel(multAddKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+				linearCombinationKernel.setArg(5 + 2 * count, k == i-1 ? solver->stateBuffer : stateBuffer[k]);
+				solver->setRealArg(linearCombinationKernel, 6 + 2 * count, Tableau::alphas(i-1,k));
+				++count;
 			}
-
 			if (Tableau::betas(i-1,k)) {
-				multAddKernel.setArg(2, derivBuffer[k]);
-				multAddKernel.setArg(3, Tableau::betas(i-1,k) * dt);
-				solver->commands.enqueueNDRangeKernel(multAddKernel, solver->offset1d, globalSize1d, solver->localSize1d);
+				linearCombinationKernel.setArg(5 + 2 * count, derivBuffer[k]);
+				solver->setRealArg(linearCombinationKernel, 6 + 2 * count, Tableau::betas(i-1,k) * dt);
+				++count;
 			}
 		}
 
-		if (i < order) {
-			//only do this if alpha_mi != 0 for any m
-			//otherwise there's no need to store this buffer
-			needed = false;
-			for (int m = i; m < order; ++m) {
-				needed |= Tableau::alphas(m,i) != 0;
-			}	
-			if (needed) {
-				solver->commands.enqueueCopyBuffer(solver->stateBuffer, stateBuffer[i], 0, 0, bufferSize);
-			}
+		bool save = stateNeeded(i-1);
+		linearCombinationKernel.setArg(1, save ? stateBuffer[i-1] : solver->stateBuffer);
+		linearCombinationKernel.setArg(2, (int)save);
+		linearCombinationKernel.setArg(4, count);
+		solver->commands.enqueueNDRangeKernel(linearCombinationKernel, solver->offset1d, globalSize1d, solver->localSize1d);
 
-			//likewise here, only if beta_mi != 0 for any m
-			//with that in mind, no need to allocate these buffers unless they are needed.
-			needed = false;
-			for (int m = i; m < order; ++m) {
-				needed |= Tableau::betas(m,i) != 0;
-			}
-			if (needed) {
-				solver->cl.zero(derivBuffer[i], bufferSize);
-				callback(derivBuffer[i]);
-			}
+		if (i < order && derivNeeded(i)) {
+			if (!solver->derivOverwrite) solver->cl.zero(derivBuffer[i], bufferSize);
+			callback(derivBuffer[i]);
 		}
 		//else just leave the state in there
 	}
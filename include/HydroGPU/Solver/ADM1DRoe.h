@@ -14,6 +14,7 @@ struct ADM1DRoe : public Roe {
 
 protected:
 	cl::Kernel addSourceKernel;
+	cl::Kernel implicitSourceKernel;
 
 	virtual void initKernels();
 	virtual void createEquation();
@@ -21,6 +22,8 @@ protected:
 	virtual int getEigenTransformStructSize();
 	virtual std::vector<std::string> getEigenProgramSources();
 	virtual void step(real dt);
+	virtual bool canDerivOverwrite() { return true; }
+	virtual bool canSinglePassRHS() { return true; }
 public:
 	virtual std::string name() const { return "ADM1DRoe"; }
 };
@@ -14,6 +14,7 @@ struct ADM3DRoe : public Roe {
 
 protected:
 	cl::Kernel addSourceKernel;
+	cl::Kernel implicitSourceKernel;
 	cl::Kernel constrainKernel;
 
 	virtual void initKernels();
@@ -23,7 +24,10 @@ protected:
 	virtual std::vector<std::string> getEigenProgramSources();
 	virtual int getEigenTransformStructSize();
 	virtual int getEigenSpaceDim();
+	virtual int getDeltaQTildeDim() { return 12; }	//NUM_WAVES in ADM3DRoe.cl
 	virtual void step(real dt);
+	virtual bool canDerivOverwrite() { return true; }
+	virtual bool canSinglePassRHS() { return true; }
 public:
 	virtual std::string name() const { return "ADM3DRoe"; }
 };
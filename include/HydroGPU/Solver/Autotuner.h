@@ -0,0 +1,54 @@
+#pragma once
+
+#include "HydroGPU/Shared/Common.h"	//real
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace HydroGPU {
+struct HydroGPUApp;
+namespace Solver {
+struct Solver;
+
+/*
+lua 'autotune': picks the work group size and extra build options (-cl-mad-enable, -cl-fast-relaxed-math)
+for each device, driver, solver, precision and grid size.
+it times a few updates of a fresh solver per candidate, starting from the current initial condition,
+first the build options (at the default work group size), then the work group sizes (with the winning options).
+build options whose state drifts from the default build's by more than lua 'autotuneTolerance' (relative to the largest value) are rejected.
+winners are kept in autotune.txt, and Solver::init picks them up on later runs.
+*/
+struct Autotuner {
+	typedef std::function<std::shared_ptr<Solver>()> SolverGenFunc;
+
+	Autotuner(HydroGPUApp* app);
+
+	//whether there are results on file for 'solver'
+	bool find(Solver* solver, std::vector<size_t>& localSize, std::string& buildOptions);
+
+	std::string getKey(Solver* solver);
+
+	//times candidates with solvers made by 'gen', whose results are saved under 'key'
+	void tune(SolverGenFunc gen, const std::string& key);
+
+protected:
+	HydroGPUApp* app;
+	std::string filename;
+	int numSteps;
+	real tolerance;
+
+	std::vector<std::vector<size_t>> getLocalSizeCandidates();
+
+	/*
+	init, resetState, and time numSteps updates of a new solver with these settings
+	returns the seconds, or infinity if the settings failed
+	'result', if given, gets the final state
+	*/
+	double run(SolverGenFunc gen, const std::string& buildOptions, const std::vector<size_t>& localSize, std::vector<real>* result);
+
+	void save(const std::string& key, const std::vector<size_t>& localSize, const std::string& buildOptions);
+};
+
+}
+}
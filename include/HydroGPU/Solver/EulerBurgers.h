@@ -30,6 +30,12 @@ protected:
 	virtual std::vector<std::string> getProgramSources();
 	virtual real calcTimestep();
 	virtual void step(real dt);
+	virtual bool canRuntimeDefs() { return true; }
+	virtual bool canDerivOverwrite() { return !selfgrav->fluidDispatch; }
+	virtual bool canSinglePassRHS() { return true; }
+	virtual bool canFluidDispatch() { return true; }
+	void enqueueCellKernel(cl::Kernel& kernel);
+	void enqueueInterfaceKernel(cl::Kernel& kernel);
 public:
 	virtual std::string name() const { return "EulerBurgers"; }
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "HydroGPU/Solver/TemporalBlockBehavior.h"
+#include "HydroGPU/Solver/PrimitiveBufferBehavior.h"
 #include "HydroGPU/Solver/SelfGravitationBehavior.h"
 #include "HydroGPU/Solver/HLL.h"
 
@@ -7,14 +9,21 @@ namespace HydroGPU {
 struct HydroGPUApp;
 namespace Solver {
 
-struct EulerHLL : public SelfGravitationBehavior<HLL> {
-	typedef SelfGravitationBehavior<HLL> Super;
+struct EulerHLL : public TemporalBlockBehavior<PrimitiveBufferBehavior<SelfGravitationBehavior<HLL>>> {
+	typedef TemporalBlockBehavior<PrimitiveBufferBehavior<SelfGravitationBehavior<HLL>>> Super;
 	using Super::Super;
 protected:
 	virtual void initKernels();
 	virtual void createEquation();
 	virtual std::string getFluxSource();
+	virtual void initStep();
 	virtual void step(real dt);
+	virtual void calcDeriv(cl::Buffer derivBuffer, real dt);
+	virtual bool canMixPrecision() { return true; }	//EulerHLLC too
+	virtual bool canRuntimeDefs() { return true; }
+	virtual bool canDerivOverwrite() { return true; }
+	virtual bool canSinglePassRHS() { return true; }
+	virtual std::string getTemporalBlockFlux() { return "HLL"; }
 public:
 	virtual std::string name() const { return "EulerHLL"; }
 };
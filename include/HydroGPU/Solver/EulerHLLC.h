@@ -12,6 +12,7 @@ struct EulerHLLC : public EulerHLL {
 
 protected:
 	virtual std::string getFluxSource();
+	virtual std::string getTemporalBlockFlux() { return std::string(); }	//EulerTemporalBlock.cl only has the HLL flux
 public:
 	virtual std::string name() const { return "EulerHLLC"; }
 };
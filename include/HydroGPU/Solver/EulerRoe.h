@@ -1,5 +1,7 @@
 #pragma once
 
+#include "HydroGPU/Solver/TemporalBlockBehavior.h"
+#include "HydroGPU/Solver/PrimitiveBufferBehavior.h"
 #include "HydroGPU/Solver/SelfGravitationBehavior.h"
 #include "HydroGPU/Solver/Roe.h"
 
@@ -9,15 +11,34 @@ namespace Solver {
 /*
 Roe solver for Euler equations
 */
-struct EulerRoe : public SelfGravitationBehavior<Roe> {
-	typedef SelfGravitationBehavior<Roe> Super;
+struct EulerRoe : public TemporalBlockBehavior<PrimitiveBufferBehavior<SelfGravitationBehavior<Roe>>> {
+	typedef TemporalBlockBehavior<PrimitiveBufferBehavior<SelfGravitationBehavior<Roe>>> Super;
 	using Super::Super;
 protected:
+	//lua 'sparseEigenTransform', on by default.  false falls back to the dense RoeEigenfieldLinear.cl transforms
+	bool useSparseEigenTransform = true;
+
+	virtual void initBuffers();
 	virtual void initKernels();
 	virtual void createEquation();
 	virtual std::vector<std::string> getProgramSources();
+	virtual bool canRemapBoundary() { return !usePrimitiveBuffer; }	//primitives of ghost cells are read directly
+	virtual bool canMixPrecision() { return true; }
+	virtual bool canRuntimeDefs() { return true; }
+	virtual bool canDerivOverwrite() { return !selfgrav->fluidDispatch; }	//the fluid-only launches leave the solid cells' derivs alone
+	virtual bool canSinglePassRHS() { return !useLocalTimestep && !dimensionalSplit; }	//the substeps and sweeps integrate the flux alone, then gravity, so the deriv has to be cleared between them
+	virtual bool canActivityMask() { return !selfgrav->fluidDispatch; }	//both pick the cells of the interface launches
+	virtual bool canFluidDispatch() { return true; }
+	virtual bool canDimensionalSplit() { return true; }
+	virtual void enqueueInterfaceKernel(cl::Kernel& kernel);
+	virtual void enqueueCellKernel(cl::Kernel& kernel);
+	virtual std::string getTemporalBlockFlux() { return "ROE"; }
+	virtual void initStep();
+	virtual void initFlux();
 	virtual void step(real dt);
+	virtual std::shared_ptr<SparseEigenTransform> getSparseEigenTransform();
 public:
+	virtual void init();
 	virtual std::string name() const { return "EulerRoe"; }
 };
 
@@ -23,6 +23,9 @@ protected:
 	virtual void initKernels();
 	virtual std::vector<std::string> getProgramSources();
 	virtual std::vector<std::string> getCalcFluxDerivProgramSources();
+	
+	//how many sides of interfaces the flux buffer holds at once
+	virtual int getFluxSides();
 };
 
 }
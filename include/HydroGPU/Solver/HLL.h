@@ -25,6 +25,7 @@ protected:
 	virtual void initStep();
 	virtual real calcTimestep();
 	virtual void step(real dt);
+	virtual void calcDeriv(cl::Buffer derivBuffer, real dt);
 };
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CLCommon/cl.hpp"
+#include <vector>
 
 namespace HydroGPU {
 namespace Solver {
@@ -14,6 +15,10 @@ protected:
 	cl::Buffer magneticFieldPotentialBuffer;
 	cl::Buffer magneticFieldPotential2Buffer;
 	
+	//boundary method table for the potential buffers, see Solver::boundaryMethodsBuffer
+	cl::Buffer boundaryMethodsBuffer;
+	std::vector<int> boundaryMethodsVec;
+	
 	cl::Kernel calcMagneticFieldDivergenceKernel;
 	cl::Kernel magneticPotentialPoissonRelaxKernel;
 	cl::Kernel magneticFieldRemoveDivergenceKernel;
@@ -14,12 +14,17 @@ struct MaxwellRoe : public Roe {
 
 protected:	
 	cl::Kernel addSourceKernel;
+	cl::Kernel implicitSourceKernel;
 
 	virtual void initKernels();
 	virtual void createEquation();
 	virtual std::vector<std::string> getProgramSources();
+	virtual bool canRemapBoundary() { return true; }
+	virtual bool canDerivOverwrite() { return true; }
+	virtual bool canSinglePassRHS() { return true; }
 	virtual int getEigenTransformStructSize();
 	virtual std::vector<std::string> getEigenProgramSources();
+	virtual bool hasConstantEigenBasis() { return true; }
 	virtual void step(real dt);
 public:
 	virtual std::string name() const { return "MaxwellRoe"; }
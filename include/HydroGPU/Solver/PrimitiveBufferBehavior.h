@@ -0,0 +1,70 @@
+#pragma once
+
+#include "HydroGPU/Solver/SelfGravitationBehavior.h"
+#include "HydroGPU/HydroGPUApp.h"
+#include <vector>
+#include <string>
+
+namespace HydroGPU {
+namespace Solver {
+
+/*
+optional per-cell primitive cache for the Euler solvers, along the lines of SRHDRoe::primitiveBuffer
+enabled with lua 'usePrimitiveBuffer'
+the child class calls updatePrimitives() before whatever kernels read it,
+and sets primitiveBuffer as the last arg of those kernels.
+Parent needs to be a SelfGravitationBehavior (for the potential buffer)
+*/
+template<typename Parent>
+struct PrimitiveBufferBehavior : public Parent {
+	typedef Parent Super;
+	using Super::Super;
+protected:
+	//matches NUM_PRIMITIVES in EulerPrimitives.cl
+	static constexpr int numPrimitives = 8;
+
+	bool usePrimitiveBuffer = false;
+	cl::Buffer primitiveBuffer;
+	cl::Kernel calcPrimitivesKernel;
+
+public:
+	virtual void init() {
+		Super::app->lua["usePrimitiveBuffer"] >> usePrimitiveBuffer;
+		Super::init();
+	}
+
+protected:
+	virtual std::vector<std::string> getProgramSources() {
+		std::vector<std::string> sources = Super::getProgramSources();
+		if (usePrimitiveBuffer) sources[0] += "#define PRIMITIVE_BUFFER 1\n";
+		return sources;
+	}
+
+	virtual void initBuffers() {
+		Super::initBuffers();
+		if (!usePrimitiveBuffer) return;
+		primitiveBuffer = Super::cl.alloc(Super::realSize * numPrimitives * Super::getVolume(), "PrimitiveBufferBehavior::primitiveBuffer");
+	}
+
+	virtual void initKernels() {
+		Super::initKernels();
+		if (!usePrimitiveBuffer) return;
+		calcPrimitivesKernel = cl::Kernel(Super::program, "calcPrimitives");
+		CLCommon::setArgs(calcPrimitivesKernel, primitiveBuffer, Super::stateBuffer, Super::getPotentialBuffer(), Super::defsBuffer);
+	}
+
+	//ghost cells included, so call this after the boundary
+	void updatePrimitives() {
+		if (!usePrimitiveBuffer) return;
+		Super::commands.enqueueNDRangeKernel(calcPrimitivesKernel, Super::offsetNd, Super::globalSizePadded, Super::localSize);
+	}
+
+	//sets the trailing primitiveBuffer arg of a kernel compiled with PRIMITIVE_BUFFER
+	void setPrimitiveBufferArg(cl::Kernel& kernel) {
+		if (!usePrimitiveBuffer) return;
+		kernel.setArg(kernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1, primitiveBuffer);
+	}
+};
+
+}
+}
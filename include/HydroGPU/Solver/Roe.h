@@ -1,6 +1,9 @@
 #pragma once
 
 #include "HydroGPU/Solver/FiniteVolumeSolver.h"
+#include "HydroGPU/Solver/SparseEigenTransform.h"
+#include <memory>
+#include <vector>
 
 namespace HydroGPU {
 struct HydroGPUApp;
@@ -22,6 +25,58 @@ protected:
 	cl::Kernel calcCellTimestepKernel;
 	cl::Kernel calcDeltaQTildeKernel;
 
+	//pre-cfl timestep computed once at init, for constant eigenbases
+	real constantTimestep;
+
+	/*
+	lua 'activityMask': only recompute the eigenbasis, deltaQTilde and flux in blocks (of localSize cells)
+	near cells that changed since the last step.  the rest keep the values they had,
+	which calcCellTimestep and calcFluxDeriv still read everywhere, so quiet blocks cost one compare of their states a step.
+	lua 'activityTolerance' (default 0, no change at all) is how much of a change counts,
+	lua 'activityMargin' (default 2, the Roe stencil radius) is how many cells around a block are watched.
+	multistage integrators reach another 2 cells per stage, so give them a bigger margin.
+	*/
+	bool useActivityMask;
+	real activityTolerance;
+	int activityMargin;
+	int numBlocks;
+	int numActiveBlocks;
+	bool activityReset;	//set to recompute every block next step (the cached values are invalid)
+	int activitySlopeLimiter;	//the limiter the cached fluxes were computed with
+	cl::Buffer lastStateBuffer;
+	cl::Buffer activeBlocksBuffer;
+	cl::Buffer activeCountBuffer;
+	cl::Kernel calcActiveBlocksKernel;
+
+	/*
+	lua 'localTimestep': multi-rate stepping by block (the activity mask's blocks).
+	each block gets a level from the smallest dt of its cells, and steps 2^level times the finest dt,
+	up to lua 'localTimestepMaxLevel' (default 3), and neighboring blocks are at most one level apart.
+	a step is then 2^(coarsest level) substeps of the finest dt, and each interface is updated at the finer level of its two cells,
+	with the same flux and dt on both sides, so the coarse side of a level interface takes the fine fluxes and nothing is lost.
+	the eigenbasis, deltaQTilde and flux launches only cover blocks next to an interface due at that substep (activeBlocks, sorted by that).
+	only with ForwardEuler and without useFixedDT, otherwise it steps everything at the finest dt.
+	*/
+	bool useLocalTimestep;
+	int localTimestepMaxLevel;
+	int numSubsteps;	//of this step, 2^(coarsest level in use)
+	int numBlocksPerSide[3];
+	std::vector<int> blockLevels;
+	std::vector<int> levelBlockCounts;	//[k] = how many of the sorted activeBlocks to compute at substeps that are multiples of 2^k
+	cl::Buffer blockTimestepsBuffer;
+	cl::Buffer blockLevelsBuffer;
+	cl::Kernel calcBlockTimestepsKernel;
+	cl::Kernel calcLocalFluxDerivKernel;
+
+	/*
+	lua 'dimensionalSplit': Strang splitting, one integration per side, in x,y,z order one step and z,y,x the next.
+	the eigenbasis, deltaQTilde and flux buffers only hold the side being swept (DIMENSIONAL_SPLIT in Common.cl), 1/dim the memory,
+	with each interface at the index of its cell, so neighboring work items read neighboring interfaces.
+	not with activityMask or localTimestep.
+	*/
+	bool dimensionalSplit;
+	int splitBasisSide;	//the side the eigenbasis buffer holds, or -1 if it's out of date
+
 public:
 	Roe(HydroGPUApp* app);
 	virtual void init();
@@ -32,11 +87,58 @@ protected:
 	virtual std::vector<std::string> getEigenProgramSources();
 	virtual int getEigenSpaceDim();	//numStates() in most cases
 	virtual int getEigenTransformStructSize();	//total size of forward and inverse
+	virtual int getDeltaQTildeDim() { return getEigenSpaceDim(); }	//less if zero-speed fields aren't stored
+	
+	/*
+	solvers whose calcEigenBasis can pack into a sparse pattern return one here.
+	then the default struct size and eigen program sources come from it instead of RoeEigenfieldLinear.cl
+	*/
+	virtual std::shared_ptr<SparseEigenTransform> getSparseEigenTransform() { return nullptr; }
+	
+	/*
+	linear, constant-coefficient systems return true.
+	then only one eigenbasis per side is stored, calcEigenBasis is run once at init,
+	and the timestep is computed once from the fixed wavespeeds.
+	*/
+	virtual bool hasConstantEigenBasis() { return false; }
+
+	//whether the solver's calcEigenBasis takes the ACTIVE_BLOCKS arg (after its SOLID and defs args)
+	virtual bool canActivityMask() { return false; }
+
+	//whether the solver's calcEigenBasis takes the DIMENSIONAL_SPLIT arg, and indexes its interfaces with INTERFACE_INDEX
+	virtual bool canDimensionalSplit() { return false; }
+	virtual int getFluxSides();
+	
+	virtual void initStep();
+	void updateActiveBlocks();
+
+	//checked each step, since the gui can change these
+	bool localTimestepActive();
+	real calcLocalTimesteps();
+	void resetLocalTimesteps();
+	void stepLocalTimesteps(real dt);
+
+	int getSweepSide(int sweep);
+	void setSplitSide(int side);
+	void stepDimensionalSplit(real dt);
+	
+	//launch over the interfaces, or only the active blocks of them
+	virtual void enqueueInterfaceKernel(cl::Kernel& kernel);
+	
+	//launch over the interior cells
+	virtual void enqueueCellKernel(cl::Kernel& kernel);
+	
 	virtual real calcTimestep();
 	virtual void initFlux();
 	virtual void step(real dt);
 	virtual void calcDeriv(cl::Buffer derivBuffer, real dt);
 	virtual void calcFlux(real dt);
+
+	/*
+	step() for the solvers with a per-cell source: the flux and the source go to the integrator together (Integrator::integrateIMEX),
+	so the IMEX integrators can take the source implicitly (implicitSource, ImplicitSource.cl) while the rest integrate them one after the other.
+	*/
+	void stepWithSource(real dt, cl::Kernel& addSourceKernel, cl::Kernel& implicitSourceKernel);
 };
 
 }
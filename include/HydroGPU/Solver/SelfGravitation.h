@@ -2,6 +2,7 @@
 
 #include "HydroGPU/Shared/Common.h"	//cl shared header
 #include "CLCommon/cl.hpp"
+#include <vector>
 
 namespace HydroGPU {
 namespace Solver {
@@ -15,7 +16,24 @@ public:
 	cl::Buffer potentialBuffer;
 	cl::Buffer solidBuffer;
 
+	/*
+	lua 'fluidDispatch', for solvers that canFluidDispatch (EulerRoe, EulerBurgers):
+	their SOLID kernels read the solid flags packed one bit per cell (solidBitsBuffer),
+	and launch over lists of the interior fluid cells, or of the interfaces with fluid on either side (and their neighbors, for the slope limiter),
+	built on reset, instead of over the whole grid.
+	*/
+	bool fluidDispatch;
+	cl::Buffer solidBitsBuffer;
+	cl::Buffer fluidCellsBuffer;
+	cl::Buffer fluidInterfacesBuffer;
+	int numFluidCells;	//list lengths, padded to the 1D local size
+	int numFluidInterfaces;
+
 protected:
+	//boundary method table for the potential, see Solver::boundaryMethodsBuffer
+	cl::Buffer potentialBoundaryMethodsBuffer;
+	std::vector<int> potentialBoundaryMethodsVec;
+
 	cl::Kernel gravityPotentialPoissonRelaxKernel;
 	cl::Kernel calcGravityDerivKernel;
 
@@ -26,11 +44,21 @@ public:
 	virtual std::vector<std::string> getProgramSources();
 	virtual void resetState(std::vector<real>& stateVec, std::vector<real>& potentialVec, std::vector<char>& solidVec);
 	virtual void applyPotential(real dt);
+	
+	//applyPotential's callback: relax the potential and add the gravity deriv.  the solvers call it from their own callback with singlePassRHS
+	virtual void calcGravityDeriv(cl::Buffer derivBuffer);
 	virtual void potentialBoundary();
 
+	//1D launches over the fluid lists, for kernels compiled with FLUID_DISPATCH
+	void enqueueFluidCells(cl::Kernel& kernel);
+	void enqueueFluidInterfaces(cl::Kernel& kernel);
+protected:
+	void initFluidLists(const std::vector<char>& solidVec);
+
 public:
 	cl::Buffer getPotentialBuffer();
 	cl::Buffer getSolidBuffer();
+	cl::Buffer getKernelSolidBuffer();	//solidBitsBuffer with fluidDispatch, for the solid_t args
 };
 
 }
@@ -3,6 +3,7 @@
 #include "HydroGPU/Solver/Solver.h"
 #include "HydroGPU/HydroGPUApp.h"
 #include <memory>
+#include <iostream>
 
 namespace HydroGPU {
 namespace Solver {
@@ -30,10 +31,17 @@ protected:
 public:
 	virtual void init() {
 		selfgrav = std::make_shared<SelfGravitation>(this);
+		if (selfgrav->fluidDispatch && !canFluidDispatch()) {
+			std::cout << "solver " << Super::name() << " doesn't support fluidDispatch -- launching every cell" << std::endl;
+			selfgrav->fluidDispatch = false;
+		}
 		Super::init();
 	}
 
 protected:
+	//whether the solver's SOLID kernels take solid_t flags and the FLUID_DISPATCH list arg, and launch through selfgrav's enqueueFluid*
+	virtual bool canFluidDispatch() { return false; }
+
 	virtual void initBuffers() {
 		Super::initBuffers();
 		selfgrav->initBuffers();
@@ -46,6 +54,7 @@ protected:
 
 	virtual std::vector<std::string> getProgramSources() {
 		std::vector<std::string> sources = Super::getProgramSources();
+		if (selfgrav->fluidDispatch) sources[0] += "#define FLUID_DISPATCH 1\n";
 		std::vector<std::string> added = selfgrav->getProgramSources();
 		sources.insert(sources.end(), added.begin(), added.end());
 		return sources;
@@ -83,7 +92,7 @@ protected:
 		virtual void fromGPU() {
 			Super::fromGPU();
 			SelfGravitationBehavior* owner = dynamic_cast<SelfGravitationBehavior*>(Super::solver);
-			owner->commands.enqueueReadBuffer(owner->selfgrav->potentialBuffer, CL_TRUE, 0, sizeof(real) * owner->getVolume(), potentialVec.data());
+			owner->readReals(owner->selfgrav->potentialBuffer, potentialVec.data(), owner->getVolume(), owner->storageSize);
 			owner->commands.enqueueReadBuffer(owner->selfgrav->solidBuffer, CL_TRUE, 0, sizeof(char) * owner->getVolume(), solidVec.data());
 			owner->commands.finish();
 		}
@@ -55,7 +55,98 @@ public:	//protected:
 	
 	cl::Kernel findMinTimestepKernel;
 
-	std::vector<std::vector<std::vector<cl::Kernel>>> boundaryKernels;	//[NUM_BOUNDARY_METHODS][app.dim][min/max];
+	/*
+	fused boundary kernel: one launch per dimension fills both faces of every state
+	boundaryMethodsBuffer holds the BOUNDARY_KERNEL_* for [state + numStates * (minmax + 2 * dim)]
+	boundaryMethodsVec is the CPU copy, so the buffer is only rewritten when the boundary methods change
+	*/
+	cl::Kernel boundaryKernel;
+	cl::Buffer boundaryMethodsBuffer;
+	std::vector<int> boundaryMethodsVec;
+
+	/*
+	lua 'boundaryRemap': skip filling ghost cells, and instead have the kernels that read neighbors
+	remap ghost coordinates onto the interior using boundaryMethodsBuffer (see readStateRemapped in Common.cl)
+	only set if the solver supports it (canRemapBoundary)
+	*/
+	bool boundaryRemap;
+
+	/*
+	the first kernel to add into a deriv buffer in each integrator callback writes it instead (DERIV_OVERWRITE, see addDeriv in Common.cl),
+	so the integrators needn't zero their deriv buffers before every callback.
+	they zero them once when allocated, for the ghost cells no kernel writes.
+	set if the solver declares its callbacks do that (canDerivOverwrite) and the integrator doesn't accumulate into the buffer it passes.
+	*/
+	bool derivOverwrite;
+
+	/*
+	lua 'singlePassRHS': the solvers that split their right hand side into several integrations
+	(flux, sources, gravity, diffusion) do all of it in one integrator callback instead, adding into the same deriv buffer.
+	that saves the stage buffers, zero fills and combination passes of the extra integrations, but the terms are no longer split.
+	only set if the solver supports it (canSinglePassRHS).  the kernels that then add onto the flux deriv use clearSplitDeriv (Common.cl).
+	*/
+	bool singlePassRHS;
+
+	/*
+	lua 'precision': "double", "single", "mixed", or "half"
+	mixed stores the state-shaped buffers (state, flux, derivatives, potential) as float,
+	while the Roe averages, eigenbases and reductions stay in double.
+	half (experimental) stores them as 16-bit half floats.  turn on conservationDiagnostic to see what that costs.
+	half falls back to mixed without cl_khr_fp16, mixed and half fall back to double if the solver can't mix (canMixPrecision),
+	and the arithmetic falls back to single without cl_khr_fp64
+	*/
+	std::string precision;
+	size_t realSize;	//sizeof the device 'real'
+	size_t storageSize;	//sizeof the device 'real_storage'
+
+	/*
+	lua 'conservationDiagnostic': print the drift of the interior sum of each state after each step,
+	relative to the sums right after resetState.
+	with periodic (or otherwise closed) boundaries that's the conservation error of the storage and the scheme.
+	resetState also prints the rounding the initial upload introduced.
+	*/
+	bool conservationDiagnostic;
+	cl::Kernel sumStatesKernel;
+	cl::Buffer stateSumsBuffer;	//per-work-group partial sums
+	std::vector<real> initialStateSums;
+
+	/*
+	lua 'slopeLimiter': index into slopeLimiterNames
+	all the limiters are compiled into the program, and the flux kernels are passed this as their 'limiter' arg,
+	so it can be changed between steps (from the gui) without rebuilding
+	*/
+	static const std::vector<std::string> slopeLimiterNames;
+	int slopeLimiter;
+
+	/*
+	the numeric entries of lua 'defs', in the order of the generated 'Defs' struct
+	that the kernels using them take as a '__constant Defs* defs' arg.
+	if runtimeDefs (the solver canRuntimeDefs) then each def name expands to defs->name,
+	so changing defValues and calling updateDefs takes effect next step without a rebuild.
+	otherwise, and for non-numeric defs (expressions), they are still #defined into the program.
+	*/
+	std::vector<std::string> defNames;
+	std::vector<real> defValues;
+	cl::Buffer defsBuffer;
+	bool runtimeDefs;
+
+	/*
+	lua 'programCache', on by default: keep built program binaries as <programCacheDir>/program-<hash>.cl.bin,
+	keyed by the sources, everything they #include, the build options, and the device and driver.
+	each file starts with its whole key, so a hash collision is a rebuild and not the wrong program.
+	so restarts and gui solver switches only compile once per configuration.
+	*/
+	bool programCache = true;
+	std::string programCacheDir = "cache";	//lua 'programCacheDir'
+
+	/*
+	set by the Autotuner: its results on file (lua 'autotune'), or the candidate it is timing ('tuning' set).
+	a non-empty tunedLocalSize replaces the default localSize (localSize1d stays),
+	and tunedBuildOptions is appended to the program build options.
+	*/
+	std::vector<size_t> tunedLocalSize;
+	std::string tunedBuildOptions;
+	bool tuning = false;
 
 	//construct this after the program has been compiled
 	std::shared_ptr<HydroGPU::Integrator::Integrator> integrator;
@@ -64,9 +155,20 @@ public:	//protected:
 	cl::NDRange globalSize;
 	cl::NDRange localSize;
 	cl::NDRange localSize1d;
+	cl::NDRange reduceLocalSize;	//localSize1d, but at least 16, so each findMinTimestep pass shrinks
 	cl::NDRange offset1d;
 	cl::NDRange offsetNd;
 
+	/*
+	interior-only dispatch: offset past the min-side ghost cells,
+	with global sizes padded up to a multiple of localSize so the grid size needn't be.
+	kernels only check the upper bound.
+	*/
+	cl::NDRange offsetInterior;
+	cl::NDRange globalSizeInterior;	//cells [2, size-2)
+	cl::NDRange globalSizeInterface;	//interfaces [2, size-1)
+	cl::NDRange globalSizePadded;	//all cells, for kernels that also fill ghost cells
+
 	int frame;
 	std::shared_ptr<Equation::Equation> equation;
 
@@ -83,6 +185,9 @@ public:
 	virtual std::shared_ptr<Equation::Equation> getEquation() const { return equation; }
 protected:
 	virtual std::vector<std::string> getProgramSources();
+	void buildProgram();	//from the cache if it can
+	std::string getProgramCacheKey(const std::vector<std::string>& sourceStrs, const std::string& buildOptions);
+	std::string getProgramCacheFilename(const std::string& key);
 	virtual void initBuffers();
 	virtual void initKernels();
 public:
@@ -94,6 +199,48 @@ protected:
 public:
 	virtual void getBoundaryRanges(int dimIndex, cl::NDRange &offset, cl::NDRange &global, cl::NDRange &local);
 	virtual void boundary();
+	
+	//fill ghost cells of all 'spacing' interleaved states of 'buffer', using the method table in 'methodsBuffer'
+	virtual void applyBoundary(cl::Buffer buffer, int spacing, cl::Buffer methodsBuffer);
+	
+	//writes 'methodsVec' into 'methodsBuffer' if it differs from 'cachedVec', and updates 'cachedVec'
+	void updateBoundaryMethods(cl::Buffer methodsBuffer, std::vector<int>& cachedVec, const std::vector<int>& methodsVec);
+protected:
+	virtual std::vector<int> getBoundaryMethods();
+	
+	//whether all the solver's kernels that read neighboring states can read through readStateRemapped
+	virtual bool canRemapBoundary() { return false; }
+
+	//whether all the solver's kernels take their state-shaped buffers as real_storage
+	virtual bool canMixPrecision() { return false; }
+
+	//whether every function in the solver's program that uses a def has the 'defs' arg
+	virtual bool canRuntimeDefs() { return false; }
+
+	//whether the first deriv kernel of each of the solver's integrator callbacks writes every interior cell, solid ones included, under DERIV_OVERWRITE
+	virtual bool canDerivOverwrite() { return false; }
+
+	//whether the solver's step() does all its terms in one callback when singlePassRHS is set
+	virtual bool canSinglePassRHS() { return false; }
+
+	//lua 'defs' -> defValues.  the first call picks defNames, which fixes the Defs struct layout
+	void readDefs();
+
+public:
+	//defValues -> defsBuffer
+	void updateDefs();
+
+	//scalar kernel args have to match the size of the device 'real'
+	void setRealArg(cl::Kernel& kernel, int index, real value);
+
+	//host 'real's <-> device buffers of 'elementSize'-byte reals (realSize or storageSize), converting as needed
+	void writeReals(cl::Buffer buffer, const real* src, size_t count, size_t elementSize);
+	void readReals(cl::Buffer buffer, real* dst, size_t count, size_t elementSize);
+
+	//sum of each state over the interior, reduced per work group on the device and across groups on the host
+	std::vector<real> getStateSums();
+protected:
+	void reportConservation();
 protected:
 
 	virtual void initStep();
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace HydroGPU {
+namespace Solver {
+
+/*
+generates Roe eigenvector transforms for a known sparsity pattern
+
+entries are "0", "1", "-1", a symbol name, or "-" followed by a symbol name
+matrices are column-major, matrix[i + n * j], same as RoeEigenfieldLinear.cl
+left is the inverse eigenvector matrix, right is the eigenvector matrix
+
+only one value per distinct symbol is stored per interface,
+and the transforms are unrolled with zeros dropped and terms sharing a symbol grouped
+
+the pattern is for side 0.  rotatedVectors holds the state index of the x component of each vector,
+which gets swapped with y/z for sides 1/2 before the left transform and after the right transform
+(rather than storing a rotated basis, whose pattern would vary per side)
+*/
+struct SparseEigenTransform {
+	int n;
+	std::vector<std::string> left, right;
+	std::vector<int> rotatedVectors;
+
+	SparseEigenTransform(int n_);
+
+	//number of reals stored per interface.  this becomes EIGEN_TRANSFORM_STRUCT_SIZE
+	int getStructSize() const;
+
+	/*
+	defines SPARSE_EIGEN_TRANSFORM, leftEigenvectorTransform, rightEigenvectorTransform,
+	and packEigenBasis(dst, left, right), which calcEigenBasis calls with its dense (private, side 0) matrices
+	*/
+	std::string getProgramSource() const;
+
+protected:
+	//distinct symbols, in order of first appearance (left then right)
+	std::vector<std::string> getSymbols() const;
+	int getSlot(const std::string& symbol) const;
+	std::string getTransformBody(const std::vector<std::string>& matrix, const std::string& input, const std::string& output) const;
+	std::string getRotation(const std::string& var) const;
+};
+
+}
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "HydroGPU/Solver/Solver.h"
+#include "HydroGPU/Integrator/ForwardEuler.h"
+#include "HydroGPU/Boundary/Boundary.h"
+#include "HydroGPU/HydroGPUApp.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <string>
+
+namespace HydroGPU {
+namespace Solver {
+
+/*
+lua 'temporalBlockSteps': advance the 1D and 2D Euler Roe and HLL solvers that many steps per launch (EulerTemporalBlock.cl)
+each work group takes a tile of interior cells, plus a halo of getTemporalBlockRadius() cells per step,
+through all the steps in local memory.  tiles are as big as the device local memory allows,
+so a 1D grid that fits runs as a single work group.
+only used with useFixedDT, ForwardEuler, and no useGravity, and while no side mixes periodic and non-periodic states.
+otherwise (or if a tile doesn't fit) update() is the usual one.
+Parent needs to be a SelfGravitationBehavior (for the potential and solid buffers)
+*/
+template<typename Parent>
+struct TemporalBlockBehavior : public Parent {
+	typedef Parent Super;
+	using Super::Super;
+protected:
+	int temporalBlockSteps = 0;
+	int temporalBlockTile[2] = {0, 0};	//interior cells per work group, or 0 if not blocking
+	cl::Kernel temporalBlockKernel;
+	cl::Buffer temporalBlockSourceBuffer;	//the state at the start of the launch, for the halos that neighboring tiles overwrite
+	cl::NDRange temporalBlockGlobalSize;
+	cl::NDRange temporalBlockLocalSize;
+
+	//"ROE" or "HLL", for the interface flux of EulerTemporalBlock.cl, or empty if it doesn't have the solver's flux
+	virtual std::string getTemporalBlockFlux() { return std::string(); }
+
+	//cells a step reaches: the Roe slope limiter looks one interface further than the HLL flux
+	int getTemporalBlockRadius() { return getTemporalBlockFlux() == "ROE" ? 2 : 1; }
+
+public:
+	virtual void init() {
+		Super::app->lua["temporalBlockSteps"] >> temporalBlockSteps;
+		Super::init();
+	}
+
+	virtual void update() {
+		if (!canTemporalBlock()) {
+			Super::update();
+			return;
+		}
+
+		real dt = Super::app->fixedDT;
+		if (Super::app->showTimestep) {
+			std::cout << "dt " << dt << " x " << temporalBlockSteps << std::endl;
+		}
+		size_t bufferSize = Super::storageSize * Super::numStates() * Super::getVolume();
+		Super::commands.enqueueCopyBuffer(Super::stateBuffer, temporalBlockSourceBuffer, 0, 0, bufferSize);
+		Super::setRealArg(temporalBlockKernel, 6, dt);
+		temporalBlockKernel.setArg(7, Super::slopeLimiter);
+		Super::commands.enqueueNDRangeKernel(temporalBlockKernel, Super::offsetNd, temporalBlockGlobalSize, temporalBlockLocalSize);
+
+		if (Super::conservationDiagnostic) Super::reportConservation();
+
+		Super::frame += temporalBlockSteps;
+	}
+
+protected:
+	//picks temporalBlockTile: the biggest tile whose cells and halo fit in local memory
+	void initTemporalBlockTile() {
+		temporalBlockTile[0] = temporalBlockTile[1] = 0;
+		HydroGPUApp* app = Super::app;
+		if (temporalBlockSteps < 2 || getTemporalBlockFlux().empty()) return;
+		if (app->dim > 2) {
+			std::cout << "temporalBlockSteps is only for 1D and 2D grids" << std::endl;
+			return;
+		}
+
+		//state and flux, and the deltaQTilde for the Roe limiter, and the deriv so the sides of 2D see the same state
+		int numArrays = 2 + (getTemporalBlockFlux() == "ROE") + (app->dim > 1);
+		size_t localMemSize = app->clCommon->device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+		int maxCells = (int)(localMemSize / (Super::realSize * Super::numStates() * numArrays));
+		int halo = 2 * getTemporalBlockRadius() * temporalBlockSteps;
+
+		if (app->dim == 1) {
+			temporalBlockTile[0] = std::min(app->size.s[0] - 4, maxCells - halo);
+			temporalBlockTile[1] = 1;
+		} else {
+			temporalBlockTile[0] = std::min(app->size.s[0] - 4, (int)sqrt((double)maxCells) - halo);
+			if (temporalBlockTile[0] > 0) {
+				temporalBlockTile[1] = std::min(app->size.s[1] - 4, maxCells / (temporalBlockTile[0] + halo) - halo);
+			}
+		}
+		if (temporalBlockTile[0] < 1 || temporalBlockTile[1] < 1) {
+			std::cout << "temporalBlockSteps " << temporalBlockSteps << " leaves no room for a tile in " << localMemSize << " bytes of local memory -- not blocking" << std::endl;
+			temporalBlockTile[0] = temporalBlockTile[1] = 0;
+		}
+	}
+
+	virtual std::vector<std::string> getProgramSources() {
+		std::vector<std::string> sources = Super::getProgramSources();
+		initTemporalBlockTile();
+		if (!temporalBlockTile[0]) return sources;
+		sources.push_back(
+			"#define TEMPORAL_BLOCK_" + getTemporalBlockFlux() + " 1\n"
+			"#define TEMPORAL_BLOCK_RADIUS " + std::to_string(getTemporalBlockRadius()) + "\n"
+			"#define TEMPORAL_BLOCK_STEPS " + std::to_string(temporalBlockSteps) + "\n"
+			"#define TEMPORAL_BLOCK_TILE_X " + std::to_string(temporalBlockTile[0]) + "\n"
+			"#define TEMPORAL_BLOCK_TILE_Y " + std::to_string(temporalBlockTile[1]) + "\n"
+			"#include \"EulerTemporalBlock.cl\"\n");
+		return sources;
+	}
+
+	virtual void initBuffers() {
+		Super::initBuffers();
+		if (!temporalBlockTile[0]) return;
+		temporalBlockSourceBuffer = Super::cl.alloc(Super::storageSize * Super::numStates() * Super::getVolume(), "TemporalBlockBehavior::temporalBlockSourceBuffer");
+	}
+
+	virtual void initKernels() {
+		Super::initKernels();
+		if (!temporalBlockTile[0]) return;
+
+		temporalBlockKernel = cl::Kernel(Super::program, "temporalBlock");
+		CLCommon::setArgs(temporalBlockKernel, Super::stateBuffer, temporalBlockSourceBuffer, Super::getPotentialBuffer(), Super::getSolidBuffer(), Super::boundaryMethodsBuffer, Super::defsBuffer);
+
+		//the work items of a group stride over its tile, so any count will do.  as many as the kernel can take, up to the usual local size.
+		HydroGPUApp* app = Super::app;
+		size_t maxItems = temporalBlockKernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(app->clCommon->device);
+		size_t numGroups[2];
+		for (int n = 0; n < 2; ++n) {
+			numGroups[n] = n < app->dim ? (app->size.s[n] - 4 + temporalBlockTile[n] - 1) / temporalBlockTile[n] : 1;
+		}
+		if (app->dim == 1) {
+			size_t items = std::min<size_t>(maxItems, 256);
+			temporalBlockLocalSize = cl::NDRange(items);
+			temporalBlockGlobalSize = cl::NDRange(numGroups[0] * items);
+		} else {
+			size_t items[2] = {Super::localSize[0], Super::localSize[1]};
+			while (items[0] * items[1] > maxItems) {
+				items[items[1] > items[0]] >>= 1;
+			}
+			temporalBlockLocalSize = cl::NDRange(items[0], items[1]);
+			temporalBlockGlobalSize = cl::NDRange(numGroups[0] * items[0], numGroups[1] * items[1]);
+		}
+
+		int halo = 2 * getTemporalBlockRadius() * temporalBlockSteps;
+		double tileVolume = temporalBlockTile[0] * temporalBlockTile[1];
+		double computedVolume = (temporalBlockTile[0] + halo) * (app->dim > 1 ? temporalBlockTile[1] + halo : 1);
+		std::cout << "temporal block tile " << temporalBlockTile[0] << " x " << temporalBlockTile[1]
+			<< ", " << numGroups[0] * numGroups[1] << " work groups"
+			<< ", " << (int)(100. * (computedVolume / tileVolume - 1.)) << "% of cells recomputed in halos" << std::endl;
+	}
+
+	//checked each update, since the gui can change these
+	bool canTemporalBlock() {
+		HydroGPUApp* app = Super::app;
+		if (!temporalBlockTile[0] || !app->useFixedDT || app->useGravity) return false;
+		if (!dynamic_cast<HydroGPU::Integrator::ForwardEuler*>(Super::integrator.get())) return false;
+
+		//the kernel reads these as well
+		Super::updateBoundaryMethods(Super::boundaryMethodsBuffer, Super::boundaryMethodsVec, Super::getBoundaryMethods());
+		int n = Super::numStates();
+		for (int side = 0; side < app->dim; ++side) {
+			int numPeriodic = 0;
+			for (int minmax = 0; minmax < 2; ++minmax) {
+				for (int j = 0; j < n; ++j) {
+					numPeriodic += Super::boundaryMethodsVec[j + n * (minmax + 2 * side)] == BOUNDARY_KERNEL_PERIODIC;
+				}
+			}
+			if (numPeriodic != 0 && numPeriodic != 2 * n) return false;
+		}
+		return true;
+	}
+};
+
+}
+}
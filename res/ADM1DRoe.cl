@@ -14,12 +14,12 @@ __kernel void calcEigenBasisSide(
 	int side)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	int index = INDEXV(i);
@@ -108,17 +108,38 @@ void eigenfieldInverseTransform(
 	results[STATE_K_TILDE] = sqrt_f * (v3 - v1);
 }
 
+//ImplicitSource.cl
+#define NUM_IMPLICIT_STATES 2
+constant int implicitStates[NUM_IMPLICIT_STATES] = {STATE_ALPHA, STATE_G};
+
+void calcSource(real* source, const real* state);
+void calcSource(real* source, const real* state) {
+	for (int j = 0; j < NUM_STATES; ++j) {
+		source[j] = 0.;
+	}
+
+	real alpha = state[STATE_ALPHA];
+	real g = state[STATE_G];
+	//real A = state[STATE_A];
+	//real D = state[STATE_D];
+	real KTilde = state[STATE_K_TILDE];
+	real f = adm_BonaMasso_f;
+	real tmp1 = alpha / sqrt(g);
+	source[STATE_ALPHA] -= tmp1 * alpha * f * KTilde / g;
+	source[STATE_G] -= 2.f * tmp1 * KTilde;
+}
+
 __kernel void addSource(
 	__global real* derivBuffer,
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -126,16 +147,15 @@ __kernel void addSource(
 	int index = INDEXV(i);
 	
 	__global real* deriv = derivBuffer + NUM_STATES * index;
-	const __global real* state = stateBuffer + NUM_STATES * index;
+	clearSplitDeriv(deriv);
 	
-	real alpha = state[STATE_ALPHA];
-	real g = state[STATE_G];
-	//real A = state[STATE_A];
-	//real D = state[STATE_D];
-	real KTilde = state[STATE_K_TILDE];
-	real f = adm_BonaMasso_f;
-	real tmp1 = alpha / sqrt(g);
-	deriv[STATE_ALPHA] -= tmp1 * alpha * f * KTilde / g;
-	deriv[STATE_G] -= 2.f * tmp1 * KTilde;
+	real state[NUM_STATES];
+	for (int j = 0; j < NUM_STATES; ++j) {
+		state[j] = stateBuffer[j + NUM_STATES * index];
+	}
+	real source[NUM_STATES];
+	calcSource(source, state);
+	for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+		deriv[implicitStates[k]] += source[implicitStates[k]];
+	}
 }
-
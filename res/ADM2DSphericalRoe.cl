@@ -33,12 +33,12 @@ __kernel void calcEigenBasis(
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	int index = INDEXV(i);
@@ -147,12 +147,12 @@ __kernel void addSource(
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -27,12 +27,12 @@ void calcEigenBasisSide(
 	int side)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	int index = INDEXV(i);
@@ -265,7 +265,7 @@ void leftEigenvectorTransform(
 }
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvectorData,
 	const real* input,
 	int side)
@@ -395,17 +395,317 @@ void rightEigenvectorTransform(
 	}
 }
 
+/*
+block-decomposed transforms used by the flux
+
+the eigenfields split into
+	the gauge pair: fields 0 and 29, at -+alpha sqrt(f gamma^nn)
+	five light cone pairs: fields 1-5 and 24-28, at -+alpha sqrt(gamma^nn)
+	and 18 zero-speed fields: 6-23
+the zero-speed fields have zero flux, so they're never transformed, limited, or stored.
+that leaves 12 waves, ordered as the fields are: wave w is field w for w < 6, and field w + 18 otherwise.
+so wave k and wave k + 5 make up light cone pair k (for k = 1..5), and waves 0 and 11 are the gauge pair.
+*/
+#define NUM_WAVES 12
+#define WAVE_FIELD(w)	((w) < 6 ? (w) : (w) + 18)
+
+//rows 0-5 and 24-29 of leftEigenvectorTransform
+//input is the 30 flux fields (without the 7 time-only fields in front)
+void leftEigenvectorWaveTransform(
+	real* waves,
+	const __global real* eigenvectorData,
+	const real* input,
+	int side);
+
+void leftEigenvectorWaveTransform(
+	real* waves,
+	const __global real* eigenvectorData,
+	const real* input,
+	int side)
+{
+	real gammaUxx = eigenvectorData[37], gammaUxy = eigenvectorData[38], gammaUxz = eigenvectorData[39], gammaUyy = eigenvectorData[40], gammaUyz = eigenvectorData[41], gammaUzz = eigenvectorData[42];
+	real f = eigenvectorData[44];
+	
+	real sqrt_f = sqrt(f);
+
+	// left eigenvectors in x:
+	if (side == 0) {
+		real sqrt_gammaUxx = sqrt(gammaUxx);
+		real gammaUxx_toThe_3_2 = sqrt_gammaUxx * gammaUxx;
+		
+		waves[0] = ((sqrt_f * gammaUxx_toThe_3_2 * input[21]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUxz * input[23]) + (sqrt_f * sqrt_gammaUxx * gammaUyy * input[24]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUyz * input[25]) + (((((((sqrt_f * sqrt_gammaUxx * gammaUzz * input[26]) - (gammaUxx * input[0])) - (2.f * gammaUxx * input[27])) - (gammaUxy * input[1])) - (2.f * gammaUxy * input[28])) - (gammaUxz * input[2])) - (2.f * gammaUxz * input[29])));
+		waves[1] = ((-(input[1] + (2.f * input[28]) + ((((2.f * gammaUxx * input[4]) - (gammaUxx * input[9])) - (2.f * sqrt_gammaUxx * input[22])) - (2.f * gammaUxz * input[11])) + ((((2.f * gammaUxz * input[16]) - (gammaUyy * input[12])) - (2.f * gammaUyz * input[13])) - (gammaUzz * input[14])))) / 2.f);
+		waves[2] = ((-(input[2] + (2.f * input[29]) + (((2.f * gammaUxx * input[5]) - (gammaUxx * input[15])) - (2.f * sqrt_gammaUxx * input[23])) + (((((2.f * gammaUxy * input[11]) - (2.f * gammaUxy * input[16])) - (gammaUyy * input[18])) - (2.f * gammaUyz * input[19])) - (gammaUzz * input[20])))) / 2.f);
+		waves[3] = (-(((gammaUxx * input[6]) - (sqrt_gammaUxx * input[24])) + (gammaUxy * input[12]) + (gammaUxz * input[18])));
+		waves[4] = (-(((gammaUxx * input[7]) - (sqrt_gammaUxx * input[25])) + (gammaUxy * input[13]) + (gammaUxz * input[19])));
+		waves[5] = (-(((gammaUxx * input[8]) - (sqrt_gammaUxx * input[26])) + (gammaUxy * input[14]) + (gammaUxz * input[20])));
+		waves[6] = ((input[1] + (2.f * input[28]) + ((2.f * gammaUxx * input[4]) - (gammaUxx * input[9])) + ((2.f * sqrt_gammaUxx * input[22]) - (2.f * gammaUxz * input[11])) + ((((2.f * gammaUxz * input[16]) - (gammaUyy * input[12])) - (2.f * gammaUyz * input[13])) - (gammaUzz * input[14]))) / 2.f);
+		waves[7] = ((input[2] + (2.f * input[29]) + ((2.f * gammaUxx * input[5]) - (gammaUxx * input[15])) + (2.f * sqrt_gammaUxx * input[23]) + (((((2.f * gammaUxy * input[11]) - (2.f * gammaUxy * input[16])) - (gammaUyy * input[18])) - (2.f * gammaUyz * input[19])) - (gammaUzz * input[20]))) / 2.f);
+		waves[8] = ((gammaUxx * input[6]) + (sqrt_gammaUxx * input[24]) + (gammaUxy * input[12]) + (gammaUxz * input[18]));
+		waves[9] = ((gammaUxx * input[7]) + (sqrt_gammaUxx * input[25]) + (gammaUxy * input[13]) + (gammaUxz * input[19]));
+		waves[10] = ((gammaUxx * input[8]) + (sqrt_gammaUxx * input[26]) + (gammaUxy * input[14]) + (gammaUxz * input[20]));
+		waves[11] = ((sqrt_f * gammaUxx_toThe_3_2 * input[21]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUxz * input[23]) + (sqrt_f * sqrt_gammaUxx * gammaUyy * input[24]) + (2.f * sqrt_f * sqrt_gammaUxx * gammaUyz * input[25]) + (sqrt_f * sqrt_gammaUxx * gammaUzz * input[26]) + (gammaUxx * input[0]) + (2.f * gammaUxx * input[27]) + (gammaUxy * input[1]) + (2.f * gammaUxy * input[28]) + (gammaUxz * input[2]) + (2.f * gammaUxz * input[29]));
+	// left eigenvectors in y:
+	} else if (side == 1) {
+		real sqrt_gammaUyy = sqrt(gammaUyy);
+		real gammaUyy_toThe_3_2 = sqrt_gammaUyy * gammaUyy;
+		
+		waves[0] = ((sqrt_f * gammaUyy_toThe_3_2 * input[24]) + (sqrt_f * sqrt_gammaUyy * gammaUxx * input[21]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUxz * input[23]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUyz * input[25]) + (((((((sqrt_f * sqrt_gammaUyy * gammaUzz * input[26]) - (gammaUxy * input[0])) - (2.f * gammaUxy * input[27])) - (gammaUyy * input[1])) - (2.f * gammaUyy * input[28])) - (gammaUyz * input[2])) - (2.f * gammaUyz * input[29])));
+		waves[1] = (-((gammaUxy * input[3]) + ((gammaUyy * input[9]) - (sqrt_gammaUyy * input[21])) + (gammaUyz * input[15])));
+		waves[2] = ((-(input[0] + ((((2.f * input[27]) - (gammaUxx * input[3])) - (2.f * gammaUxz * input[5])) - (gammaUyy * input[6])) + (((2.f * gammaUyy * input[10]) - (2.f * sqrt_gammaUyy * input[22])) - (2.f * gammaUyz * input[7])) + ((2.f * gammaUyz * input[16]) - (gammaUzz * input[8])))) / 2.f);
+		waves[3] = (-((gammaUxy * input[5]) + ((gammaUyy * input[11]) - (sqrt_gammaUyy * input[23])) + (gammaUyz * input[17])));
+		waves[4] = ((-(input[2] + ((2.f * input[29]) - (gammaUxx * input[15])) + (((2.f * gammaUxy * input[7]) - (2.f * gammaUxy * input[16])) - (2.f * gammaUxz * input[17])) + ((((2.f * gammaUyy * input[13]) - (gammaUyy * input[18])) - (2.f * sqrt_gammaUyy * input[25])) - (gammaUzz * input[20])))) / 2.f);
+		waves[5] = (-((gammaUxy * input[8]) + ((gammaUyy * input[14]) - (sqrt_gammaUyy * input[26])) + (gammaUyz * input[20])));
+		waves[6] = ((gammaUxy * input[3]) + (gammaUyy * input[9]) + (sqrt_gammaUyy * input[21]) + (gammaUyz * input[15]));
+		waves[7] = ((input[0] + ((((2.f * input[27]) - (gammaUxx * input[3])) - (2.f * gammaUxz * input[5])) - (gammaUyy * input[6])) + (2.f * gammaUyy * input[10]) + ((2.f * sqrt_gammaUyy * input[22]) - (2.f * gammaUyz * input[7])) + ((2.f * gammaUyz * input[16]) - (gammaUzz * input[8]))) / 2.f);
+		waves[8] = ((gammaUxy * input[5]) + (gammaUyy * input[11]) + (sqrt_gammaUyy * input[23]) + (gammaUyz * input[17]));
+		waves[9] = ((input[2] + ((2.f * input[29]) - (gammaUxx * input[15])) + (((2.f * gammaUxy * input[7]) - (2.f * gammaUxy * input[16])) - (2.f * gammaUxz * input[17])) + ((2.f * gammaUyy * input[13]) - (gammaUyy * input[18])) + ((2.f * sqrt_gammaUyy * input[25]) - (gammaUzz * input[20]))) / 2.f);
+		waves[10] = ((gammaUxy * input[8]) + (gammaUyy * input[14]) + (sqrt_gammaUyy * input[26]) + (gammaUyz * input[20]));
+		waves[11] = ((sqrt_f * gammaUyy_toThe_3_2 * input[24]) + (sqrt_f * sqrt_gammaUyy * gammaUxx * input[21]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUxz * input[23]) + (2.f * sqrt_f * sqrt_gammaUyy * gammaUyz * input[25]) + (sqrt_f * sqrt_gammaUyy * gammaUzz * input[26]) + (gammaUxy * input[0]) + (2.f * gammaUxy * input[27]) + (gammaUyy * input[1]) + (2.f * gammaUyy * input[28]) + (gammaUyz * input[2]) + (2.f * gammaUyz * input[29]));
+	// left eigenvectors in z:
+	} else if (side == 2) {
+		real sqrt_gammaUzz = sqrt(gammaUzz);
+		real gammaUzz_toThe_3_2 = sqrt_gammaUzz * gammaUzz;
+		
+		waves[0] = ((sqrt_f * gammaUzz_toThe_3_2 * input[26]) + (sqrt_f * sqrt_gammaUzz * gammaUxx * input[21]) + (2.f * sqrt_f * sqrt_gammaUzz * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUzz * gammaUxz * input[23]) + (sqrt_f * sqrt_gammaUzz * gammaUyy * input[24]) + (((((((2.f * sqrt_f * sqrt_gammaUzz * gammaUyz * input[25]) - (gammaUxz * input[0])) - (2.f * gammaUxz * input[27])) - (gammaUyz * input[1])) - (2.f * gammaUyz * input[28])) - (gammaUzz * input[2])) - (2.f * gammaUzz * input[29])));
+		waves[1] = (-((gammaUxz * input[3]) + (gammaUyz * input[9]) + ((gammaUzz * input[15]) - (sqrt_gammaUzz * input[21]))));
+		waves[2] = (-((gammaUxz * input[4]) + (gammaUyz * input[10]) + ((gammaUzz * input[16]) - (sqrt_gammaUzz * input[22]))));
+		waves[3] = ((-(input[0] + (((((2.f * input[27]) - (gammaUxx * input[3])) - (2.f * gammaUxy * input[4])) - (gammaUyy * input[6])) - (2.f * gammaUyz * input[7])) + ((2.f * gammaUyz * input[11]) - (gammaUzz * input[8])) + ((2.f * gammaUzz * input[17]) - (2.f * sqrt_gammaUzz * input[23])))) / 2.f);
+		waves[4] = (-((gammaUxz * input[6]) + (gammaUyz * input[12]) + ((gammaUzz * input[18]) - (sqrt_gammaUzz * input[24]))));
+		waves[5] = ((-(input[1] + (((2.f * input[28]) - (gammaUxx * input[9])) - (2.f * gammaUxy * input[10])) + ((((2.f * gammaUxz * input[7]) - (2.f * gammaUxz * input[11])) - (gammaUyy * input[12])) - (gammaUzz * input[14])) + ((2.f * gammaUzz * input[19]) - (2.f * sqrt_gammaUzz * input[25])))) / 2.f);
+		waves[6] = ((gammaUxz * input[3]) + (gammaUyz * input[9]) + (gammaUzz * input[15]) + (sqrt_gammaUzz * input[21]));
+		waves[7] = ((gammaUxz * input[4]) + (gammaUyz * input[10]) + (gammaUzz * input[16]) + (sqrt_gammaUzz * input[22]));
+		waves[8] = ((input[0] + (((((2.f * input[27]) - (gammaUxx * input[3])) - (2.f * gammaUxy * input[4])) - (gammaUyy * input[6])) - (2.f * gammaUyz * input[7])) + ((2.f * gammaUyz * input[11]) - (gammaUzz * input[8])) + (2.f * gammaUzz * input[17]) + (2.f * sqrt_gammaUzz * input[23])) / 2.f);
+		waves[9] = ((gammaUxz * input[6]) + (gammaUyz * input[12]) + (gammaUzz * input[18]) + (sqrt_gammaUzz * input[24]));
+		waves[10] = ((input[1] + (((2.f * input[28]) - (gammaUxx * input[9])) - (2.f * gammaUxy * input[10])) + ((((2.f * gammaUxz * input[7]) - (2.f * gammaUxz * input[11])) - (gammaUyy * input[12])) - (gammaUzz * input[14])) + (2.f * gammaUzz * input[19]) + (2.f * sqrt_gammaUzz * input[25])) / 2.f);
+		waves[11] = ((sqrt_f * gammaUzz_toThe_3_2 * input[26]) + (sqrt_f * sqrt_gammaUzz * gammaUxx * input[21]) + (2.f * sqrt_f * sqrt_gammaUzz * gammaUxy * input[22]) + (2.f * sqrt_f * sqrt_gammaUzz * gammaUxz * input[23]) + (sqrt_f * sqrt_gammaUzz * gammaUyy * input[24]) + (2.f * sqrt_f * sqrt_gammaUzz * gammaUyz * input[25]) + (gammaUxz * input[0]) + (2.f * gammaUxz * input[27]) + (gammaUyz * input[1]) + (2.f * gammaUyz * input[28]) + (gammaUzz * input[2]) + (2.f * gammaUzz * input[29]));
+	}
+}
+
+/*
+rightEigenvectorTransform with the zero-speed fields dropped
+each pair only shows up through its sum and difference.
+flux entries that only zero-speed fields map to are never written,
+so they keep the zero that FiniteVolumeSolver::initBuffers filled them with.
+*/
+void rightEigenvectorWaveTransform(
+	__global real* flux,
+	const __global real* eigenvectorData,
+	const real* waves,
+	int side);
+
+void rightEigenvectorWaveTransform(
+	__global real* flux,
+	const __global real* eigenvectorData,
+	const real* waves,
+	int side)
+{
+	real gammaUxx = eigenvectorData[37], gammaUxy = eigenvectorData[38], gammaUxz = eigenvectorData[39], gammaUyy = eigenvectorData[40], gammaUyz = eigenvectorData[41], gammaUzz = eigenvectorData[42];
+	real f = eigenvectorData[44];
+
+	real sqrt_f = sqrt(f);
+
+	real gaugeSum = waves[0] + waves[11];
+	real gaugeDiff = waves[0] - waves[11];
+	real lightSum[5], lightDiff[5];
+	for (int k = 0; k < 5; ++k) {
+		lightSum[k] = waves[1+k] + waves[6+k];
+		lightDiff[k] = waves[1+k] - waves[6+k];
+	}
+
+	// right eigenvectors in x:
+	if (side == 0) {
+		real sqrt_gammaUxx = sqrt(gammaUxx);
+		real gammaUxx_toThe_3_2 = sqrt_gammaUxx * gammaUxx;
+		real gammaUxxSq = gammaUxx * gammaUxx;
+		
+		//A_x
+		flux[0] = -gaugeDiff / (2.f * gammaUxx);
+		//D_xij
+		flux[3] = ((f * ((2.f * gammaUxy * lightDiff[0]) + (2.f * gammaUxz * lightDiff[1]) + (gammaUyy * lightDiff[2]) + (2.f * gammaUyz * lightDiff[3]) + (gammaUzz * lightDiff[4]))) - gaugeDiff) / (2.f * f * gammaUxxSq);
+		flux[4] = -lightDiff[0] / (2.f * gammaUxx);
+		flux[5] = -lightDiff[1] / (2.f * gammaUxx);
+		flux[6] = -lightDiff[2] / (2.f * gammaUxx);
+		flux[7] = -lightDiff[3] / (2.f * gammaUxx);
+		flux[8] = -lightDiff[4] / (2.f * gammaUxx);
+		//K_ij
+		flux[21] = (gaugeSum - (sqrt_f * ((2.f * gammaUxy * lightSum[0]) + (2.f * gammaUxz * lightSum[1]) + (gammaUyy * lightSum[2]) + (2.f * gammaUyz * lightSum[3]) + (gammaUzz * lightSum[4])))) / (2.f * sqrt_f * gammaUxx_toThe_3_2);
+		flux[22] = lightSum[0] / (2.f * sqrt_gammaUxx);
+		flux[23] = lightSum[1] / (2.f * sqrt_gammaUxx);
+		flux[24] = lightSum[2] / (2.f * sqrt_gammaUxx);
+		flux[25] = lightSum[3] / (2.f * sqrt_gammaUxx);
+		flux[26] = lightSum[4] / (2.f * sqrt_gammaUxx);
+	// right eigenvectors in y:
+	} else if (side == 1) {
+		real sqrt_gammaUyy = sqrt(gammaUyy);
+		real gammaUyy_toThe_3_2 = sqrt_gammaUyy * gammaUyy;
+		real gammaUyySq = gammaUyy * gammaUyy;
+		
+		//A_y
+		flux[1] = -gaugeDiff / (2.f * gammaUyy);
+		//D_yij
+		flux[9] = -lightDiff[0] / (2.f * gammaUyy);
+		flux[10] = -lightDiff[1] / (2.f * gammaUyy);
+		flux[11] = -lightDiff[2] / (2.f * gammaUyy);
+		flux[12] = ((f * ((gammaUxx * lightDiff[0]) + (2.f * gammaUxy * lightDiff[1]) + (2.f * gammaUxz * lightDiff[2]) + (2.f * gammaUyz * lightDiff[3]) + (gammaUzz * lightDiff[4]))) - gaugeDiff) / (2.f * f * gammaUyySq);
+		flux[13] = -lightDiff[3] / (2.f * gammaUyy);
+		flux[14] = -lightDiff[4] / (2.f * gammaUyy);
+		//K_ij
+		flux[21] = lightSum[0] / (2.f * sqrt_gammaUyy);
+		flux[22] = lightSum[1] / (2.f * sqrt_gammaUyy);
+		flux[23] = lightSum[2] / (2.f * sqrt_gammaUyy);
+		flux[24] = (gaugeSum - (sqrt_f * ((gammaUxx * lightSum[0]) + (2.f * gammaUxy * lightSum[1]) + (2.f * gammaUxz * lightSum[2]) + (2.f * gammaUyz * lightSum[3]) + (gammaUzz * lightSum[4])))) / (2.f * sqrt_f * gammaUyy_toThe_3_2);
+		flux[25] = lightSum[3] / (2.f * sqrt_gammaUyy);
+		flux[26] = lightSum[4] / (2.f * sqrt_gammaUyy);
+	// right eigenvectors in z:
+	} else if (side == 2) {
+		real sqrt_gammaUzz = sqrt(gammaUzz);
+		real gammaUzz_toThe_3_2 = sqrt_gammaUzz * gammaUzz;
+		real gammaUzzSq = gammaUzz * gammaUzz;
+		
+		//A_z
+		flux[2] = -gaugeDiff / (2.f * gammaUzz);
+		//D_zij
+		flux[15] = -lightDiff[0] / (2.f * gammaUzz);
+		flux[16] = -lightDiff[1] / (2.f * gammaUzz);
+		flux[17] = -lightDiff[2] / (2.f * gammaUzz);
+		flux[18] = -lightDiff[3] / (2.f * gammaUzz);
+		flux[19] = -lightDiff[4] / (2.f * gammaUzz);
+		flux[20] = ((f * ((gammaUxx * lightDiff[0]) + (2.f * gammaUxy * lightDiff[1]) + (2.f * gammaUxz * lightDiff[2]) + (gammaUyy * lightDiff[3]) + (2.f * gammaUyz * lightDiff[4]))) - gaugeDiff) / (2.f * f * gammaUzzSq);
+		//K_ij
+		flux[21] = lightSum[0] / (2.f * sqrt_gammaUzz);
+		flux[22] = lightSum[1] / (2.f * sqrt_gammaUzz);
+		flux[23] = lightSum[2] / (2.f * sqrt_gammaUzz);
+		flux[24] = lightSum[3] / (2.f * sqrt_gammaUzz);
+		flux[25] = lightSum[4] / (2.f * sqrt_gammaUzz);
+		flux[26] = (gaugeSum - (sqrt_f * ((gammaUxx * lightSum[0]) + (2.f * gammaUxy * lightSum[1]) + (2.f * gammaUxz * lightSum[2]) + (gammaUyy * lightSum[3]) + (2.f * gammaUyz * lightSum[4])))) / (2.f * sqrt_f * gammaUzz_toThe_3_2);
+	}
+}
+
+//replaces Roe.cl's calcDeltaQTilde.  only the waves are stored, NUM_WAVES per interface
+__kernel void calcWaveDeltaQTilde(
+	__global real* deltaQTildeBuffer,
+	const __global real* eigenvectorsBuffer,
+	const __global real* stateBuffer)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X - 1 
+#if DIM > 1
+		|| i.y >= SIZE_Y - 1
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z - 1
+#endif
+	) return;
+	int index = INDEXV(i);
+
+	for (int side = 0; side < DIM; ++side) {
+		int indexPrev = index - stepsize[side];
+		int interfaceIndex = side + DIM * index;
+		
+		//skip the 7 time-only fields
+		const __global real* stateL = stateBuffer + NUM_STATES * indexPrev + 7;
+		const __global real* stateR = stateBuffer + NUM_STATES * index + 7;
+		const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
+		__global real* deltaQTilde = deltaQTildeBuffer + NUM_WAVES * interfaceIndex;
+
+		real deltaState[EIGEN_SPACE_DIM];
+		for (int j = 0; j < EIGEN_SPACE_DIM; ++j) {
+			deltaState[j] = stateR[j] - stateL[j];
+		}
+		
+		real deltaWaves[NUM_WAVES];
+		leftEigenvectorWaveTransform(deltaWaves, eigenvectors, deltaState, side);
+		for (int w = 0; w < NUM_WAVES; ++w) {
+			deltaQTilde[w] = deltaWaves[w];
+		}
+	}
+}
+
+//replaces Roe.cl's calcFlux.  same args, so Roe::init / Roe::calcFlux set them the same way
+__kernel void calcWaveFlux(
+	__global real* fluxBuffer,
+	const __global real* stateBuffer,
+	const __global real* eigenvaluesBuffer,
+	const __global real* eigenvectorsBuffer,
+	const __global real* deltaQTildeBuffer,
+	real dt,
+	int limiter)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X - 1 
+#if DIM > 1
+		|| i.y >= SIZE_Y - 1
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z - 1
+#endif
+	) return;
+	int index = INDEXV(i);
+
+	for (int side = 0; side < DIM; ++side) {
+		real dt_dx = dt / dx[side];
+		
+		int indexL = index - stepsize[side];
+		int indexR2 = index + stepsize[side];
+		
+		int interfaceLIndex = side + DIM * indexL;
+		int interfaceIndex = side + DIM * index;
+		int interfaceRIndex = side + DIM * indexR2;
+		
+		const __global real* deltaQTildeL = deltaQTildeBuffer + NUM_WAVES * interfaceLIndex;
+		const __global real* deltaQTilde = deltaQTildeBuffer + NUM_WAVES * interfaceIndex;
+		const __global real* deltaQTildeR = deltaQTildeBuffer + NUM_WAVES * interfaceRIndex;
+		
+		const __global real* eigenvalues = eigenvaluesBuffer + EIGEN_SPACE_DIM * interfaceIndex;
+		const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
+		
+		const __global real* stateL = stateBuffer + NUM_STATES * indexL + 7;
+		const __global real* stateR = stateBuffer + NUM_STATES * index + 7;
+
+		real stateAvg[EIGEN_SPACE_DIM];
+		for (int j = 0; j < EIGEN_SPACE_DIM; ++j) {
+			stateAvg[j] = .5f * (stateL[j] + stateR[j]);
+		}
+
+		real fluxTilde[NUM_WAVES];
+		leftEigenvectorWaveTransform(fluxTilde, eigenvectors, stateAvg, side);
+
+		for (int w = 0; w < NUM_WAVES; ++w) {
+			real eigenvalue = eigenvalues[WAVE_FIELD(w)];
+			fluxTilde[w] *= eigenvalue;
+
+			real rTilde;
+			real theta;
+			if (eigenvalue >= 0.) {
+				rTilde = deltaQTildeL[w] / deltaQTilde[w];
+				theta = 1.;
+			} else {
+				rTilde = deltaQTildeR[w] / deltaQTilde[w];
+				theta = -1.;
+			}
+			real phi = slopeLimiter(rTilde, limiter);
+			real epsilon = eigenvalue * dt_dx;
+
+			real deltaFluxTilde = eigenvalue * deltaQTilde[w];
+			fluxTilde[w] -= .5 * deltaFluxTilde * (theta + phi * (epsilon - theta));
+		}
+
+		rightEigenvectorWaveTransform(fluxBuffer + NUM_FLUX_STATES * interfaceIndex, eigenvectors, fluxTilde, side);
+	}
+}
+
 __kernel void calcFluxDeriv(
 	__global real* derivBuffer,
 	const __global real* fluxBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -413,6 +713,7 @@ __kernel void calcFluxDeriv(
 	int index = INDEXV(i);
 
 	__global real* deriv = derivBuffer + NUM_STATES * index;
+	clearDeriv(deriv);
 
 	//this is what makes the ADM3D calcFluxDeriv special
 	//though I'm going to go back to the default for shift conditions, so alpha and gamma do get advected correctly
@@ -431,25 +732,16 @@ __kernel void calcFluxDeriv(
 	}
 }
 
-__kernel void addSource(
-	__global real* derivBuffer,
-	const __global real* stateBuffer)
-{
-	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
-#if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
-#endif
-#if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
-#endif
-	) {
-		return;
+//ImplicitSource.cl
+//only the lapse, metric, extrinsic curvature, and V have sources
+#define NUM_IMPLICIT_STATES 16
+constant int implicitStates[NUM_IMPLICIT_STATES] = {0, 1, 2, 3, 4, 5, 6, 28, 29, 30, 31, 32, 33, 34, 35, 36};
+
+void calcSource(real* source, const real* state);
+void calcSource(real* source, const real* state) {
+	for (int j = 0; j < NUM_STATES; ++j) {
+		source[j] = 0.;
 	}
-	int index = INDEXV(i);
-	
-	__global real* deriv = derivBuffer + NUM_STATES * index;
-	const __global real* state = stateBuffer + NUM_STATES * index;
 
 	real alpha = state[0];
 	real gamma_xx = state[1], gamma_xy = state[2], gamma_xz = state[3], gamma_yy = state[4], gamma_yz = state[5], gamma_zz = state[6];
@@ -765,23 +1057,54 @@ GU0L[2] + AKL[2] - A_z * trK + K12D23L[2] + KD23L[2] - 2 * K12D12L[2] + 2 * KD12
 	-- especially if it is allowed a custom RoeFluxDeriv function.
 	*/
 
-	deriv[0] += -alpha * alpha * f * trK;
-	deriv[1] += -2.f * alpha * K_xx;
-	deriv[2] += -2.f * alpha * K_xy;
-	deriv[3] += -2.f * alpha * K_xz;
-	deriv[4] += -2.f * alpha * K_yy;
-	deriv[5] += -2.f * alpha * K_yz;
-	deriv[6] += -2.f * alpha * K_zz;
+	source[0] += -alpha * alpha * f * trK;
+	source[1] += -2.f * alpha * K_xx;
+	source[2] += -2.f * alpha * K_xy;
+	source[3] += -2.f * alpha * K_xz;
+	source[4] += -2.f * alpha * K_yy;
+	source[5] += -2.f * alpha * K_yz;
+	source[6] += -2.f * alpha * K_zz;
+	
+	source[28] += alpha * SSymLL[0];
+	source[29] += alpha * SSymLL[1];
+	source[30] += alpha * SSymLL[2];
+	source[31] += alpha * SSymLL[3];
+	source[32] += alpha * SSymLL[4];
+	source[33] += alpha * SSymLL[5];
+	source[34] += alpha * PL[0];
+	source[35] += alpha * PL[1];
+	source[36] += alpha * PL[2];
+}
+
+__kernel void addSource(
+	__global real* derivBuffer,
+	const __global real* stateBuffer)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X - 2 
+#if DIM > 1
+		|| i.y >= SIZE_Y - 2 
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z - 2
+#endif
+	) {
+		return;
+	}
+	int index = INDEXV(i);
 	
-	deriv[28] += alpha * SSymLL[0];
-	deriv[29] += alpha * SSymLL[1];
-	deriv[30] += alpha * SSymLL[2];
-	deriv[31] += alpha * SSymLL[3];
-	deriv[32] += alpha * SSymLL[4];
-	deriv[33] += alpha * SSymLL[5];
-	deriv[34] += alpha * PL[0];
-	deriv[35] += alpha * PL[1];
-	deriv[36] += alpha * PL[2];
+	__global real* deriv = derivBuffer + NUM_STATES * index;
+	clearSplitDeriv(deriv);
+
+	real state[NUM_STATES];
+	for (int j = 0; j < NUM_STATES; ++j) {
+		state[j] = stateBuffer[j + NUM_STATES * index];
+	}
+	real source[NUM_STATES];
+	calcSource(source, state);
+	for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+		deriv[implicitStates[k]] += source[implicitStates[k]];
+	}
 }
 
 // the 1D version has no problems, but at 2D we get instabilities ... 
@@ -791,12 +1114,12 @@ __kernel void constrain(
 #if 0	//use constraints at all?
 	
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -5,40 +5,58 @@ In the case that the flux affects non-sequential state vectors, a custom functio
 For that reason, I should probably separate this into its own file, so other solvers can bypass it and overload it.
 */
 __kernel void calcFluxDeriv(
-	__global real* derivBuffer,
-	const __global real* fluxBuffer
+	__global real_storage* derivBuffer,
+	const __global real_storage* fluxBuffer
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef DIMENSIONAL_SPLIT
+	, int splitSide
+#endif	//DIMENSIONAL_SPLIT
 )
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+#endif	//FLUID_DISPATCH
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
 	}
 	int index = INDEXV(i);
+	__global real_storage* deriv = derivBuffer + NUM_STATES * index;
 
 #ifdef SOLID
-	if (solidBuffer[index]) return;
+	if (isSolid(solidBuffer, index)) {
+		clearDeriv(deriv);
+		return;
+	}
 #endif	//SOLID
 
-	__global real* deriv = derivBuffer + NUM_STATES * index;
-
-	for (int side = 0; side < DIM; ++side) {
-		int interfaceIndex = side + DIM * index;
-		int interfaceIndexNext = interfaceIndex + DIM * stepsize[side];
-		const __global real* fluxL = fluxBuffer + NUM_FLUX_STATES * interfaceIndex;
-		const __global real* fluxR = fluxBuffer + NUM_FLUX_STATES * interfaceIndexNext;
-		for (int j = 0; j < NUM_FLUX_STATES; ++j) {
-			real deltaFlux = fluxR[j] - fluxL[j];
-			deriv[j] -= deltaFlux / dx[side];
+	//summed over the sides first, so each deriv is written once
+	for (int j = 0; j < NUM_FLUX_STATES; ++j) {
+		real sum = 0.;
+		for (int side = SIDE_BEGIN; side < SIDE_END; ++side) {
+			int interfaceIndex = INTERFACE_INDEX(side, index);
+			int interfaceIndexNext = INTERFACE_INDEX(side, index + stepsize[side]);
+			real deltaFlux = fluxBuffer[j + NUM_FLUX_STATES * interfaceIndexNext] - fluxBuffer[j + NUM_FLUX_STATES * interfaceIndex];
+			sum -= deltaFlux / dx[side];
 		}
+		addDeriv(deriv[j], sum);
+	}
+#ifdef DERIV_OVERWRITE
+	for (int j = NUM_FLUX_STATES; j < NUM_STATES; ++j) {
+		deriv[j] = 0;
 	}
+#endif	//DERIV_OVERWRITE
 }
@@ -4,6 +4,27 @@ constant int4 size = (int4)(SIZE_X, SIZE_Y, SIZE_Z, 0);
 constant int4 stepsize = (int4)(STEP_X, STEP_Y, STEP_Z, STEP_W);
 constant real4 dx = (real4)(DX, DY, DZ, 1.f);
 
+/*
+DIMENSIONAL_SPLIT (Roe::dimensionalSplit): the interface buffers only hold the side being swept, at the cell index,
+and the kernels that go over the sides only do that one, which they take as their last arg 'splitSide'
+*/
+#ifdef DIMENSIONAL_SPLIT
+#define INTERFACE_INDEX(side, index)	(index)
+#define SIDE_BEGIN	splitSide
+#define SIDE_END	(splitSide + 1)
+#else	//DIMENSIONAL_SPLIT
+#define INTERFACE_INDEX(side, index)	((side) + DIM * (index))
+#define SIDE_BEGIN	0
+#define SIDE_END	DIM
+#endif	//DIMENSIONAL_SPLIT
+
+//for finite difference Jacobians (BackwardEulerNewtonKrylov, ImplicitSource.cl)
+#ifdef PRECISION_SINGLE
+#define SQRT_MACHINE_EPSILON	3.4526698e-4
+#else
+#define SQRT_MACHINE_EPSILON	1.4901161193847656e-8
+#endif
+
 //http://developer.amd.com/resources/documentation-articles/articles-whitepapers/opencl-optimization-case-study-simple-reductions/
 //calculate min of all elements on buffer[0..length-1]
 __kernel void findMinTimestep(
@@ -39,195 +60,352 @@ __kernel void findMinTimestep(
 	}
 }
 
+/*
+conservation diagnostic (Solver::getStateSums)
+per-work-group partial sums of each state over the interior cells: result[state + NUM_STATES * group]
+launched 1D over the whole grid, padded to the local size, which has to be a power of two
+*/
+__kernel void sumStates(
+	__global real* result,
+	const __global real_storage* stateBuffer,
+	__local real* scratch)
+{
+	int index = get_global_id(0);
+	int4 i = (int4)(index % SIZE_X, (index / SIZE_X) % SIZE_Y, index / (SIZE_X * SIZE_Y), 0);
+	bool interior = index < STEP_W
+		&& i.x >= 2 && i.x < SIZE_X - 2
+#if DIM > 1
+		&& i.y >= 2 && i.y < SIZE_Y - 2
+#endif
+#if DIM > 2
+		&& i.z >= 2 && i.z < SIZE_Z - 2
+#endif
+	;
 
-	//boundary methods
-
-
-//periodic
-//ghost cells copy the opposite side
-
-__kernel void stateBoundaryPeriodicXMin(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_Y || j >= SIZE_Z) return;
-	buffer[offset + spacing * INDEX(0, i, j)] = buffer[offset + spacing * INDEX(SIZE_X - 4, i, j)];
-	buffer[offset + spacing * INDEX(1, i, j)] = buffer[offset + spacing * INDEX(SIZE_X - 3, i, j)];
-}
-__kernel void stateBoundaryPeriodicXMax(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_Y || j >= SIZE_Z) return;
-	buffer[offset + spacing * INDEX(SIZE_X - 2, i, j)] = buffer[offset + spacing * INDEX(2, i, j)];
-	buffer[offset + spacing * INDEX(SIZE_X - 1, i, j)] = buffer[offset + spacing * INDEX(3, i, j)];
-}
-
-__kernel void stateBoundaryPeriodicYMin(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_X || j >= SIZE_Z) return;
-	buffer[offset + spacing * INDEX(i, 0, j)] = buffer[offset + spacing * INDEX(i, SIZE_Y - 4, j)];
-	buffer[offset + spacing * INDEX(i, 1, j)] = buffer[offset + spacing * INDEX(i, SIZE_Y - 3, j)];
-}
-__kernel void stateBoundaryPeriodicYMax(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_X || j >= SIZE_Z) return;
-	buffer[offset + spacing * INDEX(i, SIZE_Y - 2, j)] = buffer[offset + spacing * INDEX(i, 2, j)];
-	buffer[offset + spacing * INDEX(i, SIZE_Y - 1, j)] = buffer[offset + spacing * INDEX(i, 3, j)];
+	int local_index = get_local_id(0);
+	for (int j = 0; j < NUM_STATES; ++j) {
+		scratch[local_index] = interior ? (real)stateBuffer[j + NUM_STATES * index] : 0.;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		for (int offset = get_local_size(0) / 2; offset > 0; offset = offset / 2) {
+			if (local_index < offset) {
+				scratch[local_index] += scratch[local_index + offset];
+			}
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+		if (local_index == 0) {
+			result[j + NUM_STATES * get_group_id(0)] = scratch[0];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
 }
 
-__kernel void stateBoundaryPeriodicZMin(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_X || j >= SIZE_Y) return;
-	buffer[offset + spacing * INDEX(i, j, 0)] = buffer[offset + spacing * INDEX(i, j, SIZE_Z - 4)];
-	buffer[offset + spacing * INDEX(i, j, 1)] = buffer[offset + spacing * INDEX(i, j, SIZE_Z - 3)];
-}
-__kernel void stateBoundaryPeriodicZMax(__global real* buffer, int spacing, int offset) {
-	size_t i = get_global_id(0);
-	size_t j = get_global_id(1);
-	if (i >= SIZE_X || j >= SIZE_Y) return;
-	buffer[offset + spacing * INDEX(i, j, SIZE_Z - 2)] = buffer[offset + spacing * INDEX(i, j, 2)];
-	buffer[offset + spacing * INDEX(i, j, SIZE_Z - 1)] = buffer[offset + spacing * INDEX(i, j, 3)];
-}
 
-//mirror
-//ghost cells mirror the next adjacent cells
+	//boundary methods
 
-__kernel void stateBoundaryMirrorXMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(0, i.x, i.y)] = buffer[offset + spacing * INDEX(3, i.x, i.y)];
-	buffer[offset + spacing * INDEX(1, i.x, i.y)] = buffer[offset + spacing * INDEX(2, i.x, i.y)];
-}
-__kernel void stateBoundaryMirrorXMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(SIZE_X - 1, i.x, i.y)] = buffer[offset + spacing * INDEX(SIZE_X - 4, i.x, i.y)];
-	buffer[offset + spacing * INDEX(SIZE_X - 2, i.x, i.y)] = buffer[offset + spacing * INDEX(SIZE_X - 3, i.x, i.y)];
-}
+/*
+applies one boundary kernel to the two ghost cells at one end of a line of cells
+line = pointer to the first cell of the line, with the state offset already applied
+step = distance between successive cells of the line
+n = number of cells in the line, ghost cells included
+*/
+void boundaryLine(__global real_storage* line, int step, int n, int method, int minmax);
 
-__kernel void stateBoundaryMirrorYMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, 0, i.y)] = buffer[offset + spacing * INDEX(i.x, 3, i.y)];
-	buffer[offset + spacing * INDEX(i.x, 1, i.y)] = buffer[offset + spacing * INDEX(i.x, 2, i.y)];
-}
-__kernel void stateBoundaryMirrorYMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, SIZE_Y - 1, i.y)] = buffer[offset + spacing * INDEX(i.x, SIZE_Y - 4, i.y)];
-	buffer[offset + spacing * INDEX(i.x, SIZE_Y - 2, i.y)] = buffer[offset + spacing * INDEX(i.x, SIZE_Y - 3, i.y)];
+void boundaryLine(__global real_storage* line, int step, int n, int method, int minmax) {
+#define CELL(k)	line[step * (k)]
+	if (!minmax) {
+		switch (method) {
+		case BOUNDARY_KERNEL_PERIODIC:	//ghost cells copy the opposite side
+			CELL(0) = CELL(n - 4);
+			CELL(1) = CELL(n - 3);
+			break;
+		case BOUNDARY_KERNEL_MIRROR:	//ghost cells mirror the next adjacent cells
+			CELL(0) = CELL(3);
+			CELL(1) = CELL(2);
+			break;
+		case BOUNDARY_KERNEL_REFLECT:	//ghost cells are negatives of the mirror of the next adjacent cells
+			CELL(0) = -CELL(3);
+			CELL(1) = -CELL(2);
+			break;
+		case BOUNDARY_KERNEL_FREEFLOW:	//ghost cells copy the next adjacent cell
+			CELL(0) = CELL(1) = CELL(2);
+			break;
+		}
+	} else {
+		switch (method) {
+		case BOUNDARY_KERNEL_PERIODIC:
+			CELL(n - 2) = CELL(2);
+			CELL(n - 1) = CELL(3);
+			break;
+		case BOUNDARY_KERNEL_MIRROR:
+			CELL(n - 1) = CELL(n - 4);
+			CELL(n - 2) = CELL(n - 3);
+			break;
+		case BOUNDARY_KERNEL_REFLECT:
+			CELL(n - 1) = -CELL(n - 4);
+			CELL(n - 2) = -CELL(n - 3);
+			break;
+		case BOUNDARY_KERNEL_FREEFLOW:
+			CELL(n - 1) = CELL(n - 2) = CELL(n - 3);
+			break;
+		}
+	}
+#undef CELL
 }
 
-__kernel void stateBoundaryMirrorZMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, 0)] = buffer[offset + spacing * INDEX(i.x, i.y, 3)];
-	buffer[offset + spacing * INDEX(i.x, i.y, 1)] = buffer[offset + spacing * INDEX(i.x, i.y, 2)];
-}
-__kernel void stateBoundaryMirrorZMax(__global real* buffer, int spacing, int offset) {
+/*
+fills the ghost cells of both faces along 'side' for every state at once
+spacing = number of states interleaved in the buffer
+methods[state + spacing * (minmax + 2 * side)] = BOUNDARY_KERNEL_* to apply, or BOUNDARY_KERNEL_NONE
+launched once per side over the face perpendicular to it (see Solver::getBoundaryRanges)
+*/
+__kernel void stateBoundary(
+	__global real_storage* buffer,
+	int spacing,
+	int side,
+	__constant int* methods)
+{
 	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 1)] = buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 4)];
-	buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 2)] = buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 3)];
+	int base;
+	switch (side) {
+	case 0:
+		if (i.x >= SIZE_Y || i.y >= SIZE_Z) return;
+		base = INDEX(0, i.x, i.y);
+		break;
+	case 1:
+		if (i.x >= SIZE_X || i.y >= SIZE_Z) return;
+		base = INDEX(i.x, 0, i.y);
+		break;
+	case 2:
+		if (i.x >= SIZE_X || i.y >= SIZE_Y) return;
+		base = INDEX(i.x, i.y, 0);
+		break;
+	default:
+		return;
+	}
+	
+	int step = spacing * stepsize[side];
+	int n = size[side];
+	for (int minmax = 0; minmax < 2; ++minmax) {
+		__constant int* sideMethods = methods + spacing * (minmax + 2 * side);
+		for (int state = 0; state < spacing; ++state) {
+			boundaryLine(buffer + state + spacing * base, step, n, sideMethods[state], minmax);
+		}
+	}
 }
 
-//reflect
-//ghost cells are negatives of the mirror of the next adjacent cells
 
-__kernel void stateBoundaryReflectXMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(0, i.x, i.y)] = -buffer[offset + spacing * INDEX(3, i.x, i.y)];
-	buffer[offset + spacing * INDEX(1, i.x, i.y)] = -buffer[offset + spacing * INDEX(2, i.x, i.y)];
-}
-__kernel void stateBoundaryReflectXMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(SIZE_X - 1, i.x, i.y)] = -buffer[offset + spacing * INDEX(SIZE_X - 4, i.x, i.y)];
-	buffer[offset + spacing * INDEX(SIZE_X - 2, i.x, i.y)] = -buffer[offset + spacing * INDEX(SIZE_X - 3, i.x, i.y)];
-}
+#ifdef BOUNDARY_REMAP
 
-__kernel void stateBoundaryReflectYMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, 0, i.y)] = -buffer[offset + spacing * INDEX(i.x, 3, i.y)];
-	buffer[offset + spacing * INDEX(i.x, 1, i.y)] = -buffer[offset + spacing * INDEX(i.x, 2, i.y)];
-}
-__kernel void stateBoundaryReflectYMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, SIZE_Y - 1, i.y)] = -buffer[offset + spacing * INDEX(i.x, SIZE_Y - 4, i.y)];
-	buffer[offset + spacing * INDEX(i.x, SIZE_Y - 2, i.y)] = -buffer[offset + spacing * INDEX(i.x, SIZE_Y - 3, i.y)];
-}
+/*
+ghost-free boundaries:
+instead of copying into the ghost layer before each step,
+kernels that read neighboring cells map any ghost cell coordinate back onto the interior.
+maps coordinate k of an axis of n cells (ghost cells included) according to the boundary kernel of the face it lies beyond.
+'sign' is negated for reflecting boundaries.
+*/
+int boundaryRemapCoord(int k, int n, int method, real* sign);
 
-__kernel void stateBoundaryReflectZMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, 0)] = -buffer[offset + spacing * INDEX(i.x, i.y, 3)];
-	buffer[offset + spacing * INDEX(i.x, i.y, 1)] = -buffer[offset + spacing * INDEX(i.x, i.y, 2)];
-}
-__kernel void stateBoundaryReflectZMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 1)] = -buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 4)];
-	buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 2)] = -buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 3)];
+int boundaryRemapCoord(int k, int n, int method, real* sign) {
+	switch (method) {
+	case BOUNDARY_KERNEL_PERIODIC:
+		return k < 2 ? k + n - 4 : k - (n - 4);
+	case BOUNDARY_KERNEL_REFLECT:
+		*sign = -*sign;
+		//and mirror the index
+	case BOUNDARY_KERNEL_MIRROR:
+		return k < 2 ? 3 - k : 2 * n - 5 - k;
+	case BOUNDARY_KERNEL_FREEFLOW:
+		return k < 2 ? 2 : n - 3;
+	}
+	return k;
 }
 
-//freeflow
-//ghost cells copy the next adjacent cell
+/*
+reads the state vector of cell i, which may lie in the ghost layer
+boundaryMethods is laid out as Solver::boundaryMethodsBuffer: [state + NUM_STATES * (minmax + 2 * side)]
+*/
+void readStateRemapped(real* state, const __global real_storage* stateBuffer, int4 i, __constant int* boundaryMethods);
 
-__kernel void stateBoundaryFreeFlowXMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(0, i.x, i.y)] = buffer[offset + spacing * INDEX(1, i.x, i.y)] = buffer[offset + spacing * INDEX(2, i.x, i.y)];
-}
-__kernel void stateBoundaryFreeFlowXMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(SIZE_X - 1, i.x, i.y)] = buffer[offset + spacing * INDEX(SIZE_X - 2, i.x, i.y)] = buffer[offset + spacing * INDEX(SIZE_X - 3, i.x, i.y)];
-}
-
-__kernel void stateBoundaryFreeFlowYMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, 0, i.y)] = buffer[offset + spacing * INDEX(i.x, 1, i.y)] = buffer[offset + spacing * INDEX(i.x, 2, i.y)];
-}
-__kernel void stateBoundaryFreeFlowYMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, SIZE_Y - 1, i.y)] = buffer[offset + spacing * INDEX(i.x, SIZE_Y - 2, i.y)] = buffer[offset + spacing * INDEX(i.x, SIZE_Y - 3, i.y)];
+void readStateRemapped(real* state, const __global real_storage* stateBuffer, int4 i, __constant int* boundaryMethods) {
+	for (int j = 0; j < NUM_STATES; ++j) {
+		int4 src = i;
+		real sign = 1.;
+		for (int side = 0; side < DIM; ++side) {
+			int k = i[side];
+			int n = size[side];
+			if (k < 2) {
+				src[side] = boundaryRemapCoord(k, n, boundaryMethods[j + NUM_STATES * (2 * side)], &sign);
+			} else if (k >= n - 2) {
+				src[side] = boundaryRemapCoord(k, n, boundaryMethods[j + NUM_STATES * (1 + 2 * side)], &sign);
+			}
+		}
+		state[j] = sign * stateBuffer[j + NUM_STATES * INDEXV(src)];
+	}
 }
 
-__kernel void stateBoundaryFreeFlowZMin(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, 0)] = buffer[offset + spacing * INDEX(i.x, i.y, 1)] = buffer[offset + spacing * INDEX(i.x, i.y, 2)];
-}
-__kernel void stateBoundaryFreeFlowZMax(__global real* buffer, int spacing, int offset) {
-	int2 i = (int2)(get_global_id(0), get_global_id(1));
-	buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 1)] = buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 2)] = buffer[offset + spacing * INDEX(i.x, i.y, SIZE_Z - 3)];
-}
+#endif	//BOUNDARY_REMAP
 
 
 	//integration methods
 
-//ForwardEuler, RungeKutta4
-// result[i] = a[i] + b[i] * c
+/*
+DERIV_OVERWRITE (Solver::derivOverwrite): the integrators don't zero the deriv buffers before each callback,
+so the first deriv kernel of each callback has to write every state of every cell it is launched over, solid ones included.
+addDeriv is for kernels that write each state once, clearDeriv is for the ones that add into only some of them.
+*/
+#ifdef DERIV_OVERWRITE
+#define addDeriv(deriv, value)	((deriv) = (value))
+#define clearDeriv(deriv)	for (int clearDerivIndex = 0; clearDerivIndex < NUM_STATES; ++clearDerivIndex) (deriv)[clearDerivIndex] = 0
+#else	//DERIV_OVERWRITE
+#define addDeriv(deriv, value)	((deriv) += (value))
+#define clearDeriv(deriv)
+#endif	//DERIV_OVERWRITE
+
+/*
+clearDeriv for the kernels that only have a callback of their own when the right hand side is split (sources, gravity, diffusion).
+with SINGLE_PASS_RHS (Solver::singlePassRHS) they come after the flux in the same callback, so they add onto what it wrote.
+*/
+#ifdef SINGLE_PASS_RHS
+#define clearSplitDeriv(deriv)
+#else	//SINGLE_PASS_RHS
+#define clearSplitDeriv(deriv)	clearDeriv(deriv)
+#endif	//SINGLE_PASS_RHS
+
+//ForwardEuler, LowStorageRungeKutta, BackwardEulerNewtonKrylov
+// result[i] = a[i] + b[i] * c for i < length
 __kernel void multAdd(
-	__global real* result,
-	const __global real* a,
-	const __global real* b,
-	real c)
+	__global real_storage* result,
+	const __global real_storage* a,
+	const __global real_storage* b,
+	real c,
+	int length)
 {
 	size_t i = get_global_id(0);
-	if (i >= get_global_size(0)) return;
+	if (i >= length) return;
 	result[i] = a[i] + b[i] * c;
 }
 
-//BackwardEulerConjugateGradient
-//result[i] = a[i] - b[i]
-__kernel void subtract(
+//RungeKutta
+//result[i] = sum of a_k[i] * c_k for k < count
+//if saveCurrent, first copies result[i] to save[i], so the stage being overwritten doesn't need its own copy pass
+//the unused buffer args just need to be valid buffers
+__kernel void linearCombination(
+	__global real_storage* result,
+	__global real_storage* save,
+	int saveCurrent,
+	int length,
+	int count,
+	const __global real_storage* a0,
+	real c0,
+	const __global real_storage* a1,
+	real c1,
+	const __global real_storage* a2,
+	real c2,
+	const __global real_storage* a3,
+	real c3,
+	const __global real_storage* a4,
+	real c4,
+	const __global real_storage* a5,
+	real c5,
+	const __global real_storage* a6,
+	real c6,
+	const __global real_storage* a7,
+	real c7)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	if (saveCurrent) save[i] = result[i];
+	real sum = a0[i] * c0;
+	if (count > 1) sum += a1[i] * c1;
+	if (count > 2) sum += a2[i] * c2;
+	if (count > 3) sum += a3[i] * c3;
+	if (count > 4) sum += a4[i] * c4;
+	if (count > 5) sum += a5[i] * c5;
+	if (count > 6) sum += a6[i] * c6;
+	if (count > 7) sum += a7[i] * c7;
+	result[i] = sum;
+}
+
+/*
+EmbeddedRungeKutta
+per-work-group max of |sum of k_j[i] * c_j for j < count| / (absTol + relTol * max(|a[i]|, |b[i]|)), with NaNs as infinity
+where c_j is dt times the difference of the two solutions' weights, and a and b are the old and new state
+launched 1D, padded to the local size, which has to be a power of two
+*/
+__kernel void embeddedErrorNorm(
 	__global real* result,
-	const __global real* a,
-	const __global real* b)
+	const __global real_storage* a,
+	const __global real_storage* b,
+	__local real* scratch,
+	int length,
+	real absTol,
+	real relTol,
+	int count,
+	const __global real_storage* k0,
+	real c0,
+	const __global real_storage* k1,
+	real c1,
+	const __global real_storage* k2,
+	real c2,
+	const __global real_storage* k3,
+	real c3,
+	const __global real_storage* k4,
+	real c4,
+	const __global real_storage* k5,
+	real c5,
+	const __global real_storage* k6,
+	real c6,
+	const __global real_storage* k7,
+	real c7)
+{
+	int i = get_global_id(0);
+	real error = 0.;
+	if (i < length) {
+		real sum = k0[i] * c0;
+		if (count > 1) sum += k1[i] * c1;
+		if (count > 2) sum += k2[i] * c2;
+		if (count > 3) sum += k3[i] * c3;
+		if (count > 4) sum += k4[i] * c4;
+		if (count > 5) sum += k5[i] * c5;
+		if (count > 6) sum += k6[i] * c6;
+		if (count > 7) sum += k7[i] * c7;
+		error = fabs(sum) / (absTol + relTol * fmax(fabs((real)a[i]), fabs((real)b[i])));
+		if (isnan(error)) error = INFINITY;
+	}
+
+	int local_index = get_local_id(0);
+	scratch[local_index] = error;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (int offset = get_local_size(0) / 2; offset > 0; offset = offset / 2) {
+		if (local_index < offset) {
+			scratch[local_index] = fmax(scratch[local_index], scratch[local_index + offset]);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	if (local_index == 0) {
+		result[get_group_id(0)] = scratch[0];
+	}
+}
+
+//LowStorageRungeKutta
+//result[i] *= c for i < length
+__kernel void scale(
+	__global real_storage* result,
+	real c,
+	int length)
 {
 	size_t i = get_global_id(0);
-	if (i >= get_global_size(0)) return;	
-	result[i] = a[i] - b[i];
+	if (i >= length) return;
+	result[i] = result[i] * c;
 }
 
-//BackwardEulerConjugateGradient
+//BackwardEulerNewtonKrylov
 //http://developer.amd.com/resources/documentation-articles/articles-whitepapers/opencl-optimization-case-study-simple-reductions/
-//result[0] = a[i] * b[i]
+//per-work-group partial sums of a[i] * b[i], for reduceScalar
 __kernel void dotBuffer(
 	__global real* result,
-	const __global real* a,
-	const __global real* b,
+	const __global real_storage* a,
+	const __global real_storage* b,
 	__local real* scratch,
 	__const int length)
 {
@@ -238,7 +416,7 @@ __kernel void dotBuffer(
 	while (i < length) {
 		real a_i = a[i];
 		real b_i = b[i];
-		accumulator = a_i * b_i;
+		accumulator += a_i * b_i;
 		i += get_global_size(0);
 	}
 
@@ -258,3 +436,185 @@ __kernel void dotBuffer(
 		result[get_group_id(0)] = scratch[0];
 	}
 }
+
+/*
+BackwardEulerNewtonKrylov
+one work group sums the 'count' partials into scalars[slot]
+if prevSlot is >= 0 then the old scalars[slot] goes there first
+*/
+__kernel void reduceScalar(
+	__global real* scalars,
+	int slot,
+	int prevSlot,
+	const __global real* partials,
+	int count,
+	__local real* scratch)
+{
+	int local_index = get_local_id(0);
+	real accumulator = 0.;
+	for (int i = local_index; i < count; i += get_local_size(0)) {
+		accumulator += partials[i];
+	}
+	scratch[local_index] = accumulator;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (int offset = get_local_size(0) / 2; offset > 0; offset = offset / 2) {
+		if (local_index < offset) {
+			scratch[local_index] += scratch[local_index + offset];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	if (local_index == 0) {
+		if (prevSlot >= 0) scalars[prevSlot] = scalars[slot];
+		scalars[slot] = scratch[0];
+	}
+}
+
+/*
+BackwardEulerNewtonKrylov, BiCGStab with x_0 = 0 on J x = r, where r = -F(u) = u^n - u + dt L(u)
+this starts r, rHat = r, and p = v = x = 0, and the first item sets rho = alpha = omega = 1
+*/
+__kernel void krylovInit(
+	__global real* scalars,
+	__global real_storage* r,
+	__global real_storage* rHat,
+	__global real_storage* p,
+	__global real_storage* v,
+	__global real_storage* x,
+	const __global real_storage* oldState,
+	const __global real_storage* u,
+	const __global real_storage* derivU,
+	real dt,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i == 0) {
+		scalars[KRYLOV_RHO] = 1.;
+		scalars[KRYLOV_ALPHA] = 1.;
+		scalars[KRYLOV_OMEGA] = 1.;
+	}
+	if (i >= length) return;
+	real ri = oldState[i] - u[i] + dt * derivU[i];
+	r[i] = ri;
+	rHat[i] = ri;
+	p[i] = 0.;
+	v[i] = 0.;
+	x[i] = 0.;
+}
+
+//p = r + beta (p - omega v), beta = (rho / rhoPrev) (alpha / omega)
+__kernel void krylovUpdateP(
+	__global real_storage* p,
+	const __global real_storage* r,
+	const __global real_storage* v,
+	const __global real* scalars,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	real denom = scalars[KRYLOV_RHO_PREV] * scalars[KRYLOV_OMEGA];
+	real beta = denom != 0. ? scalars[KRYLOV_RHO] * scalars[KRYLOV_ALPHA] / denom : 0.;
+	p[i] = r[i] + beta * (p[i] - scalars[KRYLOV_OMEGA] * v[i]);
+}
+
+//single work item: alpha = rho / (rHat . v) or omega = (t . s) / (t . t), zero if they break down
+__kernel void krylovAlpha(__global real* scalars) {
+	real denom = scalars[KRYLOV_RHAT_V];
+	scalars[KRYLOV_ALPHA] = denom != 0. ? scalars[KRYLOV_RHO] / denom : 0.;
+}
+
+__kernel void krylovOmega(__global real* scalars) {
+	real denom = scalars[KRYLOV_T_T];
+	scalars[KRYLOV_OMEGA] = denom != 0. ? scalars[KRYLOV_T_S] / denom : 0.;
+}
+
+//s = r - alpha v, in place of r
+__kernel void krylovUpdateS(
+	__global real_storage* r,
+	const __global real_storage* v,
+	const __global real* scalars,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	r[i] = r[i] - scalars[KRYLOV_ALPHA] * v[i];
+}
+
+//x += alpha p + omega s, r = s - omega t, with s in r
+__kernel void krylovUpdateXR(
+	__global real_storage* x,
+	__global real_storage* r,
+	const __global real_storage* p,
+	const __global real_storage* t,
+	const __global real* scalars,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	real alpha = scalars[KRYLOV_ALPHA];
+	real omega = scalars[KRYLOV_OMEGA];
+	real s = r[i];
+	x[i] = x[i] + alpha * p[i] + omega * s;
+	r[i] = s - omega * t[i];
+}
+
+/*
+the finite difference Jacobian-vector product: J v = v - dt (L(u + eps v) - L(u)) / eps
+with eps = sqrt(machine epsilon) (1 + |u|) / |v|
+krylovPerturb puts u + eps v in the state for the solver's callback to find L of, and krylovJacobianVector does the rest
+*/
+real krylovEpsilon(const __global real* scalars);
+real krylovEpsilon(const __global real* scalars) {
+	real vNorm = sqrt(scalars[KRYLOV_V_V]);
+	return SQRT_MACHINE_EPSILON * (1. + sqrt(scalars[KRYLOV_U_U])) / (vNorm > 0. ? vNorm : 1.);
+}
+
+__kernel void krylovPerturb(
+	__global real_storage* state,
+	const __global real_storage* u,
+	const __global real_storage* v,
+	const __global real* scalars,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	state[i] = u[i] + krylovEpsilon(scalars) * v[i];
+}
+
+__kernel void krylovJacobianVector(
+	__global real_storage* result,
+	const __global real_storage* v,
+	const __global real_storage* derivPerturbed,
+	const __global real_storage* derivU,
+	const __global real* scalars,
+	real dt,
+	int length)
+{
+	int i = get_global_id(0);
+	if (i >= length) return;
+	result[i] = v[i] - dt * (derivPerturbed[i] - derivU[i]) / krylovEpsilon(scalars);
+}
+
+#ifdef SOLID
+/*
+solid flags, one char per cell (SelfGravitation::solidBuffer)
+or with FLUID_DISPATCH one bit per cell, 32 to a uint (SelfGravitation::solidBitsBuffer)
+*/
+#ifdef FLUID_DISPATCH
+typedef uint solid_t;
+#define isSolid(solidBuffer, index)	((char)(((solidBuffer)[(index) >> 5] >> ((index) & 31)) & 1))
+#else	//FLUID_DISPATCH
+typedef char solid_t;
+#define isSolid(solidBuffer, index)	((solidBuffer)[index])
+#endif	//FLUID_DISPATCH
+
+#ifdef FLUID_DISPATCH
+/*
+cell of this work item, for 1D launches over one of SelfGravitation's fluid lists
+the lists are padded with the last (ghost) cell, which every kernel's bounds check skips
+*/
+int4 fluidListCell(const __global int* fluidList) {
+	int index = fluidList[get_global_id(0)];
+	return (int4)(index % SIZE_X, (index / SIZE_X) % SIZE_Y, index / (SIZE_X * SIZE_Y), 0);
+}
+#endif	//FLUID_DISPATCH
+#endif	//SOLID
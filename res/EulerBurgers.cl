@@ -19,28 +19,33 @@ the 1st and 3rd terms are integrated via the pressure integration
 __kernel void calcCellTimestep(
 	__global real* dtBuffer,
 	const __global real* stateBuffer,
-	const __global real* potentialBuffer
+	const __global real* potentialBuffer,
+	__constant Defs* defs
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
 	)
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+#endif	//FLUID_DISPATCH
 	int index = INDEXV(i);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
-	) {
-		dtBuffer[index] = INFINITY;
-		return;
-	}
+	) return;
 
 #ifdef SOLID
-	if (solidBuffer[index]) {
+	if (isSolid(solidBuffer, index)) {
 		dtBuffer[index] = INFINITY;
 		return;
 	}
@@ -81,25 +86,37 @@ void calcInterfaceVelocitySide(
 	__global real* interfaceVelocityBuffer,
 	const __global real* stateBuffer,
 #ifdef SOLID
-	const __global char* solidBuffer,
+	const __global solid_t* solidBuffer,
 #endif
-	int side);
+	int side
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+	);
 
 void calcInterfaceVelocitySide(
 	__global real* interfaceVelocityBuffer,
 	const __global real* stateBuffer,
 #ifdef SOLID
-	const __global char* solidBuffer,
+	const __global solid_t* solidBuffer,
 #endif
-	int side)
+	int side
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+	)
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+#endif	//FLUID_DISPATCH
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -117,8 +134,8 @@ void calcInterfaceVelocitySide(
 	real velocityR = stateBuffer[side+STATE_MOMENTUM_X + NUM_STATES * indexR] / densityR;
 
 #ifdef SOLID
-	char solidL = solidBuffer[indexL];
-	char solidR = solidBuffer[indexR];
+	char solidL = isSolid(solidBuffer, indexL);
+	char solidR = isSolid(solidBuffer, indexR);
 	if (solidL && !solidR) {
 		velocityL = -velocityR;
 	} else if (solidR && !solidL) {
@@ -133,8 +150,11 @@ __kernel void calcInterfaceVelocity(
 	__global real* interfaceVelocityBuffer,
 	const __global real* stateBuffer
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
 )
 {
 	for (int side = 0; side < DIM; ++side) {
@@ -142,7 +162,11 @@ __kernel void calcInterfaceVelocity(
 #ifdef SOLID
 			solidBuffer,
 #endif
-			side);
+			side
+#ifdef FLUID_DISPATCH
+			, fluidList
+#endif
+			);
 	}
 }
 
@@ -151,28 +175,42 @@ void calcFluxSide(
 	const __global real* stateBuffer,
 	const __global real* interfaceVelocityBuffer,
 #ifdef SOLID
-	const __global char* solidBuffer,	
+	const __global solid_t* solidBuffer,	
 #endif
 	real dt,
-	int side);
+	int limiter,
+	int side
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+	);
 
 void calcFluxSide(
 	__global real* fluxBuffer,
 	const __global real* stateBuffer,
 	const __global real* interfaceVelocityBuffer,
 #ifdef SOLID
-	const __global char* solidBuffer,	
+	const __global solid_t* solidBuffer,	
 #endif
 	real dt,
-	int side)
+	int limiter,
+	int side
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+	)
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+#endif	//FLUID_DISPATCH
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -188,10 +226,10 @@ void calcFluxSide(
 	int indexR2 = index + stepsize[side];
 
 #ifdef SOLID
-	char solidL2 = solidBuffer[indexL2];
-	char solidL = solidBuffer[indexL];
-	char solidR = solidBuffer[indexR];
-	char solidR2 = solidBuffer[indexR2];
+	char solidL2 = isSolid(solidBuffer, indexL2);
+	char solidL = isSolid(solidBuffer, indexL);
+	char solidR = isSolid(solidBuffer, indexR);
+	char solidR2 = isSolid(solidBuffer, indexR2);
 #endif
 
 	int interfaceIndex = side + DIM * index;
@@ -257,7 +295,7 @@ void calcFluxSide(
 			stateSlopeRatio = deltaStateR / deltaState;
 		}
 		//2nd order stuff:
-		real phi = slopeLimiter(stateSlopeRatio);
+		real phi = slopeLimiter(stateSlopeRatio, limiter);
 		
 		flux[j] = .5 * interfaceVelocity * ((1. + theta) * stateL + (1. - theta) * stateR)
 				+ .5 * deltaState * phi * fabs(interfaceVelocity) * (1. - fabs(interfaceVelocity * dt_dx[side]));
@@ -269,25 +307,35 @@ __kernel void calcFlux(
 	const __global real* stateBuffer,
 	const __global real* interfaceVelocityBuffer,
 #ifdef SOLID
-	const __global char* solidBuffer,	
+	const __global solid_t* solidBuffer,	
 #endif
-	real dt)
+	real dt,
+	int limiter
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+	)
 {
 	for (int side = 0; side < DIM; ++side) {
 		calcFluxSide(fluxBuffer, stateBuffer, interfaceVelocityBuffer
 #ifdef SOLID
 			, solidBuffer
 #endif
-			, dt, side);
+			, dt, limiter, side
+#ifdef FLUID_DISPATCH
+			, fluidList
+#endif
+			);
 	}
 }
 
 __kernel void computePressure(
 	__global real* pressureBuffer,
 	const __global real* stateBuffer,
-	const __global real* potentialBuffer
+	const __global real* potentialBuffer,
+	__constant Defs* defs
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif
 	)
 {
@@ -305,7 +353,7 @@ __kernel void computePressure(
 	int index = INDEXV(i);
 
 #ifdef SOLID
-	if (solidBuffer[index]) return;
+	if (isSolid(solidBuffer, index)) return;
 #endif
 
 	const __global real* state = stateBuffer + NUM_STATES * index;
@@ -357,38 +405,45 @@ __kernel void diffuseMomentum(
 	__global real* derivBuffer,
 	const __global real* pressureBuffer
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
 	)
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+#endif	//FLUID_DISPATCH
 	
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
 	}
 	
 	int index = INDEXV(i);
+	__global real* deriv = derivBuffer + NUM_STATES * index;
+	clearSplitDeriv(deriv);
 
 #ifdef SOLID
-	if (solidBuffer[index]) return;
+	if (isSolid(solidBuffer, index)) return;
 #endif
-	
-	__global real* deriv = derivBuffer + NUM_STATES * index;
 
 	real pressureL, pressureR;
 
 	pressureL = pressureBuffer[index - STEP_X];
 	pressureR = pressureBuffer[index + STEP_X];
 #ifdef SOLID
-	if (solidBuffer[index - STEP_X]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index + STEP_X]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index - STEP_X)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index + STEP_X)) pressureR = pressureBuffer[index];
 #endif
 	deriv[STATE_MOMENTUM_X] -= .5 * (pressureR - pressureL) / DX;
 
@@ -396,8 +451,8 @@ __kernel void diffuseMomentum(
 	pressureL = pressureBuffer[index - STEP_Y];
 	pressureR = pressureBuffer[index + STEP_Y];
 #ifdef SOLID
-	if (solidBuffer[index - STEP_Y]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index + STEP_Y]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index - STEP_Y)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index + STEP_Y)) pressureR = pressureBuffer[index];
 #endif
 	deriv[STATE_MOMENTUM_Y] -= .5 * (pressureR - pressureL) / DY;
 #endif
@@ -406,8 +461,8 @@ __kernel void diffuseMomentum(
 	pressureL = pressureBuffer[index - STEP_Z];
 	pressureR = pressureBuffer[index + STEP_Z];
 #ifdef SOLID
-	if (solidBuffer[index - STEP_Z]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index + STEP_Z]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index - STEP_Z)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index + STEP_Z)) pressureR = pressureBuffer[index];
 #endif
 	deriv[STATE_MOMENTUM_Z] -= .5 * (pressureR - pressureL) / DZ;
 #endif
@@ -418,29 +473,37 @@ __kernel void diffuseWork(
 	const __global real* stateBuffer,
 	const __global real* pressureBuffer
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
 	)
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+#endif	//FLUID_DISPATCH
 	
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
 	}
 	
 	int index = INDEXV(i);
+	__global real* deriv = derivBuffer + NUM_STATES * index;
+	clearSplitDeriv(deriv);
 
 #ifdef SOLID
-	if (solidBuffer[index]) return;
+	if (isSolid(solidBuffer, index)) return;
 #endif
-	__global real* deriv = derivBuffer + NUM_STATES * index;
 
 	real velocityL, velocityR, pressureL, pressureR;
 	real deltaEnergyTotal = 0.;
@@ -450,10 +513,10 @@ __kernel void diffuseWork(
 	pressureL = pressureBuffer[index-STEP_X];
 	pressureR = pressureBuffer[index+STEP_X];
 #ifdef SOLID
-	if (solidBuffer[index-STEP_X]) velocityL = -velocityL;
-	if (solidBuffer[index+STEP_X]) velocityR = -velocityR;
-	if (solidBuffer[index-STEP_X]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index+STEP_X]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index-STEP_X)) velocityL = -velocityL;
+	if (isSolid(solidBuffer, index+STEP_X)) velocityR = -velocityR;
+	if (isSolid(solidBuffer, index-STEP_X)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index+STEP_X)) pressureR = pressureBuffer[index];
 #endif
 	deltaEnergyTotal -= .5 * (pressureR * velocityR - pressureL * velocityL) / DX;
 
@@ -463,10 +526,10 @@ __kernel void diffuseWork(
 	pressureL = pressureBuffer[index-STEP_Y];
 	pressureR = pressureBuffer[index+STEP_Y];
 #ifdef SOLID
-	if (solidBuffer[index-STEP_Y]) velocityL = -velocityL;
-	if (solidBuffer[index+STEP_Y]) velocityR = -velocityR;
-	if (solidBuffer[index-STEP_Y]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index+STEP_Y]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index-STEP_Y)) velocityL = -velocityL;
+	if (isSolid(solidBuffer, index+STEP_Y)) velocityR = -velocityR;
+	if (isSolid(solidBuffer, index-STEP_Y)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index+STEP_Y)) pressureR = pressureBuffer[index];
 #endif
 	deltaEnergyTotal -= .5 * (pressureR * velocityR - pressureL * velocityL) / DY;
 #endif
@@ -477,10 +540,10 @@ __kernel void diffuseWork(
 	pressureL = pressureBuffer[index-STEP_Z];
 	pressureR = pressureBuffer[index+STEP_Z];
 #ifdef SOLID
-	if (solidBuffer[index-STEP_Z]) velocityL = -velocityL;
-	if (solidBuffer[index+STEP_Z]) velocityR = -velocityR;
-	if (solidBuffer[index-STEP_Z]) pressureL = pressureBuffer[index];
-	if (solidBuffer[index+STEP_Z]) pressureR = pressureBuffer[index];
+	if (isSolid(solidBuffer, index-STEP_Z)) velocityL = -velocityL;
+	if (isSolid(solidBuffer, index+STEP_Z)) velocityR = -velocityR;
+	if (isSolid(solidBuffer, index-STEP_Z)) pressureL = pressureBuffer[index];
+	if (isSolid(solidBuffer, index+STEP_Z)) pressureR = pressureBuffer[index];
 #endif
 	deltaEnergyTotal -= .5 * (pressureR * velocityR - pressureL * velocityL) / DZ;
 #endif
@@ -6,25 +6,39 @@
 
 #define gamma idealGas_heatCapacityRatio	//laziness
 
+#ifdef PRIMITIVE_BUFFER
+#include "EulerPrimitives.cl"
+#endif	//PRIMITIVE_BUFFER
+
 void calcEigenvaluesSide(
 	__global real* eigenvaluesBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer,
-	int side);
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs,
+	int side
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	);
 
 void calcEigenvaluesSide(
 	__global real* eigenvaluesBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer,
-	int side)
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs,
+	int side
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
 	int index = INDEXV(i);
 	int indexPrev = index - stepsize[side];
 	int interfaceIndex = side + DIM * index;
 
-	const __global real* srcStateL = stateBuffer + NUM_STATES * indexPrev;
-	const __global real* srcStateR = stateBuffer + NUM_STATES * index;
+	const __global real_storage* srcStateL = stateBuffer + NUM_STATES * indexPrev;
+	const __global real_storage* srcStateR = stateBuffer + NUM_STATES * index;
 
 	real stateL[NUM_STATES];
 	real stateR[NUM_STATES];
@@ -49,8 +63,28 @@ void calcEigenvaluesSide(
 	__global real* eigenvalues = eigenvaluesBuffer + NUM_STATES * interfaceIndex;
 
 	//the left and right primitives are recalculated in calcEigenvalues and in calcFlux
-	//if they could be stored somewhere, that might speed things up, but would take up a bit more memory
+	//unless usePrimitiveBuffer is set, in which case calcPrimitives stores them once per cell
+
+#ifdef PRIMITIVE_BUFFER
+	const __global real* primitiveL = primitiveBuffer + NUM_PRIMITIVES * indexPrev;
+	const __global real* primitiveR = primitiveBuffer + NUM_PRIMITIVES * index;
 
+	real densityL = primitiveL[PRIMITIVE_DENSITY];
+	real4 velocityL = primitiveVelocityAlongSide(primitiveL, side);
+	real energyPotentialL = potentialBuffer[indexPrev];
+	real pressureL = primitiveL[PRIMITIVE_PRESSURE];
+	real enthalpyTotalL = primitiveL[PRIMITIVE_ENTHALPY_TOTAL];
+	real speedOfSoundL = primitiveL[PRIMITIVE_SPEED_OF_SOUND];
+	real roeWeightL = primitiveL[PRIMITIVE_ROE_WEIGHT];
+
+	real densityR = primitiveR[PRIMITIVE_DENSITY];
+	real4 velocityR = primitiveVelocityAlongSide(primitiveR, side);
+	real energyPotentialR = potentialBuffer[index];
+	real pressureR = primitiveR[PRIMITIVE_PRESSURE];
+	real enthalpyTotalR = primitiveR[PRIMITIVE_ENTHALPY_TOTAL];
+	real speedOfSoundR = primitiveR[PRIMITIVE_SPEED_OF_SOUND];
+	real roeWeightR = primitiveR[PRIMITIVE_ROE_WEIGHT];
+#else	//PRIMITIVE_BUFFER
 	real densityL = stateL[STATE_DENSITY];
 	real invDensityL = 1. / densityL;
 	real4 velocityL = VELOCITY(stateL);
@@ -76,6 +110,7 @@ void calcEigenvaluesSide(
 	real enthalpyTotalR = energyTotalR + pressureR * invDensityR;
 	real speedOfSoundR = sqrt((gamma - 1.) * (enthalpyTotalR - .5f * velocitySqR));
 	real roeWeightR = sqrt(densityR);
+#endif	//PRIMITIVE_BUFFER
 	
 	real roeWeightNormalization = 1. / (roeWeightL + roeWeightR);
 	real4 velocity = (roeWeightL * velocityL + roeWeightR * velocityR) * roeWeightNormalization;
@@ -84,7 +119,7 @@ void calcEigenvaluesSide(
 
 	//acoustic-type approximation: Toro, 1991
 	//seems sharper than the two-rarefaction Riemann solver...
-	real pressureStar = max(0., .5f * (pressureL + pressureR) - .5f * (velocityR.x - velocityL.x) * .5f * (densityL + densityR) * .5f * (speedOfSoundL + speedOfSoundR));
+	real pressureStar = max((real)0., .5f * (pressureL + pressureR) - .5f * (velocityR.x - velocityL.x) * .5f * (densityL + densityR) * .5f * (speedOfSoundL + speedOfSoundR));
 
 	//Two-Rarefaction Riemann solver:
 	//real z = .5f - .5f / gamma;
@@ -109,24 +144,41 @@ void calcEigenvaluesSide(
 
 __kernel void calcEigenvalues(
 	__global real* eigenvaluesBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer)
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1
+	if (i.x >= SIZE_X - 1
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
-	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, 0);
+	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, defs, 0
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #if DIM > 1
-	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, 1);
+	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, defs, 1
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #endif
 #if DIM > 2
-	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, 2);
+	calcEigenvaluesSide(eigenvaluesBuffer, stateBuffer, potentialBuffer, defs, 2
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #endif
 }
 
@@ -138,17 +190,14 @@ __kernel void calcCellTimestep(
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
 	int index = INDEXV(i);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
-	) {
-		dtBuffer[index] = INFINITY;
-		return;
-	}
+	) return;
 
 	real result = INFINITY;
 	for (int side = 0; side < DIM; ++side) {
@@ -157,8 +206,8 @@ __kernel void calcCellTimestep(
 		const __global real* eigenvaluesL = eigenvaluesBuffer + NUM_STATES * (side + DIM * index);
 		const __global real* eigenvaluesR = eigenvaluesBuffer + NUM_STATES * (side + DIM * indexNext);
 
-		real minLambda = min(0., eigenvaluesR[0]);
-		real maxLambda = max(0., eigenvaluesL[EULER_DIM+1]);
+		real minLambda = min((real)0., eigenvaluesR[0]);
+		real maxLambda = max((real)0., eigenvaluesL[EULER_DIM+1]);
 
 		real dum = dx[side] / (maxLambda - minLambda);
 		result = min(result, dum);
@@ -168,28 +217,38 @@ __kernel void calcCellTimestep(
 }
 
 void calcFluxSide(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
-	const __global real* potentialBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs,
 	real dt_dx,
-	int side);
+	int side
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	);
 
 void calcFluxSide(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
-	const __global real* potentialBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs,
 	real dt_dx,
-	int side)
+	int side
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
 	int index = INDEXV(i);
 	int indexPrev = index - stepsize[side];
 	int interfaceIndex = side + DIM * index;
 
-	const __global real* srcStateL = stateBuffer + NUM_STATES * indexPrev;
-	const __global real* srcStateR = stateBuffer + NUM_STATES * index;
+	const __global real_storage* srcStateL = stateBuffer + NUM_STATES * indexPrev;
+	const __global real_storage* srcStateR = stateBuffer + NUM_STATES * index;
 
 	real stateL[NUM_STATES];
 	real stateR[NUM_STATES];
@@ -213,8 +272,26 @@ void calcFluxSide(
 	
 	const __global real* eigenvalues = eigenvaluesBuffer + NUM_STATES * interfaceIndex;
 
-	__global real* flux = fluxBuffer + NUM_FLUX_STATES * interfaceIndex;
+	__global real_storage* flux = fluxBuffer + NUM_FLUX_STATES * interfaceIndex;
+
+#ifdef PRIMITIVE_BUFFER
+	const __global real* primitiveL = primitiveBuffer + NUM_PRIMITIVES * indexPrev;
+	const __global real* primitiveR = primitiveBuffer + NUM_PRIMITIVES * index;
+
+	real densityL = primitiveL[PRIMITIVE_DENSITY];
+	real4 velocityL = primitiveVelocityAlongSide(primitiveL, side);
+	real energyPotentialL = potentialBuffer[indexPrev];
+	real pressureL = primitiveL[PRIMITIVE_PRESSURE];
+	real enthalpyTotalL = primitiveL[PRIMITIVE_ENTHALPY_TOTAL];
+	real energyTotalL = enthalpyTotalL - pressureL / densityL;
 
+	real densityR = primitiveR[PRIMITIVE_DENSITY];
+	real4 velocityR = primitiveVelocityAlongSide(primitiveR, side);
+	real energyPotentialR = potentialBuffer[index];
+	real pressureR = primitiveR[PRIMITIVE_PRESSURE];
+	real enthalpyTotalR = primitiveR[PRIMITIVE_ENTHALPY_TOTAL];
+	real energyTotalR = enthalpyTotalR - pressureR / densityR;
+#else	//PRIMITIVE_BUFFER
 	real densityL = stateL[STATE_DENSITY];
 	real invDensityL = 1. / densityL;
 	real4 velocityL = VELOCITY(stateL);
@@ -236,6 +313,7 @@ void calcFluxSide(
 	real energyInternalR = energyTotalR - energyKineticR - energyPotentialR;
 	real pressureR = (gamma - 1.) * densityR * energyInternalR;
 	real enthalpyTotalR = energyTotalR + pressureR * invDensityR;
+#endif	//PRIMITIVE_BUFFER
 
 	
 	//flux
@@ -419,27 +497,44 @@ or can we use delta q- and delta q+ for the lhs and rhs of the delta q slope, ch
 }
 
 __kernel void calcFlux(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
-	const __global real* potentialBuffer,
-	real dt)
+	const __global real_storage* potentialBuffer,
+	real dt,
+	__constant Defs* defs
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1
+	if (i.x >= SIZE_X - 1
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	
-	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, dt/DX, 0);
+	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, defs, dt/DX, 0
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #if DIM > 1
-	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, dt/DY, 1);
+	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, defs, dt/DY, 1
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #endif
 #if DIM > 2
-	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, dt/DZ, 2);
+	calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, potentialBuffer, defs, dt/DZ, 2
+#ifdef PRIMITIVE_BUFFER
+		, primitiveBuffer
+#endif
+	);
 #endif
 }
@@ -10,9 +10,10 @@ __kernel void convertToTex(
 	global float4* destTex,
 #endif
 	int displayMethod,
-	const __global real* stateBuffer,
-	const __global real* gravityPotentialBuffer,
-	const __global char* solidBuffer
+	const __global real_storage* stateBuffer,
+	const __global real_storage* gravityPotentialBuffer,
+	const __global char* solidBuffer,
+	__constant Defs* defs
 #ifdef MHD
 	, const __global real* magneticFieldDivergenceBuffer
 #endif
@@ -30,7 +31,7 @@ __kernel void convertToTex(
 
 	int index = INDEXV(i);
 
-	const __global real* state = stateBuffer + NUM_STATES * index;
+	const __global real_storage* state = stateBuffer + NUM_STATES * index;
 
 	real density = state[STATE_DENSITY];
 #ifdef MHD
@@ -129,11 +130,14 @@ __kernel void updateVectorField(
 	__global float* vectorFieldVertexBuffer,
 	float scale,
 	int displayMethod,
-	const __global real* stateBuffer,
-	const __global real* gravityPotentialBuffer)
+	const __global real_storage* stateBuffer,
+	const __global real_storage* gravityPotentialBuffer,
+	int resolution)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	int4 size = (int4)(get_global_size(0), get_global_size(1), get_global_size(2), 0);	
+	//launched padded to the local size, so the field size is passed in
+	int4 size = (int4)(resolution, DIM > 1 ? resolution : 1, DIM > 2 ? resolution : 1, 0);
+	if (i.x >= size.x || i.y >= size.y || i.z >= size.z) return;
 	int vertexIndex = i.x + size.x * (i.y + size.y * i.z);
 	__global float* vertex = vectorFieldVertexBuffer + 6 * 3 * vertexIndex;
 	
@@ -149,7 +153,7 @@ __kernel void updateVectorField(
 	//float4 fp = (float4)(sf.x - (float)si.x, sf.y - (float)si.y, sf.z - (float)si.z, 0.);
 	
 	int stateIndex = INDEXV(si);
-	const __global real* state = stateBuffer + NUM_STATES * stateIndex;
+	const __global real_storage* state = stateBuffer + NUM_STATES * stateIndex;
 
 	real4 field = (real4)(0., 0., 0., 0.);
 	switch (displayMethod) {
@@ -188,17 +192,17 @@ __kernel void updateVectorField(
 	case VECTORFIELD_VORTICITY:
 		{
 			int4 ixL = si; ixL.x = (ixL.x + SIZE_X - 1) % SIZE_X;
-			const __global real* stateXL = stateBuffer + NUM_STATES * INDEXV(ixL);
+			const __global real_storage* stateXL = stateBuffer + NUM_STATES * INDEXV(ixL);
 			int4 ixR = si; ixR.x = (ixR.x + 1) % SIZE_X;
-			const __global real* stateXR = stateBuffer + NUM_STATES * INDEXV(ixR);
+			const __global real_storage* stateXR = stateBuffer + NUM_STATES * INDEXV(ixR);
 			int4 iyL = si; iyL.y = (iyL.y + SIZE_Y - 1) % SIZE_Y;
-			const __global real* stateYL = stateBuffer + NUM_STATES * INDEXV(iyL);
+			const __global real_storage* stateYL = stateBuffer + NUM_STATES * INDEXV(iyL);
 			int4 iyR = si; iyR.y = (iyR.y + 1) % SIZE_Y;
-			const __global real* stateYR = stateBuffer + NUM_STATES * INDEXV(iyR);
+			const __global real_storage* stateYR = stateBuffer + NUM_STATES * INDEXV(iyR);
 			int4 izL = si; izL.z = (izL.z + SIZE_Z - 1) % SIZE_Z;
-			const __global real* stateZL = stateBuffer + NUM_STATES * INDEXV(izL);
+			const __global real_storage* stateZL = stateBuffer + NUM_STATES * INDEXV(izL);
 			int4 izR = si; izR.z = (izR.z + 1) % SIZE_Z;
-			const __global real* stateZR = stateBuffer + NUM_STATES * INDEXV(izR);
+			const __global real_storage* stateZR = stateBuffer + NUM_STATES * INDEXV(izR);
 			
 			// d/dy velocity.z - d/dz velocity.y
 			field.x = (stateYR[STATE_MOMENTUM_Z] / stateYR[STATE_DENSITY] - stateYL[STATE_MOMENTUM_Z] / stateYL[STATE_DENSITY]) / (2. * DX)
@@ -0,0 +1,72 @@
+/*
+optional per-cell primitive cache for the Euler solvers
+calcPrimitives fills it once per stage
+so the eigenvalue / eigenbasis / flux kernels don't rederive them for both sides of every interface
+*/
+
+#include "HydroGPU/Shared/Common.h"
+
+#define PRIMITIVE_DENSITY 0
+#define PRIMITIVE_VELOCITY_X 1
+#define PRIMITIVE_VELOCITY_Y 2
+#define PRIMITIVE_VELOCITY_Z 3
+#define PRIMITIVE_PRESSURE 4
+#define PRIMITIVE_ENTHALPY_TOTAL 5
+#define PRIMITIVE_SPEED_OF_SOUND 6
+#define PRIMITIVE_ROE_WEIGHT 7
+#define NUM_PRIMITIVES 8
+
+#define PRIMITIVE_VELOCITY(ptr)	((real4)((ptr)[PRIMITIVE_VELOCITY_X], (ptr)[PRIMITIVE_VELOCITY_Y], (ptr)[PRIMITIVE_VELOCITY_Z], 0.))
+
+//velocity rotated so that 'side' lies along x, to match the rotated states of the HLL/HLLC kernels
+real4 primitiveVelocityAlongSide(const __global real* primitive, int side);
+
+real4 primitiveVelocityAlongSide(const __global real* primitive, int side) {
+	real4 velocity = PRIMITIVE_VELOCITY(primitive);
+	real tmp = velocity[0];
+	velocity[0] = velocity[side];
+	velocity[side] = tmp;
+	return velocity;
+}
+
+//ghost cells included, so run this after the boundary
+__kernel void calcPrimitives(
+	__global real* primitiveBuffer,
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	__constant Defs* defs)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X
+#if DIM > 1
+		|| i.y >= SIZE_Y
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z
+#endif
+	) return;
+	int index = INDEXV(i);
+
+	const __global real_storage* state = stateBuffer + NUM_STATES * index;
+	__global real* primitive = primitiveBuffer + NUM_PRIMITIVES * index;
+
+	real density = state[STATE_DENSITY];
+	real invDensity = 1. / density;
+	real4 velocity = VELOCITY(state);
+	real velocitySq = dot(velocity, velocity);
+	real energyTotal = state[STATE_ENERGY_TOTAL] * invDensity;
+	real energyKinetic = .5 * velocitySq;
+	real energyPotential = potentialBuffer[index];
+	real energyInternal = energyTotal - energyKinetic - energyPotential;
+	real pressure = (idealGas_heatCapacityRatio - 1.) * density * energyInternal;
+	real enthalpyTotal = energyTotal + pressure * invDensity;
+
+	primitive[PRIMITIVE_DENSITY] = density;
+	primitive[PRIMITIVE_VELOCITY_X] = velocity.x;
+	primitive[PRIMITIVE_VELOCITY_Y] = velocity.y;
+	primitive[PRIMITIVE_VELOCITY_Z] = velocity.z;
+	primitive[PRIMITIVE_PRESSURE] = pressure;
+	primitive[PRIMITIVE_ENTHALPY_TOTAL] = enthalpyTotal;
+	primitive[PRIMITIVE_SPEED_OF_SOUND] = sqrt((idealGas_heatCapacityRatio - 1.) * (enthalpyTotal - .5 * velocitySq));
+	primitive[PRIMITIVE_ROE_WEIGHT] = sqrt(density);
+}
@@ -7,47 +7,129 @@ paritcularly the spectral decomposition
 
 #define gamma idealGas_heatCapacityRatio	//laziness
 
+#ifdef PRIMITIVE_BUFFER
+#include "EulerPrimitives.cl"
+#endif	//PRIMITIVE_BUFFER
+
 void calcEigenBasisSide(
 	__global real* eigenvaluesBuffer,
 	__global real* eigenvectorsBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer,
-	const __global char* solidBuffer,
-	int side);
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	const __global solid_t* solidBuffer,
+	__constant Defs* defs,
+	int side
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	);
 
 void calcEigenBasisSide(
 	__global real* eigenvaluesBuffer,
 	__global real* eigenvectorsBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer,
-	const __global char* solidBuffer,
-	int side)
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	const __global solid_t* solidBuffer,
+	__constant Defs* defs,
+	int side
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+	)
 {
+#if defined(ACTIVE_BLOCKS)
+	int4 i = activeBlockCell(activeBlocks);
+#elif defined(FLUID_DISPATCH)
+	int4 i = fluidListCell(fluidList);
+#else
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+#endif
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 
 	int index = INDEXV(i);
 	int indexPrev = index - stepsize[side];
 
-	const __global real* stateL = stateBuffer + NUM_STATES * indexPrev;
-	const __global real* stateR = stateBuffer + NUM_STATES * index;
+#ifdef BOUNDARY_REMAP
+	real stateL[NUM_STATES];
+	real stateR[NUM_STATES];
+	int4 iPrev = i;
+	--iPrev[side];
+	readStateRemapped(stateL, stateBuffer, iPrev, boundaryMethods);
+	readStateRemapped(stateR, stateBuffer, i, boundaryMethods);
+#else	//BOUNDARY_REMAP
+	const __global real_storage* stateL = stateBuffer + NUM_STATES * indexPrev;
+	const __global real_storage* stateR = stateBuffer + NUM_STATES * index;
+#endif	//BOUNDARY_REMAP
 	
-	int interfaceIndex = side + DIM * index;
+	int interfaceIndex = INTERFACE_INDEX(side, index);
 	
 	__global real* eigenvalues = eigenvaluesBuffer + NUM_STATES * interfaceIndex;
+#ifdef SPARSE_EIGEN_TRANSFORM
+	//build the dense side 0 basis privately, then pack only its distinct entries
+	__global real* eigenTransform = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
+	real eigenvectorsInverse[NUM_STATES * NUM_STATES];
+	real eigenvectors[NUM_STATES * NUM_STATES];
+#else	//SPARSE_EIGEN_TRANSFORM
 	__global real* eigenvectorsInverse = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
 	__global real* eigenvectors = eigenvectorsInverse + NUM_STATES * NUM_STATES;
+#endif	//SPARSE_EIGEN_TRANSFORM
+
+	char solidL = isSolid(solidBuffer, indexPrev);
+	char solidR = isSolid(solidBuffer, index);
+
+#ifdef PRIMITIVE_BUFFER
+	const __global real* primitiveL = primitiveBuffer + NUM_PRIMITIVES * indexPrev;
+	const __global real* primitiveR = primitiveBuffer + NUM_PRIMITIVES * index;
+
+	real4 velocityL = PRIMITIVE_VELOCITY(primitiveL);
+	real enthalpyTotalL = primitiveL[PRIMITIVE_ENTHALPY_TOTAL];
+	real roeWeightL = primitiveL[PRIMITIVE_ROE_WEIGHT];
+	real energyPotentialL = potentialBuffer[indexPrev];
 
-	char solidL = solidBuffer[indexPrev];
-	char solidR = solidBuffer[index];
+	real4 velocityR = PRIMITIVE_VELOCITY(primitiveR);
+	real enthalpyTotalR = primitiveR[PRIMITIVE_ENTHALPY_TOTAL];
+	real roeWeightR = primitiveR[PRIMITIVE_ROE_WEIGHT];
+	real energyPotentialR = potentialBuffer[index];
 
+	//the solid side takes on the mirror of the fluid side, enthalpy included
+	if (solidL && !solidR) {
+		velocityL = velocityR;
+		velocityL[side+1] = -velocityR[side+1];
+		enthalpyTotalL = enthalpyTotalR;
+		roeWeightL = roeWeightR;
+	}
+	if (solidR && !solidL) {
+		velocityR = velocityL;
+		velocityR[side+1] = -velocityL[side+1];
+		enthalpyTotalR = enthalpyTotalL;
+		roeWeightR = roeWeightL;
+	}
+#else	//PRIMITIVE_BUFFER
 	real densityL = stateL[STATE_DENSITY];
 	real4 velocityL = VELOCITY(stateL);
 	real densityR = stateR[STATE_DENSITY];
@@ -81,6 +163,7 @@ void calcEigenBasisSide(
 	real pressureR = (gamma - 1.f) * densityR * energyInternalR;
 	real enthalpyTotalR = energyTotalR + pressureR * invDensityR;
 	real roeWeightR = sqrt(densityR);
+#endif	//PRIMITIVE_BUFFER
 
 	real roeWeightNormalization = 1.f / (roeWeightL + roeWeightR);
 	
@@ -225,7 +308,10 @@ void calcEigenBasisSide(
 #endif
 	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * (EULER_DIM+1)] = (gamma - 1.f) * invDenom;
 
-#if DIM > 1
+#ifdef SPARSE_EIGEN_TRANSFORM
+	//the transforms rotate the momentum themselves
+	packEigenBasis(eigenTransform, eigenvectorsInverse, eigenvectors);
+#elif DIM > 1
 	if (side == 1) {
 		for (int i = 0; i < NUM_STATES; ++i) {
 			real tmp;
@@ -261,11 +347,41 @@ void calcEigenBasisSide(
 __kernel void calcEigenBasis(
 	__global real* eigenvaluesBuffer,
 	__global real* eigenvectorsBuffer,
-	const __global real* stateBuffer,
-	const __global real* potentialBuffer,
-	const __global char* solidBuffer)
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	const __global solid_t* solidBuffer,
+	__constant Defs* defs
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
+#ifdef PRIMITIVE_BUFFER
+	, const __global real* primitiveBuffer
+#endif	//PRIMITIVE_BUFFER
+#ifdef DIMENSIONAL_SPLIT
+	, int splitSide
+#endif	//DIMENSIONAL_SPLIT
+	)
 {
-	for (int side = 0; side < DIM; ++side) {
-		calcEigenBasisSide(eigenvaluesBuffer, eigenvectorsBuffer, stateBuffer, potentialBuffer, solidBuffer, side);
+	for (int side = SIDE_BEGIN; side < SIDE_END; ++side) {
+		calcEigenBasisSide(eigenvaluesBuffer, eigenvectorsBuffer, stateBuffer, potentialBuffer, solidBuffer, defs, side
+#ifdef ACTIVE_BLOCKS
+			, activeBlocks
+#endif
+#ifdef FLUID_DISPATCH
+			, fluidList
+#endif
+#ifdef BOUNDARY_REMAP
+			, boundaryMethods
+#endif
+#ifdef PRIMITIVE_BUFFER
+			, primitiveBuffer
+#endif
+		);
 	}
 }
@@ -0,0 +1,655 @@
+/*
+temporal blocking for the Euler Roe and HLL solvers (see TemporalBlockBehavior.h)
+each work group loads its tile of TEMPORAL_BLOCK_TILE_X x TEMPORAL_BLOCK_TILE_Y interior cells
+plus a halo of TEMPORAL_BLOCK_RADIUS cells per step into local memory,
+takes TEMPORAL_BLOCK_STEPS forward Euler steps there, then writes the tile back.
+every step the valid part of the halo shrinks by TEMPORAL_BLOCK_RADIUS cells, which is what the halo is for.
+
+boundaries are done in local memory:
+periodic sides load the cells past the ends wrapped around, and evolve them along with everything else.
+other sides refill their ghost cells at the start of each step, the same as stateBoundary.
+*/
+
+#include "HydroGPU/Shared/Common.h"
+
+#define gamma idealGas_heatCapacityRatio	//laziness
+
+#define TEMPORAL_BLOCK_HALO	(TEMPORAL_BLOCK_RADIUS * TEMPORAL_BLOCK_STEPS)
+#define TILE_SIZE_X	(TEMPORAL_BLOCK_TILE_X + 2 * TEMPORAL_BLOCK_HALO)
+#if DIM > 1
+#define TILE_SIZE_Y	(TEMPORAL_BLOCK_TILE_Y + 2 * TEMPORAL_BLOCK_HALO)
+#else
+#define TILE_SIZE_Y	1
+#endif
+#define TILE_VOLUME	(TILE_SIZE_X * TILE_SIZE_Y)
+#define TILE_COORD(c)	((int4)((c) % TILE_SIZE_X, (c) / TILE_SIZE_X, 0, 0))
+
+constant int4 tileSize = (int4)(TILE_SIZE_X, TILE_SIZE_Y, 1, 0);
+constant int4 tileStepsize = (int4)(1, TILE_SIZE_X, 0, 0);
+
+int temporalBlockSourceCoord(int k, int n, int periodic);
+int temporalBlockSourceIndex(int4 g, const int* periodic);
+int temporalBlockEvolves(int4 g, const int* periodic);
+int temporalBlockInRange(int4 t, int lo, int side, int loPad, int hiPad);
+void temporalBlockBoundary(__local real* tileState, int4 origin, const int* periodic, __constant int* boundaryMethods, int side);
+void temporalBlockReadState(real* state, const __local real* tileState, int c, int side);
+void temporalBlockInterfaceStates(
+	real* stateL,
+	real* stateR,
+	real* energyPotentialL,
+	real* energyPotentialR,
+	const __local real* tileState,
+	int c,
+	int4 origin,
+	const int* periodic,
+	const __global real_storage* potentialBuffer,
+	const __global char* solidBuffer,
+	int side);
+
+//which cell of the grid the tile cell at global coordinate k (along a side of size n) loads
+int temporalBlockSourceCoord(int k, int n, int periodic) {
+	if (periodic) {
+		if (k >= 2 && k < n - 2) return k;
+		int m = (k - 2) % (n - 4);
+		if (m < 0) m += n - 4;
+		return 2 + m;
+	}
+	//past the end of a non-periodic side only feeds ghost cells, which get refilled anyways
+	return clamp(k, 0, n - 1);
+}
+
+int temporalBlockSourceIndex(int4 g, const int* periodic) {
+	int4 src = (int4)(0, 0, 0, 0);
+	for (int side = 0; side < DIM; ++side) {
+		src[side] = temporalBlockSourceCoord(g[side], size[side], periodic[side]);
+	}
+	return INDEXV(src);
+}
+
+//the interior gets updated, and so do the wrapped copies past a periodic side
+int temporalBlockEvolves(int4 g, const int* periodic) {
+	for (int side = 0; side < DIM; ++side) {
+		if (!periodic[side] && (g[side] < 2 || g[side] >= size[side] - 2)) return 0;
+	}
+	return 1;
+}
+
+//whether tile coord t is in [lo + loPad, size - lo + hiPad) along 'side' and in [lo, size - lo) across it
+int temporalBlockInRange(int4 t, int lo, int side, int loPad, int hiPad) {
+	if (t[side] < lo + loPad || t[side] >= tileSize[side] - lo + hiPad) return 0;
+#if DIM > 1
+	int other = !side;
+	if (t[other] < lo || t[other] >= tileSize[other] - lo) return 0;
+#endif
+	return 1;
+}
+
+//boundaryLine, for whichever ghost cells of a non-periodic side are in the tile
+void temporalBlockBoundary(__local real* tileState, int4 origin, const int* periodic, __constant int* boundaryMethods, int side) {
+	if (periodic[side]) return;
+	int n = size[side];
+	for (int c = get_local_id(0) + get_local_size(0) * get_local_id(1); c < TILE_VOLUME; c += get_local_size(0) * get_local_size(1)) {
+		int4 t = TILE_COORD(c);
+		int k = origin[side] + t[side];
+		if (k < 0 || k >= n || (k >= 2 && k < n - 2)) continue;
+		int minmax = k >= 2;
+		for (int j = 0; j < NUM_STATES; ++j) {
+			int srcK;
+			real sign = 1.;
+			switch (boundaryMethods[j + NUM_STATES * (minmax + 2 * side)]) {
+			case BOUNDARY_KERNEL_MIRROR:
+				srcK = minmax ? 2 * n - 5 - k : 3 - k;
+				break;
+			case BOUNDARY_KERNEL_REFLECT:
+				srcK = minmax ? 2 * n - 5 - k : 3 - k;
+				sign = -1.;
+				break;
+			case BOUNDARY_KERNEL_FREEFLOW:
+				srcK = minmax ? n - 3 : 2;
+				break;
+			default:
+				continue;
+			}
+			int srcT = t[side] + srcK - k;
+			if (srcT < 0 || srcT >= tileSize[side]) continue;
+			tileState[j + NUM_STATES * c] = sign * tileState[j + NUM_STATES * (c + (srcK - k) * tileStepsize[side])];
+		}
+	}
+}
+
+//state of tile cell c, with the momentum rotated so that 'side' lies along x
+void temporalBlockReadState(real* state, const __local real* tileState, int c, int side) {
+	for (int j = 0; j < NUM_STATES; ++j) {
+		state[j] = tileState[j + NUM_STATES * c];
+	}
+	real tmp = state[STATE_MOMENTUM_X];
+	state[STATE_MOMENTUM_X] = state[STATE_MOMENTUM_X + side];
+	state[STATE_MOMENTUM_X + side] = tmp;
+}
+
+//the rotated states on either side of the interface on the min side of tile cell c, with solid cells mirroring the fluid ones
+void temporalBlockInterfaceStates(
+	real* stateL,
+	real* stateR,
+	real* energyPotentialL,
+	real* energyPotentialR,
+	const __local real* tileState,
+	int c,
+	int4 origin,
+	const int* periodic,
+	const __global real_storage* potentialBuffer,
+	const __global char* solidBuffer,
+	int side)
+{
+	int4 t = TILE_COORD(c);
+	int4 tL = t;
+	--tL[side];
+	int srcL = temporalBlockSourceIndex(origin + tL, periodic);
+	int srcR = temporalBlockSourceIndex(origin + t, periodic);
+
+	temporalBlockReadState(stateL, tileState, c - tileStepsize[side], side);
+	temporalBlockReadState(stateR, tileState, c, side);
+	*energyPotentialL = potentialBuffer[srcL];
+	*energyPotentialR = potentialBuffer[srcR];
+
+#ifdef SOLID
+	char solidL = solidBuffer[srcL];
+	char solidR = solidBuffer[srcR];
+	if (solidL && !solidR) {
+		for (int j = 0; j < NUM_STATES; ++j) {
+			stateL[j] = stateR[j];
+		}
+		stateL[STATE_MOMENTUM_X] = -stateL[STATE_MOMENTUM_X];
+	} else if (solidR && !solidL) {
+		for (int j = 0; j < NUM_STATES; ++j) {
+			stateR[j] = stateL[j];
+		}
+		stateR[STATE_MOMENTUM_X] = -stateR[STATE_MOMENTUM_X];
+	}
+#endif	//SOLID
+}
+
+#ifdef TEMPORAL_BLOCK_ROE
+
+void temporalBlockRoeBasis(
+	real* eigenvalues,
+	real* eigenvectorsInverse,
+	real* eigenvectors,
+	const real* stateL,
+	const real* stateR,
+	real energyPotentialL,
+	real energyPotentialR,
+	__constant Defs* defs);
+
+//the side 0 basis of EulerRoe.cl, of states that are already rotated
+void temporalBlockRoeBasis(
+	real* eigenvalues,
+	real* eigenvectorsInverse,
+	real* eigenvectors,
+	const real* stateL,
+	const real* stateR,
+	real energyPotentialL,
+	real energyPotentialR,
+	__constant Defs* defs)
+{
+	real densityL = stateL[STATE_DENSITY];
+	real invDensityL = 1.f / densityL;
+	real4 velocityL = VELOCITY(stateL);
+	real energyTotalL = stateL[STATE_ENERGY_TOTAL] * invDensityL;
+	real energyInternalL = energyTotalL - .5f * dot(velocityL, velocityL) - energyPotentialL;
+	real pressureL = (gamma - 1.f) * densityL * energyInternalL;
+	real enthalpyTotalL = energyTotalL + pressureL * invDensityL;
+	real roeWeightL = sqrt(densityL);
+
+	real densityR = stateR[STATE_DENSITY];
+	real invDensityR = 1.f / densityR;
+	real4 velocityR = VELOCITY(stateR);
+	real energyTotalR = stateR[STATE_ENERGY_TOTAL] * invDensityR;
+	real energyInternalR = energyTotalR - .5f * dot(velocityR, velocityR) - energyPotentialR;
+	real pressureR = (gamma - 1.f) * densityR * energyInternalR;
+	real enthalpyTotalR = energyTotalR + pressureR * invDensityR;
+	real roeWeightR = sqrt(densityR);
+
+	real roeWeightNormalization = 1.f / (roeWeightL + roeWeightR);
+	real4 velocity = (roeWeightL * velocityL + roeWeightR * velocityR) * roeWeightNormalization;
+	real enthalpyTotal = (roeWeightL * enthalpyTotalL + roeWeightR * enthalpyTotalR) * roeWeightNormalization;
+	real energyPotential = (roeWeightL * energyPotentialL + roeWeightR * energyPotentialR) * roeWeightNormalization;
+	real velocitySq = dot(velocity, velocity);
+	real speedOfSound = sqrt((enthalpyTotal - .5f * velocitySq - energyPotential) * (gamma - 1.f));
+
+	eigenvalues[0] = velocity.x - speedOfSound;
+	eigenvalues[1] = velocity.x;
+#if EULER_DIM > 1
+	eigenvalues[2] = velocity.x;
+#endif
+#if EULER_DIM > 2
+	eigenvalues[3] = velocity.x;
+#endif
+	eigenvalues[EULER_DIM+1] = velocity.x + speedOfSound;
+
+	//min col
+	eigenvectors[0 + NUM_STATES * 0] = 1.f;
+	eigenvectors[1 + NUM_STATES * 0] = velocity.x - speedOfSound;
+#if EULER_DIM > 1
+	eigenvectors[2 + NUM_STATES * 0] = velocity.y;
+#endif
+#if EULER_DIM > 2
+	eigenvectors[3 + NUM_STATES * 0] = velocity.z;
+#endif
+	eigenvectors[(EULER_DIM+1) + NUM_STATES * 0] = enthalpyTotal - speedOfSound * velocity.x;
+	//mid col (normal)
+	eigenvectors[0 + NUM_STATES * 1] = 1.f;
+	eigenvectors[1 + NUM_STATES * 1] = velocity.x;
+#if EULER_DIM > 1
+	eigenvectors[2 + NUM_STATES * 1] = velocity.y;
+#endif
+#if EULER_DIM > 2
+	eigenvectors[3 + NUM_STATES * 1] = velocity.z;
+#endif
+	eigenvectors[(EULER_DIM+1) + NUM_STATES * 1] = .5f * velocitySq;
+	//mid col (tangent A)
+#if EULER_DIM > 1
+	eigenvectors[0 + NUM_STATES * 2] = 0.f;
+	eigenvectors[1 + NUM_STATES * 2] = 0.f;
+	eigenvectors[2 + NUM_STATES * 2] = 1.f;
+#if EULER_DIM > 2
+	eigenvectors[3 + NUM_STATES * 2] = 0.f;
+#endif
+	eigenvectors[(EULER_DIM+1) + NUM_STATES * 2] = velocity.y;
+#endif
+	//mid col (tangent B)
+#if EULER_DIM > 2
+	eigenvectors[0 + NUM_STATES * 3] = 0.f;
+	eigenvectors[1 + NUM_STATES * 3] = 0.f;
+	eigenvectors[2 + NUM_STATES * 3] = 0.f;
+	eigenvectors[3 + NUM_STATES * 3] = 1.f;
+	eigenvectors[(EULER_DIM+1) + NUM_STATES * 3] = velocity.z;
+#endif
+	//max col
+	eigenvectors[0 + NUM_STATES * (EULER_DIM+1)] = 1.f;
+	eigenvectors[1 + NUM_STATES * (EULER_DIM+1)] = velocity.x + speedOfSound;
+#if EULER_DIM > 1
+	eigenvectors[2 + NUM_STATES * (EULER_DIM+1)] = velocity.y;
+#endif
+#if EULER_DIM > 2
+	eigenvectors[3 + NUM_STATES * (EULER_DIM+1)] = velocity.z;
+#endif
+	eigenvectors[(EULER_DIM+1) + NUM_STATES * (EULER_DIM+1)] = enthalpyTotal + speedOfSound * velocity.x;
+
+	real invDenom = .5f / (speedOfSound * speedOfSound);
+
+	//min row
+	eigenvectorsInverse[0 + NUM_STATES * 0] = (.5f * (gamma - 1.f) * velocitySq + speedOfSound * velocity.x) * invDenom;
+	eigenvectorsInverse[0 + NUM_STATES * 1] = -(speedOfSound + (gamma - 1.f) * velocity.x) * invDenom;
+#if EULER_DIM > 1
+	eigenvectorsInverse[0 + NUM_STATES * 2] = -(gamma - 1.f) * velocity.y * invDenom;
+#endif
+#if EULER_DIM > 2
+	eigenvectorsInverse[0 + NUM_STATES * 3] = -(gamma - 1.f) * velocity.z * invDenom;
+#endif
+	eigenvectorsInverse[0 + NUM_STATES * (EULER_DIM+1)] = (gamma - 1.f) * invDenom;
+	//mid normal row
+	eigenvectorsInverse[1 + NUM_STATES * 0] = 1.f - (gamma - 1.f) * velocitySq * invDenom;
+	eigenvectorsInverse[1 + NUM_STATES * 1] = (gamma - 1.f) * velocity.x * 2.f * invDenom;
+#if EULER_DIM > 1
+	eigenvectorsInverse[1 + NUM_STATES * 2] = (gamma - 1.f) * velocity.y * 2.f * invDenom;
+#endif
+#if EULER_DIM > 2
+	eigenvectorsInverse[1 + NUM_STATES * 3] = (gamma - 1.f) * velocity.z * 2.f * invDenom;
+#endif
+	eigenvectorsInverse[1 + NUM_STATES * (EULER_DIM+1)] = -(gamma - 1.f) * 2.f * invDenom;
+	//mid tangent A row
+#if EULER_DIM > 1
+	eigenvectorsInverse[2 + NUM_STATES * 0] = -velocity.y;
+	eigenvectorsInverse[2 + NUM_STATES * 1] = 0.f;
+	eigenvectorsInverse[2 + NUM_STATES * 2] = 1.f;
+#if EULER_DIM > 2
+	eigenvectorsInverse[2 + NUM_STATES * 3] = 0.f;
+#endif
+	eigenvectorsInverse[2 + NUM_STATES * (EULER_DIM+1)] = 0.f;
+#endif
+	//mid tangent B row
+#if EULER_DIM > 2
+	eigenvectorsInverse[3 + NUM_STATES * 0] = -velocity.z;
+	eigenvectorsInverse[3 + NUM_STATES * 1] = 0.f;
+	eigenvectorsInverse[3 + NUM_STATES * 2] = 0.f;
+	eigenvectorsInverse[3 + NUM_STATES * 3] = 1.f;
+	eigenvectorsInverse[3 + NUM_STATES * (EULER_DIM+1)] = 0.f;
+#endif
+	//max row
+	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * 0] = (.5f * (gamma - 1.f) * velocitySq - speedOfSound * velocity.x) * invDenom;
+	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * 1] = (speedOfSound - (gamma - 1.f) * velocity.x) * invDenom;
+#if EULER_DIM > 1
+	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * 2] = -(gamma - 1.f) * velocity.y * invDenom;
+#endif
+#if EULER_DIM > 2
+	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * 3] = -(gamma - 1.f) * velocity.z * invDenom;
+#endif
+	eigenvectorsInverse[(EULER_DIM+1) + NUM_STATES * (EULER_DIM+1)] = (gamma - 1.f) * invDenom;
+}
+
+#else	//TEMPORAL_BLOCK_ROE
+
+void temporalBlockHLLFlux(real* flux, const real* stateL, const real* stateR, real energyPotentialL, real energyPotentialR, __constant Defs* defs);
+
+//calcEigenvaluesSide and calcFluxSide of EulerHLL.cl, of states that are already rotated
+void temporalBlockHLLFlux(real* flux, const real* stateL, const real* stateR, real energyPotentialL, real energyPotentialR, __constant Defs* defs) {
+	real densityL = stateL[STATE_DENSITY];
+	real invDensityL = 1. / densityL;
+	real4 velocityL = VELOCITY(stateL);
+	real velocitySqL = dot(velocityL, velocityL);
+	real energyTotalL = stateL[STATE_ENERGY_TOTAL] * invDensityL;
+	real energyInternalL = energyTotalL - .5 * velocitySqL - energyPotentialL;
+	real pressureL = (gamma - 1.) * densityL * energyInternalL;
+	real enthalpyTotalL = energyTotalL + pressureL * invDensityL;
+	real speedOfSoundL = sqrt((gamma - 1.) * (enthalpyTotalL - .5 * velocitySqL));
+	real roeWeightL = sqrt(densityL);
+
+	real densityR = stateR[STATE_DENSITY];
+	real invDensityR = 1. / densityR;
+	real4 velocityR = VELOCITY(stateR);
+	real velocitySqR = dot(velocityR, velocityR);
+	real energyTotalR = stateR[STATE_ENERGY_TOTAL] * invDensityR;
+	real energyInternalR = energyTotalR - .5 * velocitySqR - energyPotentialR;
+	real pressureR = (gamma - 1.) * densityR * energyInternalR;
+	real enthalpyTotalR = energyTotalR + pressureR * invDensityR;
+	real speedOfSoundR = sqrt((gamma - 1.) * (enthalpyTotalR - .5 * velocitySqR));
+	real roeWeightR = sqrt(densityR);
+
+	real roeWeightNormalization = 1. / (roeWeightL + roeWeightR);
+	real4 velocity = (roeWeightL * velocityL + roeWeightR * velocityR) * roeWeightNormalization;
+	real enthalpyTotal = (roeWeightL * enthalpyTotalL + roeWeightR * enthalpyTotalR) * roeWeightNormalization;
+	real energyPotential = (roeWeightL * energyPotentialL + roeWeightR * energyPotentialR) * roeWeightNormalization;
+	real speedOfSound = sqrt((gamma - 1.) * (enthalpyTotal - .5 * dot(velocity, velocity) - energyPotential));
+
+	//Davis direct bounded
+	real sl = min(velocityL.x - speedOfSoundL, velocity.x - speedOfSound);
+	real sr = max(velocityR.x + speedOfSoundR, velocity.x + speedOfSound);
+
+	real fluxL[NUM_STATES];
+	fluxL[0] = densityL * velocityL.x;
+	fluxL[1] = densityL * velocityL.x * velocityL.x + pressureL;
+#if EULER_DIM > 1
+	fluxL[2] = densityL * velocityL.y * velocityL.x;
+#endif
+#if EULER_DIM > 2
+	fluxL[3] = densityL * velocityL.z * velocityL.x;
+#endif
+	fluxL[EULER_DIM+1] = densityL * enthalpyTotalL * velocityL.x;
+
+	real fluxR[NUM_STATES];
+	fluxR[0] = densityR * velocityR.x;
+	fluxR[1] = densityR * velocityR.x * velocityR.x + pressureR;
+#if EULER_DIM > 1
+	fluxR[2] = densityR * velocityR.y * velocityR.x;
+#endif
+#if EULER_DIM > 2
+	fluxR[3] = densityR * velocityR.z * velocityR.x;
+#endif
+	fluxR[EULER_DIM+1] = densityR * enthalpyTotalR * velocityR.x;
+
+	if (0. <= sl) {
+		for (int j = 0; j < NUM_STATES; ++j) {
+			flux[j] = fluxL[j];
+		}
+	} else if (sr <= 0.) {
+		for (int j = 0; j < NUM_STATES; ++j) {
+			flux[j] = fluxR[j];
+		}
+	} else {
+		real invDenom = 1. / (sr - sl);
+		for (int j = 0; j < NUM_STATES; ++j) {
+			flux[j] = (sr * fluxL[j] - sl * fluxR[j] + sl * sr * (stateR[j] - stateL[j])) * invDenom;
+		}
+	}
+}
+
+#endif	//TEMPORAL_BLOCK_ROE
+
+/*
+launched with one work group per tile, and any number of work items per group
+args: result, stateBuffer, potentialBuffer, solidBuffer, boundaryMethods, defs, dt, limiter
+the halos overlap the neighboring tiles, so each group reads stateBuffer and writes its interior cells to result, which must be a different buffer
+*/
+__kernel void temporalBlock(
+	__global real_storage* result,
+	const __global real_storage* stateBuffer,
+	const __global real_storage* potentialBuffer,
+	const __global char* solidBuffer,
+	__constant int* boundaryMethods,
+	__constant Defs* defs,
+	real dt,
+	int limiter)
+{
+	__local real tileState[NUM_STATES * TILE_VOLUME];
+	__local real tileFlux[NUM_STATES * TILE_VOLUME];	//one side at a time, at the interface on the min side of each cell
+#ifdef TEMPORAL_BLOCK_ROE
+	__local real tileDeltaQTilde[NUM_STATES * TILE_VOLUME];
+#endif	//TEMPORAL_BLOCK_ROE
+#if DIM > 1
+	__local real tileDeriv[NUM_STATES * TILE_VOLUME];
+#endif
+
+	int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+	int localCount = get_local_size(0) * get_local_size(1);
+
+	//global coordinate of tile cell 0
+	int4 origin = (int4)(2 + get_group_id(0) * TEMPORAL_BLOCK_TILE_X - TEMPORAL_BLOCK_HALO, 0, 0, 0);
+#if DIM > 1
+	origin.y = 2 + get_group_id(1) * TEMPORAL_BLOCK_TILE_Y - TEMPORAL_BLOCK_HALO;
+#endif
+
+	//the host only blocks if every state of a side is periodic or none are
+	int periodic[DIM];
+	for (int side = 0; side < DIM; ++side) {
+		periodic[side] = boundaryMethods[NUM_STATES * (2 * side)] == BOUNDARY_KERNEL_PERIODIC;
+	}
+
+	for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+		int src = temporalBlockSourceIndex(origin + TILE_COORD(c), periodic);
+		for (int j = 0; j < NUM_STATES; ++j) {
+			tileState[j + NUM_STATES * c] = stateBuffer[j + NUM_STATES * src];
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (int step = 0; step < TEMPORAL_BLOCK_STEPS; ++step) {
+		for (int side = 0; side < DIM; ++side) {
+			temporalBlockBoundary(tileState, origin, periodic, boundaryMethods, side);
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+
+		//cells [lo, size - lo) are still good after this step
+		int lo = TEMPORAL_BLOCK_RADIUS * (step + 1);
+
+		for (int side = 0; side < DIM; ++side) {
+			real dt_dx = dt / dx[side];
+
+#ifdef TEMPORAL_BLOCK_ROE
+			//deltaQTilde of the interfaces the limiter looks at: [lo - 1, size - lo + 1]
+			for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+				if (!temporalBlockInRange(TILE_COORD(c), lo, side, -1, 2)) continue;
+				real stateL[NUM_STATES], stateR[NUM_STATES];
+				real energyPotentialL, energyPotentialR;
+				temporalBlockInterfaceStates(stateL, stateR, &energyPotentialL, &energyPotentialR, tileState, c, origin, periodic, potentialBuffer, solidBuffer, side);
+
+				real eigenvalues[NUM_STATES];
+				real eigenvectorsInverse[NUM_STATES * NUM_STATES];
+				real eigenvectors[NUM_STATES * NUM_STATES];
+				temporalBlockRoeBasis(eigenvalues, eigenvectorsInverse, eigenvectors, stateL, stateR, energyPotentialL, energyPotentialR, defs);
+
+				__local real* deltaQTilde = tileDeltaQTilde + NUM_STATES * c;
+				for (int i = 0; i < NUM_STATES; ++i) {
+					real sum = 0.;
+					for (int j = 0; j < NUM_STATES; ++j) {
+						sum += eigenvectorsInverse[i + NUM_STATES * j] * (stateR[j] - stateL[j]);
+					}
+					deltaQTilde[i] = sum;
+				}
+			}
+			barrier(CLK_LOCAL_MEM_FENCE);
+#endif	//TEMPORAL_BLOCK_ROE
+
+			//flux of the interfaces of the cells being updated: [lo, size - lo]
+			for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+				if (!temporalBlockInRange(TILE_COORD(c), lo, side, 0, 1)) continue;
+				real stateL[NUM_STATES], stateR[NUM_STATES];
+				real energyPotentialL, energyPotentialR;
+				temporalBlockInterfaceStates(stateL, stateR, &energyPotentialL, &energyPotentialR, tileState, c, origin, periodic, potentialBuffer, solidBuffer, side);
+
+				real flux[NUM_STATES];
+#ifdef TEMPORAL_BLOCK_ROE
+				real eigenvalues[NUM_STATES];
+				real eigenvectorsInverse[NUM_STATES * NUM_STATES];
+				real eigenvectors[NUM_STATES * NUM_STATES];
+				temporalBlockRoeBasis(eigenvalues, eigenvectorsInverse, eigenvectors, stateL, stateR, energyPotentialL, energyPotentialR, defs);
+
+#ifdef SOLID
+				int4 t = TILE_COORD(c);
+				int4 tL2 = t, tR2 = t;
+				tL2[side] -= 2;
+				++tR2[side];
+				char solidL2 = solidBuffer[temporalBlockSourceIndex(origin + tL2, periodic)];
+				char solidR2 = solidBuffer[temporalBlockSourceIndex(origin + tR2, periodic)];
+#endif	//SOLID
+
+				const __local real* deltaQTildeL = tileDeltaQTilde + NUM_STATES * (c - tileStepsize[side]);
+				const __local real* deltaQTilde = tileDeltaQTilde + NUM_STATES * c;
+				const __local real* deltaQTildeR = tileDeltaQTilde + NUM_STATES * (c + tileStepsize[side]);
+
+				//Roe.cl calcFluxSide
+				real fluxTilde[NUM_STATES];
+				for (int i = 0; i < NUM_STATES; ++i) {
+					real sum = 0.;
+					for (int j = 0; j < NUM_STATES; ++j) {
+						sum += eigenvectorsInverse[i + NUM_STATES * j] * .5 * (stateR[j] + stateL[j]);
+					}
+					fluxTilde[i] = sum;
+				}
+				for (int i = 0; i < NUM_STATES; ++i) {
+					real eigenvalue = eigenvalues[i];
+					fluxTilde[i] *= eigenvalue;
+
+					real rTilde;
+					real theta;
+					if (eigenvalue >= 0.) {
+						rTilde = deltaQTildeL[i] / deltaQTilde[i];
+						theta = 1.;
+#ifdef SOLID
+						if (solidL2) rTilde = 1.;
+#endif	//SOLID
+					} else {
+						rTilde = deltaQTildeR[i] / deltaQTilde[i];
+						theta = -1.;
+#ifdef SOLID
+						if (solidR2) rTilde = 1.;
+#endif	//SOLID
+					}
+					real phi = slopeLimiter(rTilde, limiter);
+					real epsilon = eigenvalue * dt_dx;
+
+					real deltaFluxTilde = eigenvalue * deltaQTilde[i];
+					fluxTilde[i] -= .5 * deltaFluxTilde * (theta + phi * (epsilon - theta));
+				}
+				for (int i = 0; i < NUM_STATES; ++i) {
+					real sum = 0.;
+					for (int j = 0; j < NUM_STATES; ++j) {
+						sum += eigenvectors[i + NUM_STATES * j] * fluxTilde[j];
+					}
+					flux[i] = sum;
+				}
+#else	//TEMPORAL_BLOCK_ROE
+				temporalBlockHLLFlux(flux, stateL, stateR, energyPotentialL, energyPotentialR, defs);
+#endif	//TEMPORAL_BLOCK_ROE
+
+				//rotate back to side
+				__local real* dstFlux = tileFlux + NUM_STATES * c;
+				for (int j = 0; j < NUM_STATES; ++j) {
+					dstFlux[j] = flux[j];
+				}
+				dstFlux[STATE_MOMENTUM_X] = flux[STATE_MOMENTUM_X + side];
+				dstFlux[STATE_MOMENTUM_X + side] = flux[STATE_MOMENTUM_X];
+			}
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			//calcFluxDeriv
+			for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+				int4 t = TILE_COORD(c);
+				if (!temporalBlockInRange(t, lo, side, 0, 0)) continue;
+				if (!temporalBlockEvolves(origin + t, periodic)) continue;
+#ifdef SOLID
+				if (solidBuffer[temporalBlockSourceIndex(origin + t, periodic)]) continue;
+#endif	//SOLID
+				const __local real* fluxL = tileFlux + NUM_STATES * c;
+				const __local real* fluxR = tileFlux + NUM_STATES * (c + tileStepsize[side]);
+				for (int j = 0; j < NUM_STATES; ++j) {
+					real deriv = -(fluxR[j] - fluxL[j]) / dx[side];
+#if DIM > 1
+					//the other side's flux still needs the old state
+					if (side == 0) {
+						tileDeriv[j + NUM_STATES * c] = deriv;
+					} else {
+						tileDeriv[j + NUM_STATES * c] += deriv;
+					}
+#else
+					tileState[j + NUM_STATES * c] += deriv * dt;
+#endif
+				}
+			}
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+
+#if DIM > 1
+		for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+			int4 t = TILE_COORD(c);
+			if (!temporalBlockInRange(t, lo, 0, 0, 0)) continue;
+			if (!temporalBlockEvolves(origin + t, periodic)) continue;
+#ifdef SOLID
+			if (solidBuffer[temporalBlockSourceIndex(origin + t, periodic)]) continue;
+#endif	//SOLID
+			for (int j = 0; j < NUM_STATES; ++j) {
+				tileState[j + NUM_STATES * c] += tileDeriv[j + NUM_STATES * c] * dt;
+			}
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+
+		//calcGravityDeriv, which SelfGravitation::applyPotential integrates after the flux
+		for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+			int4 t = TILE_COORD(c);
+			if (!temporalBlockInRange(t, lo, 0, 0, 0)) continue;
+			if (!temporalBlockEvolves(origin + t, periodic)) continue;
+			__local real* state = tileState + NUM_STATES * c;
+
+			real density = state[STATE_DENSITY];
+			real deriv[DIM];
+			real derivEnergyTotal = 0.;
+			for (int side = 0; side < DIM; ++side) {
+				int4 tPrev = t, tNext = t;
+				--tPrev[side];
+				++tNext[side];
+				real gradient = (potentialBuffer[temporalBlockSourceIndex(origin + tNext, periodic)] - potentialBuffer[temporalBlockSourceIndex(origin + tPrev, periodic)]) / (2. * dx[side]);
+				real gravity = -gradient;
+				deriv[side] = -density * gravity;
+				derivEnergyTotal -= density * gravity * state[side + STATE_MOMENTUM_X];
+			}
+			for (int side = 0; side < DIM; ++side) {
+				state[side + STATE_MOMENTUM_X] += deriv[side] * dt;
+			}
+			state[STATE_ENERGY_TOTAL] += derivEnergyTotal * dt;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	for (int c = localIndex; c < TILE_VOLUME; c += localCount) {
+		int4 t = TILE_COORD(c);
+		int4 g = origin + t;
+		if (t.x < TEMPORAL_BLOCK_HALO || t.x >= TEMPORAL_BLOCK_HALO + TEMPORAL_BLOCK_TILE_X || g.x >= SIZE_X - 2) continue;
+#if DIM > 1
+		if (t.y < TEMPORAL_BLOCK_HALO || t.y >= TEMPORAL_BLOCK_HALO + TEMPORAL_BLOCK_TILE_Y || g.y >= SIZE_Y - 2) continue;
+#endif
+		for (int j = 0; j < NUM_STATES; ++j) {
+			result[j + NUM_STATES * INDEXV(g)] = tileState[j + NUM_STATES * c];
+		}
+	}
+}
@@ -0,0 +1,121 @@
+/*
+the implicit half of the IMEX integrators: for each cell, solve u = u* + dt S(u) with Newton's method, where u* is the state coming in.
+the solver's .cl has to provide:
+	calcSource(source, state), setting all NUM_STATES of source to S(state)
+	NUM_IMPLICIT_STATES and implicitStates[], the states whose S isn't zero.  Newton only has to work on those, the rest stay u*.
+the Jacobian is by finite differences of calcSource, and solved by Gaussian elimination with partial pivoting.
+the solution replaces the state, and S of it goes to sourceBuffer, for the integrator to reuse.
+with dt = 0 this is just S(u*)
+*/
+
+#ifndef IMPLICIT_SOURCE_MAX_ITER
+#define IMPLICIT_SOURCE_MAX_ITER 10
+#endif
+
+__kernel void implicitSource(
+	__global real_storage* sourceBuffer,
+	__global real_storage* stateBuffer,
+	real dt)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X - 2
+#if DIM > 1
+		|| i.y >= SIZE_Y - 2
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z - 2
+#endif
+	) {
+		return;
+	}
+	int index = INDEXV(i);
+	__global real_storage* stateG = stateBuffer + NUM_STATES * index;
+	__global real_storage* sourceG = sourceBuffer + NUM_STATES * index;
+
+	real state[NUM_STATES];
+	for (int j = 0; j < NUM_STATES; ++j) {
+		state[j] = stateG[j];
+	}
+
+	real stateStar[NUM_IMPLICIT_STATES];
+	for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+		stateStar[k] = state[implicitStates[k]];
+	}
+
+	real source[NUM_STATES];
+	calcSource(source, state);
+
+	if (dt != 0.) {
+		real sourcePerturbed[NUM_STATES];
+		//[J | -F], row k for the k'th implicit state
+		real jacobian[NUM_IMPLICIT_STATES][NUM_IMPLICIT_STATES+1];
+
+		for (int iter = 0; iter < IMPLICIT_SOURCE_MAX_ITER; ++iter) {
+			//F(u) = u - u* - dt S(u)
+			bool converged = true;
+			for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+				int sk = implicitStates[k];
+				real residual = state[sk] - stateStar[k] - dt * source[sk];
+				jacobian[k][NUM_IMPLICIT_STATES] = -residual;
+				if (!(fabs(residual) <= SQRT_MACHINE_EPSILON * (1. + fabs(state[sk])))) converged = false;
+			}
+			if (converged) break;
+
+			//J = I - dt dS/du, a column per perturbed implicit state
+			for (int j = 0; j < NUM_IMPLICIT_STATES; ++j) {
+				int sj = implicitStates[j];
+				real oldValue = state[sj];
+				real h = SQRT_MACHINE_EPSILON * (1. + fabs(oldValue));
+				state[sj] = oldValue + h;
+				calcSource(sourcePerturbed, state);
+				state[sj] = oldValue;
+				for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+					int sk = implicitStates[k];
+					jacobian[k][j] = (k == j ? 1. : 0.) - dt * (sourcePerturbed[sk] - source[sk]) / h;
+				}
+			}
+
+			//forward elimination
+			for (int c = 0; c < NUM_IMPLICIT_STATES; ++c) {
+				int pivot = c;
+				for (int r = c + 1; r < NUM_IMPLICIT_STATES; ++r) {
+					if (fabs(jacobian[r][c]) > fabs(jacobian[pivot][c])) pivot = r;
+				}
+				if (pivot != c) {
+					for (int m = c; m <= NUM_IMPLICIT_STATES; ++m) {
+						real tmp = jacobian[c][m];
+						jacobian[c][m] = jacobian[pivot][m];
+						jacobian[pivot][m] = tmp;
+					}
+				}
+				for (int r = c + 1; r < NUM_IMPLICIT_STATES; ++r) {
+					real ratio = jacobian[r][c] / jacobian[c][c];
+					for (int m = c; m <= NUM_IMPLICIT_STATES; ++m) {
+						jacobian[r][m] -= ratio * jacobian[c][m];
+					}
+				}
+			}
+
+			//back substitution, and u += du
+			for (int c = NUM_IMPLICIT_STATES - 1; c >= 0; --c) {
+				real sum = jacobian[c][NUM_IMPLICIT_STATES];
+				for (int m = c + 1; m < NUM_IMPLICIT_STATES; ++m) {
+					sum -= jacobian[c][m] * jacobian[m][NUM_IMPLICIT_STATES];
+				}
+				jacobian[c][NUM_IMPLICIT_STATES] = sum / jacobian[c][c];
+				state[implicitStates[c]] += jacobian[c][NUM_IMPLICIT_STATES];
+			}
+
+			calcSource(source, state);
+		}
+
+		for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+			int sk = implicitStates[k];
+			stateG[sk] = state[sk];
+		}
+	}
+
+	for (int j = 0; j < NUM_STATES; ++j) {
+		sourceG[j] = source[j];
+	}
+}
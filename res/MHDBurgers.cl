@@ -30,17 +30,14 @@ __kernel void calcCellTimestep(
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
 	int index = INDEXV(i);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
-	) {
-		dtBuffer[index] = INFINITY;
-		return;
-	}
+	) return;
 
 	const __global real* state = stateBuffer + NUM_STATES * index;
 
@@ -60,12 +57,12 @@ __kernel void calcInterfaceVelocity(
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -90,17 +87,18 @@ __kernel void calcVelocityFlux(
 	__global real* fluxBuffer,
 	const __global real* stateBuffer,
 	const __global real* interfaceVelocityBuffer,
-	real dt)
+	real dt,
+	int limiter)
 {
 	real4 dt_dx = dt / dx;
 	
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -143,7 +141,7 @@ __kernel void calcVelocityFlux(
 			}
 
 			//2nd order
-			real phi = slopeLimiter(stateSlopeRatio);
+			real phi = slopeLimiter(stateSlopeRatio, limiter);
 			real delta = phi * deltaState;
 			flux += delta * .5f * fabs(interfaceVelocity) * (1.f - fabs(interfaceVelocity * dt_dx[side]));
 			
@@ -157,12 +155,12 @@ __kernel void calcInterfaceMagneticField(
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -208,17 +206,18 @@ __kernel void calcMagneticFieldFlux(
 	__global real* fluxBuffer,
 	const __global real* stateBuffer,
 	const __global real* interfaceMagneticFieldBuffer,
-	real dt)
+	real dt,
+	int limiter)
 {
 	real4 dt_dx = dt / dx;
 	
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1 
+		|| i.y >= SIZE_Y - 1 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) {
 		return;
@@ -269,7 +268,7 @@ __kernel void calcMagneticFieldFlux(
 			}
 
 			//2nd order
-			real phi = slopeLimiter(stateSlopeRatio);
+			real phi = slopeLimiter(stateSlopeRatio, limiter);
 			real delta = phi * deltaState;
 			flux += delta * .5f * fabs(interfaceMagneticField) * (1.f - fabs(interfaceMagneticField * dt_dx[side]));
 			
@@ -286,12 +285,12 @@ __kernel void calcFluxDeriv(
 	const __global real* fluxBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -363,12 +362,12 @@ __kernel void diffuseMomentum(
 	const __global real* pressureBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -395,12 +394,12 @@ __kernel void diffuseWork(
 	const __global real* pressureBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
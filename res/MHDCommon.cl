@@ -14,7 +14,7 @@ Primitives_t calcPrimitivesFromState(real8 state, real potentialEnergy) {
 	real kineticEnergyDensity = .5 * prims.density * dot(prims.velocity, prims.velocity);
 	real potentialEnergyDensity = prims.density * potentialEnergy; 
 	real internalEnergyDensity = totalHydroEnergyDensity - kineticEnergyDensity - potentialEnergyDensity;
-internalEnergyDensity = max(0., internalEnergyDensity);	//magnetic energy is exceeding total energy ...
+internalEnergyDensity = max((real)0., internalEnergyDensity);	//magnetic energy is exceeding total energy ...
 	prims.pressure = (gamma - 1.) * internalEnergyDensity;
 	prims.pressureTotal = prims.pressure + magneticEnergyDensity;
 	//not used by wavespeed, only by flux calc
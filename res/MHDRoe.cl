@@ -49,8 +49,8 @@ void calcPrimFromCons(struct Roe_t *W, const __global struct cons_t *U, real ePo
 	real EKin = .5 * U->rho * vSq;
 	real EMag = .5 * bSq;
 	real P = (U->ETotal - EKin - EMag) * (gamma - 1.);
-	W->rho = max(W->rho, 1e-7);
-	P = max(P, 1e-7);
+	W->rho = max(W->rho, (real)1e-7);
+	P = max(P, (real)1e-7);
 	W->hTotal = (U->ETotal + P + EMag) / U->rho;
 }
 
@@ -102,12 +102,12 @@ void calcEigenBasisSide(
 	int side)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0.);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	
@@ -503,13 +503,13 @@ void leftEigenvectorTransform(
 }
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvectorsBuffer,
 	const real* input_,
 	int side);
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvectorsBuffer,
 	const real* input,
 	int side)
@@ -541,6 +541,7 @@ __kernel void calcMHDFlux(
 	const __global real* eigenvectorsBuffer,
 	const __global real* deltaQTildeBuffer,
 	real dt,
+	int limiter,
 #ifdef SOLID
 	const __global char* solidBuffer,
 #endif	//SOLID
@@ -557,7 +558,8 @@ __kernel void calcMHDFlux(
 		eigenvaluesBuffer,
 		eigenvectorsBuffer,
 		deltaQTildeBuffer,
-		dt
+		dt,
+		limiter
 #ifdef SOLID
 		, solidBuffer
 #endif	//SOLID
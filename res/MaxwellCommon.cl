@@ -62,10 +62,13 @@ __kernel void updateVectorField(
 	__global float* vectorFieldVertexBuffer,
 	float scale,
 	int displayMethod,
-	const __global real* stateBuffer)
+	const __global real* stateBuffer,
+	int resolution)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	int4 size = (int4)(get_global_size(0), get_global_size(1), get_global_size(2), 0);	
+	//launched padded to the local size, so the field size is passed in
+	int4 size = (int4)(resolution, DIM > 1 ? resolution : 1, DIM > 2 ? resolution : 1, 0);
+	if (i.x >= size.x || i.y >= size.y || i.z >= size.z) return;
 	int vertexIndex = i.x + size.x * (i.y + size.y * i.z);
 	__global float* vertex = vectorFieldVertexBuffer + 6 * 3 * vertexIndex;
 	
@@ -4,6 +4,7 @@ Described in Trangenstein, "Numeric Solutions of Hyperbolic Partial Differential
 */
 
 #include "HydroGPU/Shared/Common.h"
+#include "HydroGPU/Roe.h"
 
 #define ELECTRIC_FIELD(x) (real4)(x[STATE_ELECTRIC_X], x[STATE_ELECTRIC_Y], x[STATE_ELECTRIC_Z], 0.f)
 #define MAGNETIC_FIELD(x) (real4)(x[STATE_MAGNETIC_X], x[STATE_MAGNETIC_Y], x[STATE_MAGNETIC_Z], 0.f)
@@ -62,7 +63,7 @@ void leftEigenvectorTransform(
 }
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvector,	//not used
 	const real* input,
 	int side)
@@ -121,19 +122,17 @@ void calcEigenBasisSide(
 	int side)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	int index = INDEXV(i);
 
-	int interfaceIndex = side + DIM * index;
-	
-	__global real* eigenvalues = eigenvaluesBuffer + NUM_STATES * interfaceIndex;
+	__global real* eigenvalues = eigenvaluesBuffer + NUM_STATES * EIGEN_INTERFACE_INDEX(side, index);
 
 	//eigenvalues
 
@@ -156,33 +155,50 @@ __kernel void calcEigenBasis(
 	}
 }
 
+//ImplicitSource.cl
+#define NUM_IMPLICIT_STATES 3
+constant int implicitStates[NUM_IMPLICIT_STATES] = {STATE_ELECTRIC_X, STATE_ELECTRIC_Y, STATE_ELECTRIC_Z};
+
+void calcSource(real* source, const real* state);
+void calcSource(real* source, const real* state) {
+	for (int j = 0; j < NUM_STATES; ++j) {
+		source[j] = 0.;
+	}
+
+	real4 conductiveElectric = ELECTRIC_FIELD(state) * (maxwell_conductivity / maxwell_permittivity);
+	
+	source[STATE_ELECTRIC_X] -= conductiveElectric.x;
+	source[STATE_ELECTRIC_Y] -= conductiveElectric.y;
+	source[STATE_ELECTRIC_Z] -= conductiveElectric.z;
+}
+
 __kernel void addSource(
 	__global real* derivBuffer,
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2 
+		|| i.y >= SIZE_Y - 2 
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
 	}
 	int index = INDEXV(i);
-
-//for some odd reason, with source I'm getting bias in movement to the left and
-return;
-//I'm also getting reflections off the right-hand side, regradless of source
-
-	const __global real* state = stateBuffer + NUM_STATES * index;
 	__global real* deriv = derivBuffer + NUM_STATES * index;
-	
-	real4 conductiveElectric = (real4)(state[STATE_ELECTRIC_X], state[STATE_ELECTRIC_Y], state[STATE_ELECTRIC_Z], 0.f) * (maxwell_conductivity / maxwell_permittivity);
-	
-	deriv[STATE_ELECTRIC_X] -= conductiveElectric.x;
-	deriv[STATE_ELECTRIC_Y] -= conductiveElectric.y;
-	deriv[STATE_ELECTRIC_Z] -= conductiveElectric.z;
+	clearSplitDeriv(deriv);
+
+	//the same conduction the IMEX integrators' implicitSource applies, so the physics doesn't depend on the integrator
+	real state[NUM_STATES];
+	for (int j = 0; j < NUM_STATES; ++j) {
+		state[j] = stateBuffer[j + NUM_STATES * index];
+	}
+	real source[NUM_STATES];
+	calcSource(source, state);
+	for (int k = 0; k < NUM_IMPLICIT_STATES; ++k) {
+		deriv[implicitStates[k]] += source[implicitStates[k]];
+	}
 }
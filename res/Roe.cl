@@ -9,43 +9,49 @@ __kernel void calcCellTimestep(
 #endif
 //Toro 16.38
 #if 0
-	const __global real* stateBuffer
+	const __global real_storage* stateBuffer
 #endif
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef DIMENSIONAL_SPLIT
+	, int splitSide
+#endif	//DIMENSIONAL_SPLIT
 )
 {
+#ifdef FLUID_DISPATCH
+	int4 i = fluidListCell(fluidList);
+#else	//FLUID_DISPATCH
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+#endif	//FLUID_DISPATCH
 	int index = INDEXV(i);
 
-	if (i.x < 2 || i.x >= SIZE_X - 2 
+	if (i.x >= SIZE_X - 2 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2
+		|| i.y >= SIZE_Y - 2
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
-	) {
-		for (int side = 0; side < DIM; ++side) {
-			dtBuffer[side + DIM * index] = INFINITY;
-		}
-		return;
-	}
+	) return;
 	
-	for (int side = 0; side < DIM; ++side) {
+	//the dt of each side stays in dtBuffer, so the sweeps of DIMENSIONAL_SPLIT can fill it a side at a time
+	for (int side = SIDE_BEGIN; side < SIDE_END; ++side) {
 		int indexL = index;
 		int indexR = index + stepsize[side];
 
 #ifdef SOLID
-		if (solidBuffer[indexL] || solidBuffer[indexR]) {
+		if (isSolid(solidBuffer, indexL) || isSolid(solidBuffer, indexR)) {
 			dtBuffer[side + DIM * index] = INFINITY; 
 			continue;
 		}
 #endif	//SOLID
 
-		const __global real* eigenvaluesL = eigenvaluesBuffer + EIGEN_SPACE_DIM * (side + DIM * indexL);
-		const __global real* eigenvaluesR = eigenvaluesBuffer + EIGEN_SPACE_DIM * (side + DIM * indexR);
+		const __global real* eigenvaluesL = eigenvaluesBuffer + EIGEN_SPACE_DIM * EIGEN_INTERFACE_INDEX(side, indexL);
+		const __global real* eigenvaluesR = eigenvaluesBuffer + EIGEN_SPACE_DIM * EIGEN_INTERFACE_INDEX(side, indexR);
 		
 		//NOTICE assumes eigenvalues are sorted from min to max
 		real maxLambda = (real)max((real)0., eigenvaluesL[EIGEN_SPACE_DIM-1]);
@@ -64,52 +70,269 @@ __kernel void calcCellTimestep(
 	}
 }
 
+#ifdef ACTIVE_BLOCKS
+/*
+activity mask (Roe::updateActiveBlocks)
+blocks are ACTIVE_BLOCK_SIZE (the local size) cells, tiling the interfaces from cell 2 like the interior launches.
+calcActiveBlocks runs one work item per block, and appends the block to activeBlocks (counted in activeCount[0])
+if any state within ACTIVE_BLOCKS_MARGIN cells of it moved more than 'tolerance' since lastStateBuffer, or if forceActive.
+the calcEigenBasis, calcDeltaQTilde and calcFlux launches then run one work group per listed block.
+*/
+__kernel void calcActiveBlocks(
+	__global int* activeBlocks,
+	__global int* activeCount,
+	const __global real_storage* stateBuffer,
+	const __global real_storage* lastStateBuffer,
+	real tolerance,
+	int forceActive)
+{
+	int block = get_global_id(0);
+	if (block >= ACTIVE_BLOCKS_X * ACTIVE_BLOCKS_Y * ACTIVE_BLOCKS_Z) return;
+	
+	int4 b = (int4)(block % ACTIVE_BLOCKS_X, (block / ACTIVE_BLOCKS_X) % ACTIVE_BLOCKS_Y, block / (ACTIVE_BLOCKS_X * ACTIVE_BLOCKS_Y), 0);
+	int4 blockSize = (int4)(ACTIVE_BLOCK_SIZE_X, ACTIVE_BLOCK_SIZE_Y, ACTIVE_BLOCK_SIZE_Z, 0);
+	int4 lo = (int4)(0, 0, 0, 0);
+	int4 hi = (int4)(1, 1, 1, 0);
+	for (int n = 0; n < DIM; ++n) {
+		lo[n] = max(2 + b[n] * blockSize[n] - ACTIVE_BLOCKS_MARGIN, 0);
+		hi[n] = min(2 + (b[n] + 1) * blockSize[n] + ACTIVE_BLOCKS_MARGIN, size[n]);
+	}
+
+	bool active = forceActive;
+	for (int z = lo.z; z < hi.z && !active; ++z) {
+		for (int y = lo.y; y < hi.y && !active; ++y) {
+			for (int x = lo.x; x < hi.x && !active; ++x) {
+				int index = INDEX(x, y, z);
+				for (int j = 0; j < NUM_STATES; ++j) {
+					real delta = (real)stateBuffer[j + NUM_STATES * index] - (real)lastStateBuffer[j + NUM_STATES * index];
+					if (!(fabs(delta) <= tolerance)) active = true;	//NaNs count
+				}
+			}
+		}
+	}
+
+	if (active) activeBlocks[atomic_inc(activeCount)] = block;
+}
+
+//cell of this work item, for launches of one local-size work group per active block
+int4 activeBlockCell(const __global int* activeBlocks) {
+	int block = activeBlocks[get_group_id(0)];
+	int4 i = (int4)(get_local_id(0), get_local_id(1), get_local_id(2), 0);
+	i.x += 2 + (block % ACTIVE_BLOCKS_X) * ACTIVE_BLOCK_SIZE_X;
+#if DIM > 1
+	i.y += 2 + ((block / ACTIVE_BLOCKS_X) % ACTIVE_BLOCKS_Y) * ACTIVE_BLOCK_SIZE_Y;
+#endif
+#if DIM > 2
+	i.z += 2 + (block / (ACTIVE_BLOCKS_X * ACTIVE_BLOCKS_Y)) * ACTIVE_BLOCK_SIZE_Z;
+#endif
+	return i;
+}
+#endif	//ACTIVE_BLOCKS
+
+#ifdef LOCAL_TIMESTEP
+/*
+local timestepping (Roe::calcLocalTimesteps)
+each block steps 2^level times the finest dt.  an interface goes at the finer level of its two cells,
+and is due at the substeps that are multiples of 2^level.
+*/
+
+//smallest dt of the cells of each block, for picking the levels
+__kernel void calcBlockTimesteps(
+	__global real* blockTimesteps,
+	const __global real* dtBuffer)
+{
+	int block = get_global_id(0);
+	if (block >= ACTIVE_BLOCKS_X * ACTIVE_BLOCKS_Y * ACTIVE_BLOCKS_Z) return;
+	
+	int4 b = (int4)(block % ACTIVE_BLOCKS_X, (block / ACTIVE_BLOCKS_X) % ACTIVE_BLOCKS_Y, block / (ACTIVE_BLOCKS_X * ACTIVE_BLOCKS_Y), 0);
+	int4 blockSize = (int4)(ACTIVE_BLOCK_SIZE_X, ACTIVE_BLOCK_SIZE_Y, ACTIVE_BLOCK_SIZE_Z, 0);
+	int4 lo = (int4)(0, 0, 0, 0);
+	int4 hi = (int4)(1, 1, 1, 0);
+	for (int n = 0; n < DIM; ++n) {
+		lo[n] = 2 + b[n] * blockSize[n];
+		hi[n] = min(lo[n] + blockSize[n], size[n] - 2);
+	}
+
+	real result = INFINITY;
+	for (int z = lo.z; z < hi.z; ++z) {
+		for (int y = lo.y; y < hi.y; ++y) {
+			for (int x = lo.x; x < hi.x; ++x) {
+				int index = INDEX(x, y, z);
+				for (int side = 0; side < DIM; ++side) {
+					result = min(result, dtBuffer[side + DIM * index]);
+				}
+			}
+		}
+	}
+	blockTimesteps[block] = result;
+}
+
+//level of the block of a cell, with ghost cells in the block next to them
+int cellLevel(const __global int* blockLevels, int4 i) {
+	int4 b = (int4)(0, 0, 0, 0);
+	b.x = clamp((i.x - 2) / ACTIVE_BLOCK_SIZE_X, 0, ACTIVE_BLOCKS_X - 1);
+#if DIM > 1
+	b.y = clamp((i.y - 2) / ACTIVE_BLOCK_SIZE_Y, 0, ACTIVE_BLOCKS_Y - 1);
+#endif
+#if DIM > 2
+	b.z = clamp((i.z - 2) / ACTIVE_BLOCK_SIZE_Z, 0, ACTIVE_BLOCKS_Z - 1);
+#endif
+	return blockLevels[b.x + ACTIVE_BLOCKS_X * (b.y + ACTIVE_BLOCKS_Y * b.z)];
+}
+
+//level of the interface between cell i and the one before it
+int interfaceLevel(const __global int* blockLevels, int4 i, int side) {
+	int4 iPrev = i;
+	--iPrev[side];
+	return min(cellLevel(blockLevels, iPrev), cellLevel(blockLevels, i));
+}
+
+//2^level for the interfaces due at this substep, 0 for the rest
+real interfaceWeight(const __global int* blockLevels, int4 i, int side, int substep) {
+	int level = interfaceLevel(blockLevels, i, side);
+	return (substep & ((1 << level) - 1)) ? 0. : (real)(1 << level);
+}
+
+/*
+calcFluxDeriv of the interfaces due at this substep, times 2^level so the finest dt the integrator uses becomes their own.
+both cells of an interface see the same flux and dt, so the coarse side of a level interface takes the fine fluxes as they happen
+(what a flux register would have corrected it by) and the sum of the states is kept.
+*/
+__kernel void calcLocalFluxDeriv(
+	__global real_storage* derivBuffer,
+	const __global real_storage* fluxBuffer,
+	const __global int* blockLevels,
+	int substep
+#ifdef SOLID
+	, const __global solid_t* solidBuffer
+#endif	//SOLID
+)
+{
+	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X - 2 
+#if DIM > 1
+		|| i.y >= SIZE_Y - 2 
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z - 2
+#endif
+	) {
+		return;
+	}
+	int index = INDEXV(i);
+	__global real_storage* deriv = derivBuffer + NUM_STATES * index;
+
+#ifdef SOLID
+	if (isSolid(solidBuffer, index)) {
+		clearDeriv(deriv);
+		return;
+	}
+#endif	//SOLID
+
+	real weight[DIM];
+	real weightNext[DIM];
+	for (int side = 0; side < DIM; ++side) {
+		int4 iNext = i;
+		++iNext[side];
+		weight[side] = interfaceWeight(blockLevels, i, side, substep);
+		weightNext[side] = interfaceWeight(blockLevels, iNext, side, substep);
+	}
+
+	for (int j = 0; j < NUM_FLUX_STATES; ++j) {
+		real sum = 0.;
+		for (int side = 0; side < DIM; ++side) {
+			int interfaceIndex = INTERFACE_INDEX(side, index);
+			int interfaceIndexNext = INTERFACE_INDEX(side, index + stepsize[side]);
+			real deltaFlux = weightNext[side] * fluxBuffer[j + NUM_FLUX_STATES * interfaceIndexNext] - weight[side] * fluxBuffer[j + NUM_FLUX_STATES * interfaceIndex];
+			sum -= deltaFlux / dx[side];
+		}
+		addDeriv(deriv[j], sum);
+	}
+#ifdef DERIV_OVERWRITE
+	for (int j = NUM_FLUX_STATES; j < NUM_STATES; ++j) {
+		deriv[j] = 0;
+	}
+#endif	//DERIV_OVERWRITE
+}
+#endif	//LOCAL_TIMESTEP
+
 void calcDeltaQTildeSide(
 	__global real* deltaQTildeBuffer,
 	const __global real* eigenvectorsBuffer,
-	const __global real* stateBuffer,
+	const __global real_storage* stateBuffer,
 	int side
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
 );
 
 void calcDeltaQTildeSide(
 	__global real* deltaQTildeBuffer,
 	const __global real* eigenvectorsBuffer,
-	const __global real* stateBuffer,
+	const __global real_storage* stateBuffer,
 	int side
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
 )
 {
+#if defined(ACTIVE_BLOCKS)
+	int4 i = activeBlockCell(activeBlocks);
+#elif defined(FLUID_DISPATCH)
+	int4 i = fluidListCell(fluidList);
+#else
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+#endif
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	
 	int index = INDEXV(i);
 	int indexPrev = index - stepsize[side];
-	int interfaceIndex = side + DIM * index;
+	int interfaceIndex = INTERFACE_INDEX(side, index);
 	
-	const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
+	const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * EIGEN_INTERFACE_INDEX(side, index);
 	__global real* deltaQTilde = deltaQTildeBuffer + EIGEN_SPACE_DIM * interfaceIndex;
 	
 	real stateL[NUM_STATES];
 	real stateR[NUM_STATES];
+#ifdef BOUNDARY_REMAP
+	int4 iPrev = i;
+	--iPrev[side];
+	readStateRemapped(stateL, stateBuffer, iPrev, boundaryMethods);
+	readStateRemapped(stateR, stateBuffer, i, boundaryMethods);
+#else	//BOUNDARY_REMAP
 	for (int i = 0; i < NUM_STATES; ++i) {
 		stateL[i] = stateBuffer[i + NUM_STATES * indexPrev];
 		stateR[i] = stateBuffer[i + NUM_STATES * index];
 	}
+#endif	//BOUNDARY_REMAP
 #ifdef SOLID
-	char solidL = solidBuffer[indexPrev];
-	char solidR = solidBuffer[index];
+	char solidL = isSolid(solidBuffer, indexPrev);
+	char solidR = isSolid(solidBuffer, index);
 	if (solidL && !solidR) {
 		for (int i = 0; i < NUM_STATES; ++i) {
 			stateL[i] = stateR[i];
@@ -152,58 +375,115 @@ void calcDeltaQTildeSide(
 __kernel void calcDeltaQTilde(
 	__global real* deltaQTildeBuffer,
 	const __global real* eigenvectorsBuffer,
-	const __global real* stateBuffer
+	const __global real_storage* stateBuffer
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
+#ifdef DIMENSIONAL_SPLIT
+	, int splitSide
+#endif	//DIMENSIONAL_SPLIT
 )
 {
-	for (int side = 0; side < DIM; ++side) {
+	for (int side = SIDE_BEGIN; side < SIDE_END; ++side) {
 		calcDeltaQTildeSide(deltaQTildeBuffer, eigenvectorsBuffer, stateBuffer, side
 #ifdef SOLID
 			, solidBuffer
+#endif
+#ifdef ACTIVE_BLOCKS
+			, activeBlocks
+#endif
+#ifdef FLUID_DISPATCH
+			, fluidList
+#endif
+#ifdef BOUNDARY_REMAP
+			, boundaryMethods
 #endif
 		);
 	}
 }
 
 void calcFluxSide(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
 	const __global real* eigenvectorsBuffer,
 	const __global real* deltaQTildeBuffer,
 	real dt,
+	int limiter,
 	int side
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef LOCAL_TIMESTEP
+	, const __global int* blockLevels
+#endif	//LOCAL_TIMESTEP
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
 );
 
 void calcFluxSide(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
 	const __global real* eigenvectorsBuffer,
 	const __global real* deltaQTildeBuffer,
 	real dt,
+	int limiter,
 	int side
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef LOCAL_TIMESTEP
+	, const __global int* blockLevels
+#endif	//LOCAL_TIMESTEP
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
 )
 {
+#if defined(ACTIVE_BLOCKS)
+	int4 i = activeBlockCell(activeBlocks);
+#elif defined(FLUID_DISPATCH)
+	int4 i = fluidListCell(fluidList);
+#else
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+#endif
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	
 	real dt_dx = dt / dx[side];
+#ifdef LOCAL_TIMESTEP
+	//the interface's own dt, for the limiter
+	dt_dx *= (real)(1 << interfaceLevel(blockLevels, i, side));
+#endif	//LOCAL_TIMESTEP
 
 	int index = INDEXV(i);
 	int indexR = index;	
@@ -211,30 +491,37 @@ void calcFluxSide(
 	int indexL = index - stepsize[side];
 	int indexR2 = indexR + stepsize[side];
 
-	int interfaceLIndex = side + DIM * indexL;
-	int interfaceIndex = side + DIM * indexR;
-	int interfaceRIndex = side + DIM * indexR2;
+	int interfaceLIndex = INTERFACE_INDEX(side, indexL);
+	int interfaceIndex = INTERFACE_INDEX(side, indexR);
+	int interfaceRIndex = INTERFACE_INDEX(side, indexR2);
 	
 	const __global real* deltaQTildeL = deltaQTildeBuffer + EIGEN_SPACE_DIM * interfaceLIndex;
 	const __global real* deltaQTilde = deltaQTildeBuffer + EIGEN_SPACE_DIM * interfaceIndex;
 	const __global real* deltaQTildeR = deltaQTildeBuffer + EIGEN_SPACE_DIM * interfaceRIndex;
 	
-	const __global real* eigenvalues = eigenvaluesBuffer + EIGEN_SPACE_DIM * interfaceIndex;
-	const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * interfaceIndex;
-	__global real* flux = fluxBuffer + NUM_FLUX_STATES * interfaceIndex;
+	const __global real* eigenvalues = eigenvaluesBuffer + EIGEN_SPACE_DIM * EIGEN_INTERFACE_INDEX(side, indexR);
+	const __global real* eigenvectors = eigenvectorsBuffer + EIGEN_TRANSFORM_STRUCT_SIZE * EIGEN_INTERFACE_INDEX(side, indexR);
+	__global real_storage* flux = fluxBuffer + NUM_FLUX_STATES * interfaceIndex;
 
 	real stateL[NUM_STATES];
+	real stateR[NUM_STATES];
+#ifdef BOUNDARY_REMAP
+	int4 iL = i;
+	--iL[side];
+	readStateRemapped(stateL, stateBuffer, iL, boundaryMethods);
+	readStateRemapped(stateR, stateBuffer, i, boundaryMethods);
+#else	//BOUNDARY_REMAP
 	for (int i = 0; i < NUM_STATES; ++i) {
 		stateL[i] = stateBuffer[i + NUM_STATES * indexL];
 	}
-	real stateR[NUM_STATES];
 	for (int i = 0; i < NUM_STATES; ++i) {
 		stateR[i] = stateBuffer[i + NUM_STATES * indexR];
 	}
+#endif	//BOUNDARY_REMAP
 #ifdef SOLID
 	int indexL2 = indexL - stepsize[side];
-	char solidL = solidBuffer[indexL];
-	char solidR = solidBuffer[indexR];
+	char solidL = isSolid(solidBuffer, indexL);
+	char solidR = isSolid(solidBuffer, indexR);
 	if (solidL && !solidR) {
 		for (int i = 0; i < NUM_STATES; ++i) {
 			stateL[i] = stateR[i];
@@ -246,8 +533,8 @@ void calcFluxSide(
 		}
 		stateR[side+STATE_MOMENTUM_X] = -stateR[side+STATE_MOMENTUM_X];
 	}
-	char solidL2 = solidBuffer[indexL2];
-	char solidR2 = solidBuffer[indexR2];
+	char solidL2 = isSolid(solidBuffer, indexL2);
+	char solidR2 = isSolid(solidBuffer, indexR2);
 #endif	//SOLID
 
 	real fluxTilde[EIGEN_SPACE_DIM];
@@ -288,7 +575,7 @@ void calcFluxSide(
 			if (solidR2) rTilde = 1.;
 #endif	//SOLID
 		}
-		real phi = slopeLimiter(rTilde);
+		real phi = slopeLimiter(rTilde, limiter);
 		real epsilon = eigenvalue * dt_dx;
 
 		real deltaFluxTilde = eigenvalue * deltaQTilde[i];
@@ -299,21 +586,49 @@ void calcFluxSide(
 }
 
 __kernel void calcFlux(
-	__global real* fluxBuffer,
-	const __global real* stateBuffer,
+	__global real_storage* fluxBuffer,
+	const __global real_storage* stateBuffer,
 	const __global real* eigenvaluesBuffer,
 	const __global real* eigenvectorsBuffer,
 	const __global real* deltaQTildeBuffer,
-	real dt
+	real dt,
+	int limiter
 #ifdef SOLID
-	, const __global char* solidBuffer
+	, const __global solid_t* solidBuffer
 #endif	//SOLID
+#ifdef ACTIVE_BLOCKS
+	, const __global int* activeBlocks
+#endif	//ACTIVE_BLOCKS
+#ifdef LOCAL_TIMESTEP
+	, const __global int* blockLevels
+#endif	//LOCAL_TIMESTEP
+#ifdef FLUID_DISPATCH
+	, const __global int* fluidList
+#endif	//FLUID_DISPATCH
+#ifdef BOUNDARY_REMAP
+	, __constant int* boundaryMethods
+#endif	//BOUNDARY_REMAP
+#ifdef DIMENSIONAL_SPLIT
+	, int splitSide
+#endif	//DIMENSIONAL_SPLIT
 )
 {
-	for (int side = 0; side < DIM; ++side) {
-		calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, eigenvectorsBuffer, deltaQTildeBuffer, dt, side
+	for (int side = SIDE_BEGIN; side < SIDE_END; ++side) {
+		calcFluxSide(fluxBuffer, stateBuffer, eigenvaluesBuffer, eigenvectorsBuffer, deltaQTildeBuffer, dt, limiter, side
 #ifdef SOLID
 			, solidBuffer
+#endif
+#ifdef ACTIVE_BLOCKS
+			, activeBlocks
+#endif
+#ifdef LOCAL_TIMESTEP
+			, blockLevels
+#endif
+#ifdef FLUID_DISPATCH
+			, fluidList
+#endif
+#ifdef BOUNDARY_REMAP
+			, boundaryMethods
 #endif
 		);
 	}
@@ -35,12 +35,12 @@ void stateMatrixTransform_G_(
 // same as above but with global, global, local parameters
 
 void stateMatrixTransformGG_(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* matrix,
 	const real* input);
 
 void stateMatrixTransformGG_(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* matrix,
 	const real* input)
 {
@@ -65,7 +65,7 @@ void leftEigenvectorTransform(
 }
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvector,
 	const real* input,
 	int side)
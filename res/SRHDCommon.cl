@@ -26,6 +26,14 @@ __kernel void initVariables(
 	__global real* primitiveBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X
+#if DIM > 1
+		|| i.y >= SIZE_Y
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z
+#endif
+	) return;
 	int index = INDEXV(i);
 
 	__global real* state = stateBuffer + NUM_STATES * index;
@@ -95,6 +103,14 @@ __kernel void constrainState(
 	__global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	if (i.x >= SIZE_X
+#if DIM > 1
+		|| i.y >= SIZE_Y
+#endif
+#if DIM > 2
+		|| i.z >= SIZE_Z
+#endif
+	) return;
 	int index = INDEXV(i);
 	__global real* state = stateBuffer + NUM_STATES * index;
 	
@@ -115,12 +131,12 @@ __kernel void updatePrimitives(
 	const __global real* stateBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 1 
+	if (i.x >= SIZE_X - 1 
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 1
+		|| i.y >= SIZE_Y - 1
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 1
+		|| i.z >= SIZE_Z - 1
 #endif
 	) return;
 	
@@ -291,10 +307,13 @@ __kernel void updateVectorField(
 	real scale,
 	int displayMethod,
 	const __global real* stateBuffer,
-	const __global real* primitiveBuffer)
+	const __global real* primitiveBuffer,
+	int resolution)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	int4 size = (int4)(get_global_size(0), get_global_size(1), get_global_size(2), 0);	
+	//launched padded to the local size, so the field size is passed in
+	int4 size = (int4)(resolution, DIM > 1 ? resolution : 1, DIM > 2 ? resolution : 1, 0);
+	if (i.x >= size.x || i.y >= size.y || i.z >= size.z) return;
 	int vertexIndex = i.x + size.x * (i.y + size.y * i.z);
 	__global float* vertex = vectorFieldVertexBuffer + 6 * 3 * vertexIndex;
 	
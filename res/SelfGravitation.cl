@@ -18,16 +18,17 @@ phi_i := (b_i - sum_j (a_ij phi_j) / a_ii), j != i
 
 */
 __kernel void gravityPotentialPoissonRelax(
-	__global real* gravityPotentialBuffer,
-	const __global real* stateBuffer)
+	__global real_storage* gravityPotentialBuffer,
+	const __global real_storage* stateBuffer,
+	__constant Defs* defs)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
-	if (i.x < 2 || i.x >= SIZE_X - 2
+	if (i.x >= SIZE_X - 2
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2
+		|| i.y >= SIZE_Y - 2
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
@@ -63,26 +64,27 @@ __kernel void gravityPotentialPoissonRelax(
 }
 
 __kernel void calcGravityDeriv(
-	__global real* derivBuffer,
-	const __global real* stateBuffer,
-	const __global real* gravityPotentialBuffer)
+	__global real_storage* derivBuffer,
+	const __global real_storage* stateBuffer,
+	const __global real_storage* gravityPotentialBuffer)
 {
 	int4 i = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
 	int index = INDEXV(i);
-	__global real* deriv = derivBuffer + NUM_STATES * index;
+	__global real_storage* deriv = derivBuffer + NUM_STATES * index;
 	
-	if (i.x < 2 || i.x >= SIZE_X - 2
+	if (i.x >= SIZE_X - 2
 #if DIM > 1
-		|| i.y < 2 || i.y >= SIZE_Y - 2
+		|| i.y >= SIZE_Y - 2
 #endif
 #if DIM > 2
-		|| i.z < 2 || i.z >= SIZE_Z - 2
+		|| i.z >= SIZE_Z - 2
 #endif
 	) {
 		return;
 	}
 
-	const __global real* state = stateBuffer + NUM_STATES * index;
+	clearSplitDeriv(deriv);
+	const __global real_storage* state = stateBuffer + NUM_STATES * index;
 
 	real density = state[STATE_DENSITY];
 	real derivEnergyTotal = 0.;
@@ -5,26 +5,27 @@ require 'initConds'	--holds catalog of initial conditions
 
 -- solver variables
 
---slopeLimiterName = 'DonorCell'
---slopeLimiterName = 'LaxWendroff'
---slopeLimiterName = 'BeamWarming'	-- not behaving correctly
---slopeLimiterName = 'Fromm'		-- not behaving correctly
---slopeLimiterName = 'CHARM'
---slopeLimiterName = 'HCUS'
---slopeLimiterName = 'HQUICK'
---slopeLimiterName = 'Koren'
---slopeLimiterName = 'MinMod'
---slopeLimiterName = 'Oshker'
---slopeLimiterName = 'Ospre'
---slopeLimiterName = 'Smart'
---slopeLimiterName = 'Sweby'
---slopeLimiterName = 'UMIST'
---slopeLimiterName = 'VanAlbada1'
---slopeLimiterName = 'VanAlbada2'
---slopeLimiterName = 'VanLeer'		-- not behaving correctly
---slopeLimiterName = 'MonotizedCentral'
-slopeLimiterName = 'Superbee'
---slopeLimiterName = 'BarthJespersen'
+-- all limiters are compiled in.  this picks the starting one, and the gui can switch it while running
+--slopeLimiter = 'DonorCell'
+--slopeLimiter = 'LaxWendroff'
+--slopeLimiter = 'BeamWarming'	-- not behaving correctly
+--slopeLimiter = 'Fromm'		-- not behaving correctly
+--slopeLimiter = 'CHARM'
+--slopeLimiter = 'HCUS'
+--slopeLimiter = 'HQUICK'
+--slopeLimiter = 'Koren'
+--slopeLimiter = 'MinMod'
+--slopeLimiter = 'Oshker'
+--slopeLimiter = 'Ospre'
+--slopeLimiter = 'Smart'
+--slopeLimiter = 'Sweby'
+--slopeLimiter = 'UMIST'
+--slopeLimiter = 'VanAlbada1'
+--slopeLimiter = 'VanAlbada2'
+--slopeLimiter = 'VanLeer'		-- not behaving correctly
+--slopeLimiter = 'MonotizedCentral'
+slopeLimiter = 'Superbee'
+--slopeLimiter = 'BarthJespersen'
 
 integratorName = 'ForwardEuler'
 --integratorName = 'RungeKutta2'
@@ -38,7 +39,19 @@ integratorName = 'ForwardEuler'
 --integratorName = 'RungeKutta3TVD'
 --integratorName = 'RungeKutta4TVD'
 --integratorName = 'RungeKutta4NonTVD'
---integratorName = 'BackwardEulerConjugateGradient'	-- not fully working, experimental only on EulerBurgers
+--integratorName = 'LowStorageRungeKutta3'	-- 2N-storage: one buffer besides the state, whatever the order
+--integratorName = 'LowStorageRungeKutta4'
+--integratorName = 'BogackiShampine32'	-- embedded pairs: steps are error-controlled, capped by the CFL dt, and redone if the error is too big
+--integratorName = 'DormandPrince54'
+--adaptiveTolerance = 1e-6	-- relative error per step for the embedded integrators
+--adaptiveAbsTolerance = 1e-6	-- absolute error per step, for states near zero
+--integratorName = 'BackwardEulerNewtonKrylov'	-- implicit, Jacobian-free Newton-Krylov (BiCGStab).  for stiff problems, where dt can go past the explicit CFL limit with useFixedDT
+--newtonMaxIter = 5	-- Newton iterations per step, and the relative residual they stop at
+--newtonTolerance = 1e-6
+--krylovMaxIter = 20	-- BiCGStab iterations per Newton iteration, and the relative residual they stop at
+--krylovTolerance = 1e-3
+--integratorName = 'IMEXRungeKuttaARS222'	-- implicit-explicit: the ADM and Maxwell sources implicit (a Newton solve per cell), the flux explicit, so dt is up to the wave speeds alone
+--integratorName = 'IMEXRungeKuttaSSP2_222'
 
 useGPU = true			-- = false means use OpenCL for CPU, which is shoddy for my intel card
 --maxFrames = 0			-- enable to automatically pause the solver after this many frames.  useful for comparing solutions.  push 'u' to toggle update pause/play.
@@ -57,6 +70,25 @@ boundaryMethods = {
 	{min='FREEFLOW', max='FREEFLOW'},
 	{min='FREEFLOW', max='FREEFLOW'},
 }
+--usePrimitiveBuffer = true	-- cache per-cell primitives once per stage.  EulerRoe, EulerHLL and EulerHLLC only.
+--temporalBlockSteps = 4	-- with useFixedDT and ForwardEuler, advance 1D/2D EulerRoe and EulerHLL this many steps per launch in local memory tiles.
+--activityMask = true	-- EulerRoe: only recompute eigenbases and fluxes of blocks near cells that changed last step.  no boundaryRemap.
+--activityTolerance = 0	-- state change that counts as activity.  0 only skips blocks that did not change at all.
+--activityMargin = 2	-- cells watched around each block.  2 per integrator stage.
+--localTimestep = true	-- EulerRoe: blocks step at 2^level times the smallest dt, as far as their own dt allows, with conservative fluxes between levels.  ForwardEuler only, not with useFixedDT or activityMask.
+--localTimestepMaxLevel = 3	-- blocks take at most 2^this times the smallest dt.
+--dimensionalSplit = true	-- EulerRoe: Strang split sweeps, x,y,z then z,y,x, keeping the flux and eigenbasis of one side at a time.  not with activityMask or localTimestep.
+--fluidDispatch = true	-- EulerRoe, EulerBurgers: pack solid flags into bits and launch only over fluid cells/interfaces, listed on reset.  not with activityMask.
+--singlePassRHS = true	-- sum gravity, sources and diffusion into the flux deriv and integrate once per step instead of once per operator.  Euler, ADM and Maxwell Roe solvers only.
+--boundaryRemap = true	-- skip filling ghost cells; kernels remap ghost reads onto the interior.  EulerRoe and MaxwellRoe only.
+--sparseEigenTransform = false	-- EulerRoe stores only the distinct eigenbasis entries by default.  set false for the dense transforms.
+--precision = 'mixed'	-- 'double' (default), 'single', 'mixed': float state/flux storage with double arithmetic, or 'half': experimental 16-bit storage.  mixed and half are EulerRoe, EulerHLL and EulerHLLC only.
+--conservationDiagnostic = true	-- print the drift of the summed states each step, and the rounding of the initial upload.  use closed boundaries to isolate the storage error.
+--programCache = false	-- built programs are cached in res/cache/program-<hash>.cl.bin.  delete them freely, they get rebuilt.
+--programCacheDir = 'cache'
+--autotune = true	-- time work group sizes and build options per device/solver/grid size on first use, and keep the fastest in res/autotune.txt.  delete the file to retune.
+--autotuneSteps = 10
+--autotuneTolerance = 1e-5	-- max relative state difference a build option may introduce
 
 -- TODO organize solver/equation variables:
 -- connect them to the GUI maybe?
@@ -68,6 +100,8 @@ useGravity = false
 gaussSeidelMaxIter = 20
 
 -- variables to forward on to OpenCL code 
+-- the Euler solvers pass the numeric ones to their kernels at runtime (editable in the gui, and re-read on reset)
+-- everything else gets them compiled in
 defs = {
 	idealGas_heatCapacityRatio = 1.4,
 	
@@ -2,6 +2,14 @@
 
 #include "HydroGPU/Shared/Common.h"
 
+//offset (in bases) into the eigenvalue and eigenvector buffers of the interface at 'index'
+//linear, constant-coefficient systems only store one basis per side
+#ifdef CONSTANT_EIGENBASIS
+#define EIGEN_INTERFACE_INDEX(side, index)	(side)
+#else
+#define EIGEN_INTERFACE_INDEX(side, index)	INTERFACE_INDEX(side, index)
+#endif
+
 void leftEigenvectorTransform(
 	real* results,
 	const __global real* eigenvectorData,
@@ -9,7 +17,7 @@ void leftEigenvectorTransform(
 	int side);
 
 void rightEigenvectorTransform(
-	__global real* results,
+	__global real_storage* results,
 	const __global real* eigenvectorData,
 	const real* input,
 	int side);
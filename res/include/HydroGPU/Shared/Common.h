@@ -1,6 +1,7 @@
 #pragma once
 
-#if 1	//double
+//the device side picks its precision from the PRECISION_* defines that Solver::getProgramSources puts ahead of this
+#if 1 && !defined(PRECISION_SINGLE)	//double
 
 #ifdef __OPENCL_VERSION__
 #pragma OPENCL EXTENSION cl_khr_fp64 : enable
@@ -52,9 +53,40 @@ typedef cl_float16 real16;
 
 #endif	//single/double
 
+/*
+storage type of the state-shaped buffers (state, flux, derivatives, potential)
+PRECISION_MIXED stores these as float and keeps the arithmetic in double
+PRECISION_HALF (experimental) stores them as half, for capacity-bound runs
+*/
+#ifdef __OPENCL_VERSION__
+#if defined(PRECISION_HALF)
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+typedef half real_storage;
+#elif defined(PRECISION_MIXED)
+typedef float real_storage;
+#else
+typedef real real_storage;
+#endif
+#endif
+
 #ifdef __OPENCL_VERSION__
 #pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable
 #endif
 
 #define INDEX(a,b,c)	((a) + SIZE_X * ((b) + SIZE_Y * (c)))
 #define INDEXV(i)		INDEX((i).x, (i).y, (i).z)
+
+//BackwardEulerNewtonKrylov: the scalars its kernels keep on the device, indexes into its scalarsBuffer
+enum {
+	KRYLOV_RHO,
+	KRYLOV_RHO_PREV,
+	KRYLOV_ALPHA,
+	KRYLOV_OMEGA,
+	KRYLOV_RHAT_V,
+	KRYLOV_T_S,
+	KRYLOV_T_T,
+	KRYLOV_R_R,
+	KRYLOV_U_U,
+	KRYLOV_V_V,
+	NUM_KRYLOV_SCALARS
+};
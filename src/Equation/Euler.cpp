@@ -99,6 +99,7 @@ void Euler::setupConvertToTexKernelArgs(cl::Kernel convertToTexKernel, Solver::S
 	assert(selfGravSolver != nullptr);
 	convertToTexKernel.setArg(3, selfGravSolver->getPotentialBuffer());
 	convertToTexKernel.setArg(4, selfGravSolver->getSolidBuffer());
+	convertToTexKernel.setArg(5, solver->defsBuffer);
 }
 
 void Euler::setupUpdateVectorFieldKernelArgs(cl::Kernel updateVectorFieldKernel, Solver::Solver* solver) {
@@ -66,7 +66,7 @@ void MHD::setupConvertToTexKernelArgs(cl::Kernel convertToTexKernel, Solver::Sol
 
 	Solver::MHDRemoveDivergenceInterface* mhdSolver = dynamic_cast<Solver::MHDRemoveDivergenceInterface*>(solver);
 	assert(mhdSolver != nullptr);
-	convertToTexKernel.setArg(5, mhdSolver->getMagneticFieldDivergenceBuffer());
+	convertToTexKernel.setArg(6, mhdSolver->getMagneticFieldDivergenceBuffer());
 }
 
 }
@@ -16,6 +16,7 @@
 #include "HydroGPU/Solver/ADM1DRoe.h"
 #include "HydroGPU/Solver/ADM3DRoe.h"
 #include "HydroGPU/Solver/BSSNOKRoe.h"
+#include "HydroGPU/Solver/Autotuner.h"
 
 #include "HydroGPU/Equation/Euler.h"
 #include "HydroGPU/Equation/SRHD.h"
@@ -62,6 +63,7 @@ HydroGPUApp::HydroGPUApp()
 : Super()
 , hasGLSharing(false)
 , hasFP64(false)
+, hasFP16(false)
 , gradientTex(GLuint())
 , configFilename("config.lua")
 , solverName("EulerBurgers")
@@ -70,6 +72,7 @@ HydroGPUApp::HydroGPUApp()
 , maxFrames(-1)
 , currentFrame(-1)
 , useFixedDT(false)
+, autotune(false)
 , fixedDT(.001f)
 , cfl(.5f)
 , showHeatMap(true)
@@ -138,6 +141,29 @@ int HydroGPUApp::main(const std::vector<std::string>& args) {
 	return Super::main(args);
 }
 
+HydroGPUApp::SolverPtr HydroGPUApp::createSolver(SolverGenFunc gen) {
+	SolverPtr newSolver = gen();
+	newSolver->init();	//...now that the vtable is in place
+	newSolver->resetState();
+	if (!autotune) return newSolver;
+
+	Solver::Autotuner autotuner(this);
+	std::vector<size_t> localSize;
+	std::string buildOptions;
+	if (autotuner.find(newSolver.get(), localSize, buildOptions)) return newSolver;
+
+	//free this one's buffers before the candidates allocate theirs
+	std::string key = autotuner.getKey(newSolver.get());
+	newSolver.reset();
+	autotuner.tune(gen, key);
+
+	//init picks the results up from the file.  if tuning failed then this is just the default again.
+	newSolver = gen();
+	newSolver->init();
+	newSolver->resetState();
+	return newSolver;
+}
+
 void HydroGPUApp::init() {
 
 	{
@@ -203,6 +229,7 @@ void HydroGPUApp::init() {
 	lua["showTimestep"] >> showTimestep;
 	lua["useFixedDT"] >> useFixedDT;
 	lua["fixedDT"] >> fixedDT;
+	lua["autotune"] >> autotune;
 	lua["cfl"] >> cfl;
 	lua["useGravity"] >> useGravity;
 	lua["gaussSeidelMaxIter"] >> gaussSeidelMaxIter;
@@ -247,6 +274,11 @@ void HydroGPUApp::init() {
 		return std::find(extensions.begin(), extensions.end(), "cl_khr_fp64") != extensions.end();
 	};
 
+	auto checkHasFP16 = [](const cl::Device& device)-> bool {
+		std::vector<std::string> extensions = CLCommon::getExtensions(device);
+		return std::find(extensions.begin(), extensions.end(), "cl_khr_fp16") != extensions.end();
+	};
+
 	clCommon = std::make_shared<CLCommon::CLCommon>(
 		useGPU,
 		/*verbose=*/true,
@@ -277,6 +309,8 @@ void HydroGPUApp::init() {
 std::cout << "hasGLSharing " << hasGLSharing << std::endl; 
 	hasFP64 = checkHasFP64(clCommon->device);
 std::cout << "hasFP64 " << hasFP64 << std::endl;
+	hasFP16 = checkHasFP16(clCommon->device);
+std::cout << "hasFP16 " << hasFP16 << std::endl;
 
 	glEnable(GL_DEPTH_TEST);
 
@@ -334,9 +368,7 @@ std::cout << "hasFP64 " << hasFP64 << std::endl;
 		for (const SolverEqnsPair &p : solverGensForEqns) {
 			for (const SolverGenPair &q : p.generators) {
 				if (q.name == solverName) {
-					solver = q.func();
-					solver->init();	//...now that the vtable is in place
-					solver->resetState();
+					solver = createSolver(q.func);
 					found = true;
 					break;
 				}
@@ -597,14 +629,12 @@ PROFILE_BEGIN_FRAME()
 
 				solverForEqnIndex = 0;
 				std::cout << "setting equation to " << solverGensForEqns[equationIndex].name << std::endl;
-				solver = solverGensForEqns[equationIndex].generators[solverForEqnIndex].func();
-				solver->init();
 				//now we need an initial condition to match the new equation
 				//but the initial conditions are provided in the script
 				//this means (a) definining initial conditions somewhere in the script that the c++ code can see them
 				// to enumerate and provide here in the gui
 				// or (b) defining them in c++, which means faster constructor, but makes symmath more difficult to use
-				solver->resetState();
+				solver = createSolver(solverGensForEqns[equationIndex].generators[solverForEqnIndex].func);
 
 				//regen aux things that depend on the solver
 				plot = std::make_shared<Plot::Plot>(this);
@@ -630,20 +660,18 @@ PROFILE_BEGIN_FRAME()
 			ImGui::Combo("solver", &solverForEqnIndex, solverNamesForEqnCStrs.data(), solverNamesForEqnCStrs.size());
 			if (lastSolverForEqnIndex != solverForEqnIndex) {
 				std::cout << "setting solver to " << solverGensForEqns[equationIndex].generators[solverForEqnIndex].name << std::endl;
-				SolverPtr newSolver = solverGensForEqns[equationIndex].generators[solverForEqnIndex].func();
 				//but are there any solvers that have different #states for matching eqns?
 				//until then ...
-
-				newSolver->init();
-				newSolver->resetState();
+				SolverPtr newSolver = createSolver(solverGensForEqns[equationIndex].generators[solverForEqnIndex].func);
+				newSolver->slopeLimiter = solver->slopeLimiter;
 
 				//copy state memory *here*
 				//if the states don't match then create a mapping according to the equations or something ...
 				//TODO what about aux variables that need to be updated too?  like SRHD?
 				//this is the same question that falls in line with the rk4 integrator push/pop modularity
-				if (solver->numStates() == newSolver->numStates()) {
+				if (solver->numStates() == newSolver->numStates() && solver->storageSize == newSolver->storageSize) {
 					size_t length = solver->numStates() * solver->getVolume();
-					size_t bufferSize = sizeof(real) * length;
+					size_t bufferSize = solver->storageSize * length;
 					clCommon->commands.enqueueCopyBuffer(solver->stateBuffer, newSolver->stateBuffer, 0, 0, bufferSize);
 				}
 				
@@ -673,6 +701,22 @@ PROFILE_BEGIN_FRAME()
 				std::cout << "setting up initial condition " << initCondName << std::endl;
 				lua["initConds"][initCondName]["setup"]();
 			}
+
+			//no rebuild needed, the flux kernels pick it up next step
+			std::vector<const char*> slopeLimiterNamesCStrs = getCStrsFromStrVector(Solver::Solver::slopeLimiterNames);
+			ImGui::Combo("slope limiter", &solver->slopeLimiter, slopeLimiterNamesCStrs.data(), slopeLimiterNamesCStrs.size());
+		}
+
+		if (solver->runtimeDefs && ImGui::CollapsingHeader("defs")) {
+			bool defsChanged = false;
+			for (size_t i = 0; i < solver->defNames.size(); ++i) {
+				float value = solver->defValues[i];
+				if (ImGui::InputFloat(solver->defNames[i].c_str(), &value)) {
+					solver->defValues[i] = value;
+					defsChanged = true;
+				}
+			}
+			if (defsChanged) solver->updateDefs();
 		}
 
 		if (ImGui::CollapsingHeader("boundaries")) {
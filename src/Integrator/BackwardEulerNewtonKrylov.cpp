@@ -0,0 +1,209 @@
+#include "HydroGPU/Integrator/BackwardEulerNewtonKrylov.h"
+#include "HydroGPU/Solver/Solver.h"
+#include "HydroGPU/HydroGPUApp.h"
+#include <algorithm>
+#include <cmath>
+
+namespace HydroGPU {
+namespace Integrator {
+
+/*
+Newton:
+u = u^n
+repeat
+	r = u^n - u + dt L(u) = -F(u)
+	if |r| < newtonTolerance |r_0| break
+	solve J x = r
+	u = u + x
+
+BiCGStab, from x = 0:
+rHat = r, rho = alpha = omega = 1, v = p = 0
+repeat
+	rho' = rHat . r
+	p = r + (rho' / rho) (alpha / omega) (p - omega v)
+	v = J p
+	alpha = rho' / (rHat . v)
+	s = r - alpha v
+	t = J s
+	omega = (t . s) / (t . t)
+	x = x + alpha p + omega s
+	r = s - omega t
+	if |r| < krylovTolerance |r_0| break
+*/
+
+BackwardEulerNewtonKrylov::BackwardEulerNewtonKrylov(HydroGPU::Solver::Solver* solver)
+: Super(solver)
+, newtonMaxIter(5)
+, newtonTolerance(1e-6)
+, krylovMaxIter(20)
+, krylovTolerance(1e-3)
+{
+	solver->app->lua["newtonMaxIter"] >> newtonMaxIter;
+	solver->app->lua["newtonTolerance"] >> newtonTolerance;
+	solver->app->lua["krylovMaxIter"] >> krylovMaxIter;
+	solver->app->lua["krylovTolerance"] >> krylovTolerance;
+
+	int length = solver->numStates() * solver->getVolume();
+	size_t bufferSize = solver->storageSize * length;
+	oldStateBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::oldStateBuffer");
+	uBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::uBuffer");
+	derivUBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::derivUBuffer");
+	derivPerturbedBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::derivPerturbedBuffer");
+	rBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::rBuffer");
+	rHatBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::rHatBuffer");
+	pBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::pBuffer");
+	vBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::vBuffer");
+	tBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::tBuffer");
+	xBuffer = solver->cl.alloc(bufferSize, "BackwardEulerNewtonKrylov::xBuffer");
+	if (solver->derivOverwrite) {
+		solver->cl.zero(derivUBuffer, bufferSize);
+		solver->cl.zero(derivPerturbedBuffer, bufferSize);
+	}
+
+	//the dot products' partial sums, few enough for one work group of reduceScalar to add up
+	size_t l = solver->localSize1d[0];
+	numPartials = std::min<size_t>((length + l - 1) / l, 1024);
+	scalarsBuffer = solver->cl.alloc(solver->realSize * NUM_KRYLOV_SCALARS, "BackwardEulerNewtonKrylov::scalarsBuffer");
+	partialsBuffer = solver->cl.alloc(solver->realSize * numPartials, "BackwardEulerNewtonKrylov::partialsBuffer");
+
+	multAddKernel = cl::Kernel(solver->program, "multAdd");
+	multAddKernel.setArg(4, length);
+
+	dotBufferKernel = cl::Kernel(solver->program, "dotBuffer");
+	dotBufferKernel.setArg(0, partialsBuffer);
+	dotBufferKernel.setArg(3, cl::Local(l * solver->realSize));
+	dotBufferKernel.setArg(4, length);
+
+	reduceScalarKernel = cl::Kernel(solver->program, "reduceScalar");
+	reduceScalarKernel.setArg(0, scalarsBuffer);
+	reduceScalarKernel.setArg(3, partialsBuffer);
+	reduceScalarKernel.setArg(4, (int)numPartials);
+	reduceScalarKernel.setArg(5, cl::Local(l * solver->realSize));
+
+	krylovInitKernel = cl::Kernel(solver->program, "krylovInit");
+	CLCommon::setArgs(krylovInitKernel, scalarsBuffer, rBuffer, rHatBuffer, pBuffer, vBuffer, xBuffer, oldStateBuffer, uBuffer, derivUBuffer);
+	krylovInitKernel.setArg(10, length);
+
+	krylovUpdatePKernel = cl::Kernel(solver->program, "krylovUpdateP");
+	CLCommon::setArgs(krylovUpdatePKernel, pBuffer, rBuffer, vBuffer, scalarsBuffer, length);
+
+	krylovAlphaKernel = cl::Kernel(solver->program, "krylovAlpha");
+	krylovAlphaKernel.setArg(0, scalarsBuffer);
+
+	krylovOmegaKernel = cl::Kernel(solver->program, "krylovOmega");
+	krylovOmegaKernel.setArg(0, scalarsBuffer);
+
+	krylovUpdateSKernel = cl::Kernel(solver->program, "krylovUpdateS");
+	CLCommon::setArgs(krylovUpdateSKernel, rBuffer, vBuffer, scalarsBuffer, length);
+
+	krylovUpdateXRKernel = cl::Kernel(solver->program, "krylovUpdateXR");
+	CLCommon::setArgs(krylovUpdateXRKernel, xBuffer, rBuffer, pBuffer, tBuffer, scalarsBuffer, length);
+
+	krylovPerturbKernel = cl::Kernel(solver->program, "krylovPerturb");
+	CLCommon::setArgs(krylovPerturbKernel, solver->stateBuffer, uBuffer);
+	krylovPerturbKernel.setArg(3, scalarsBuffer);
+	krylovPerturbKernel.setArg(4, length);
+
+	krylovJacobianVectorKernel = cl::Kernel(solver->program, "krylovJacobianVector");
+	krylovJacobianVectorKernel.setArg(2, derivPerturbedBuffer);
+	krylovJacobianVectorKernel.setArg(3, derivUBuffer);
+	krylovJacobianVectorKernel.setArg(4, scalarsBuffer);
+	krylovJacobianVectorKernel.setArg(6, length);
+}
+
+void BackwardEulerNewtonKrylov::enqueue1d(cl::Kernel& kernel) {
+	size_t length = solver->numStates() * solver->getVolume();
+	size_t l = solver->localSize1d[0];
+	solver->commands.enqueueNDRangeKernel(kernel, solver->offset1d, cl::NDRange((length + l - 1) / l * l), solver->localSize1d);
+}
+
+void BackwardEulerNewtonKrylov::dot(cl::Buffer a, cl::Buffer b, int slot, int prevSlot) {
+	dotBufferKernel.setArg(1, a);
+	dotBufferKernel.setArg(2, b);
+	solver->commands.enqueueNDRangeKernel(dotBufferKernel, solver->offset1d, cl::NDRange(numPartials * solver->localSize1d[0]), solver->localSize1d);
+
+	reduceScalarKernel.setArg(1, slot);
+	reduceScalarKernel.setArg(2, prevSlot);
+	solver->commands.enqueueNDRangeKernel(reduceScalarKernel, solver->offset1d, solver->localSize1d, solver->localSize1d);
+}
+
+real BackwardEulerNewtonKrylov::readScalar(int slot) {
+	//the only sync points.  all the scalars are a few bytes, so just read them all
+	real scalars[NUM_KRYLOV_SCALARS];
+	solver->readReals(scalarsBuffer, scalars, NUM_KRYLOV_SCALARS, solver->realSize);
+	return scalars[slot];
+}
+
+void BackwardEulerNewtonKrylov::calcDeriv(cl::Buffer derivBuffer, std::function<void(cl::Buffer)> callback) {
+	if (!solver->derivOverwrite) solver->cl.zero(derivBuffer, solver->storageSize * solver->numStates() * solver->getVolume());
+	callback(derivBuffer);
+}
+
+void BackwardEulerNewtonKrylov::applyJacobian(cl::Buffer result, cl::Buffer v, real dt, std::function<void(cl::Buffer)> callback) {
+	dot(v, v, KRYLOV_V_V);
+
+	//state = u + eps v
+	krylovPerturbKernel.setArg(2, v);
+	enqueue1d(krylovPerturbKernel);
+	calcDeriv(derivPerturbedBuffer, callback);
+
+	krylovJacobianVectorKernel.setArg(0, result);
+	krylovJacobianVectorKernel.setArg(1, v);
+	solver->setRealArg(krylovJacobianVectorKernel, 5, dt);
+	enqueue1d(krylovJacobianVectorKernel);
+}
+
+void BackwardEulerNewtonKrylov::integrate(real dt, std::function<void(cl::Buffer)> callback) {
+	size_t bufferSize = solver->storageSize * solver->numStates() * solver->getVolume();
+
+	solver->commands.enqueueCopyBuffer(solver->stateBuffer, oldStateBuffer, 0, 0, bufferSize);
+	solver->commands.enqueueCopyBuffer(solver->stateBuffer, uBuffer, 0, 0, bufferSize);
+
+	solver->setRealArg(krylovInitKernel, 9, dt);
+
+	real newtonFirstResidual = 0;
+	for (int newtonIter = 0; newtonIter < newtonMaxIter; ++newtonIter) {
+		//the state holds u here.  r = -F(u)
+		calcDeriv(derivUBuffer, callback);
+		enqueue1d(krylovInitKernel);
+
+		dot(rBuffer, rBuffer, KRYLOV_R_R);
+		real newtonResidual = sqrt(readScalar(KRYLOV_R_R));
+		if (newtonIter == 0) newtonFirstResidual = newtonResidual;
+		if (!(newtonResidual > newtonTolerance * newtonFirstResidual)) break;	//and for NaNs, which no more iterations will fix
+
+		dot(uBuffer, uBuffer, KRYLOV_U_U);
+
+		for (int krylovIter = 0; krylovIter < krylovMaxIter; ++krylovIter) {
+			dot(rHatBuffer, rBuffer, KRYLOV_RHO, KRYLOV_RHO_PREV);
+			enqueue1d(krylovUpdatePKernel);
+
+			applyJacobian(vBuffer, pBuffer, dt, callback);
+			dot(rHatBuffer, vBuffer, KRYLOV_RHAT_V);
+			solver->commands.enqueueNDRangeKernel(krylovAlphaKernel, solver->offset1d, cl::NDRange(1), cl::NDRange(1));
+			enqueue1d(krylovUpdateSKernel);
+
+			applyJacobian(tBuffer, rBuffer, dt, callback);
+			dot(tBuffer, rBuffer, KRYLOV_T_S);
+			dot(tBuffer, tBuffer, KRYLOV_T_T);
+			solver->commands.enqueueNDRangeKernel(krylovOmegaKernel, solver->offset1d, cl::NDRange(1), cl::NDRange(1));
+			enqueue1d(krylovUpdateXRKernel);
+
+			dot(rBuffer, rBuffer, KRYLOV_R_R);
+			real krylovResidual = sqrt(readScalar(KRYLOV_R_R));
+			if (!(krylovResidual > krylovTolerance * newtonResidual)) break;
+		}
+
+		//u += x, and back into the state
+		CLCommon::setArgs(multAddKernel, uBuffer, uBuffer, xBuffer);
+		solver->setRealArg(multAddKernel, 3, 1);
+		enqueue1d(multAddKernel);
+		solver->commands.enqueueCopyBuffer(uBuffer, solver->stateBuffer, 0, 0, bufferSize);
+	}
+
+	//the last Jacobian product may have left the state perturbed
+	solver->commands.enqueueCopyBuffer(uBuffer, solver->stateBuffer, 0, 0, bufferSize);
+}
+
+}
+}
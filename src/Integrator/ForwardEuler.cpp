@@ -8,26 +8,29 @@ namespace Integrator {
 ForwardEuler::ForwardEuler(HydroGPU::Solver::Solver* solver) 
 : Super(solver)
 {
-	derivBuffer = solver->cl.alloc(sizeof(real) * solver->numStates() * solver->getVolume(), "ForwardEuler::derivBuffer");
+	derivBuffer = solver->cl.alloc(solver->storageSize * solver->numStates() * solver->getVolume(), "ForwardEuler::derivBuffer");
+	if (solver->derivOverwrite) solver->cl.zero(derivBuffer, solver->storageSize * solver->numStates() * solver->getVolume());
 
 	//put this in parent class of ForwardEuler and RungeKutta4?
 	multAddKernel = cl::Kernel(solver->program, "multAdd");
 	multAddKernel.setArg(0, solver->stateBuffer);
 	multAddKernel.setArg(1, solver->stateBuffer);
 	multAddKernel.setArg(2, derivBuffer);
+	multAddKernel.setArg(4, (int)(solver->numStates() * solver->getVolume()));
 }
 
 void ForwardEuler::integrate(real dt, std::function<void(cl::Buffer)> callback) {
 	int length = solver->getVolume() * solver->numStates();
 	
 	//TODO store globalSize1d in Solver?
-	cl::NDRange globalSize1d(length);
+	size_t l = solver->localSize1d[0];
+	cl::NDRange globalSize1d((length + l - 1) / l * l);
 
-	solver->cl.zero(derivBuffer, length * sizeof(real));
+	if (!solver->derivOverwrite) solver->cl.zero(derivBuffer, length * solver->storageSize);
 
 	callback(derivBuffer);
 
-	multAddKernel.setArg(3, dt);
+	solver->setRealArg(multAddKernel, 3, dt);
 	solver->commands.enqueueNDRangeKernel(multAddKernel, solver->offset1d, globalSize1d, solver->localSize1d);
 }
 
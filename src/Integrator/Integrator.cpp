@@ -8,5 +8,22 @@ Integrator::Integrator(HydroGPU::Solver::Solver* solver_)
 : solver(solver_)
 {}
 
+void Integrator::integrateIMEX(
+	real dt,
+	std::function<void(cl::Buffer)> explicitCallback,
+	std::function<void(cl::Buffer)> sourceCallback,
+	std::function<void(cl::Buffer, real)> implicitCallback)
+{
+	if (solver->singlePassRHS) {
+		integrate(dt, [&](cl::Buffer derivBuffer) {
+			explicitCallback(derivBuffer);
+			sourceCallback(derivBuffer);
+		});
+		return;
+	}
+	integrate(dt, explicitCallback);
+	integrate(dt, sourceCallback);
+}
+
 }
 }
@@ -41,8 +41,10 @@ VectorField::VectorField(std::shared_ptr<HydroGPU::Solver::Solver> solver_, int
 	} else {
 		updateVectorFieldKernel.setArg(0, vertexBufferCL);
 	}
-	updateVectorFieldKernel.setArg(1, scale);
+	solver->setRealArg(updateVectorFieldKernel, 1, scale);
 	updateVectorFieldKernel.setArg(2, variable);
+	//the resolution always goes last, after the equation's buffers
+	updateVectorFieldKernel.setArg(updateVectorFieldKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1, resolution);
 }
 
 VectorField::~VectorField() {
@@ -51,19 +53,25 @@ VectorField::~VectorField() {
 
 void VectorField::display() {
 	//glFlush();
+	//padded up to the local size, which needn't divide the resolution
+	size_t padded[3];
+	for (int n = 0; n < solver->app->dim; ++n) {
+		size_t l = solver->localSize[n];
+		padded[n] = (resolution + l - 1) / l * l;
+	}
 	cl::NDRange global;
 	switch (solver->app->dim) {
 	case 1:
-		global = cl::NDRange(resolution);
+		global = cl::NDRange(padded[0]);
 		break;
 	case 2:
-		global = cl::NDRange(resolution, resolution);
+		global = cl::NDRange(padded[0], padded[1]);
 		break;
 	case 3:
-		global = cl::NDRange(resolution, resolution, resolution);
+		global = cl::NDRange(padded[0], padded[1], padded[2]);
 		break;
 	}
-	updateVectorFieldKernel.setArg(1, scale);
+	solver->setRealArg(updateVectorFieldKernel, 1, scale);
 	updateVectorFieldKernel.setArg(2, variable);	//equation->vectorFieldVars
 	solver->equation->setupUpdateVectorFieldKernelArgs(updateVectorFieldKernel, solver.get());
 	
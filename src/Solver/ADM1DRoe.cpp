@@ -14,11 +14,15 @@ void ADM1DRoe::initKernels() {
 	
 	addSourceKernel = cl::Kernel(program, "addSource");
 	addSourceKernel.setArg(1, stateBuffer);
+
+	implicitSourceKernel = cl::Kernel(program, "implicitSource");
+	implicitSourceKernel.setArg(1, stateBuffer);
 }
 
 std::vector<std::string> ADM1DRoe::getProgramSources() {
 	std::vector<std::string> sources = Super::getProgramSources();
 	sources.push_back("#include \"ADM1DRoe.cl\"\n");
+	sources.push_back("#include \"ImplicitSource.cl\"\n");
 	return sources;
 }
 
@@ -31,15 +35,11 @@ std::vector<std::string> ADM1DRoe::getEigenProgramSources() {
 }
 
 void ADM1DRoe::step(real dt) {
-	Super::step(dt);
-
 	//before I was adding sources into deriv computed by Roe flux
 	// now I'm separating the Roe flux deriv per-side (so it is truly separable)
 	// but in order to not scale the source by the dim, I have to integrate this separately (or divide by dim maybe?)
-	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		addSourceKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(addSourceKernel, offsetNd, globalSize, localSize);
-	});
+	// (or with an IMEX integrator, together with the flux but implicitly)
+	stepWithSource(dt, addSourceKernel, implicitSourceKernel);
 }
 
 }
@@ -11,10 +11,22 @@ void ADM3DRoe::createEquation() {
 
 void ADM3DRoe::initKernels() {
 	Super::initKernels();
+
+	//swap in the block-decomposed versions, which skip the zero-speed fields
+	//Roe::init and Roe::calcFlux set the rest of the calcFlux args
+	calcDeltaQTildeKernel = cl::Kernel(program, "calcWaveDeltaQTilde");
+	CLCommon::setArgs(calcDeltaQTildeKernel, deltaQTildeBuffer, eigenvectorsBuffer, stateBuffer);
+	
+	calcFluxKernel = cl::Kernel(program, "calcWaveFlux");
+	calcFluxKernel.setArg(0, fluxBuffer);
+	calcFluxKernel.setArg(1, stateBuffer);
 	
 	addSourceKernel = cl::Kernel(program, "addSource");
 	addSourceKernel.setArg(1, stateBuffer);
 
+	implicitSourceKernel = cl::Kernel(program, "implicitSource");
+	implicitSourceKernel.setArg(1, stateBuffer);
+
 	constrainKernel = cl::Kernel(program, "constrain");
 	constrainKernel.setArg(0, stateBuffer);
 }
@@ -22,6 +34,7 @@ void ADM3DRoe::initKernels() {
 std::vector<std::string> ADM3DRoe::getProgramSources() {
 	std::vector<std::string> sources = Super::getProgramSources();
 	sources.push_back("#include \"ADM3DRoe.cl\"\n");
+	sources.push_back("#include \"ImplicitSource.cl\"\n");
 	return sources;
 }
 
@@ -45,7 +58,7 @@ void ADM3DRoe::step(real dt) {
 #if 0
 //debug output
 std::vector<real> stateVec(numStates() * getVolume());
-commands.enqueueReadBuffer(stateBuffer, CL_TRUE, 0, sizeof(real) * numStates() * getVolume(), stateVec.data());
+readReals(stateBuffer, stateVec.data(), numStates() * getVolume(), storageSize);
 for (int i = 0; i < getVolume(); ++i) {
 	for (int j = 0; j < numStates(); ++j) {
 		printf("\t%f", stateVec[j + numStates() * i]);
@@ -54,16 +67,11 @@ for (int i = 0; i < getVolume(); ++i) {
 #endif
 
 	//advect
-	Super::step(dt);
-
 	//see ADM1DRoe::step() for my thoughts on source and separabe integration
 	//in fact, now that this is separated, it doesn't seem to be as stable ...
-	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		addSourceKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(addSourceKernel, offsetNd, globalSize, localSize);
-	});
+	stepWithSource(dt, addSourceKernel, implicitSourceKernel);
 
-	commands.enqueueNDRangeKernel(constrainKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(constrainKernel, offsetInterior, globalSizeInterior, localSize);
 }
 
 }
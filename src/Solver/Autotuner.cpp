@@ -0,0 +1,203 @@
+#include "HydroGPU/Solver/Autotuner.h"
+#include "HydroGPU/Solver/Solver.h"
+#include "HydroGPU/HydroGPUApp.h"
+#include "Common/File.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace HydroGPU {
+namespace Solver {
+
+static std::vector<std::string> split(const std::string& str, char delim) {
+	std::vector<std::string> results;
+	std::istringstream ss(str);
+	std::string part;
+	while (std::getline(ss, part, delim)) results.push_back(part);
+	return results;
+}
+
+static std::string sizesToString(const std::vector<size_t>& sizes) {
+	std::ostringstream ss;
+	for (size_t i = 0; i < sizes.size(); ++i) ss << (i ? " " : "") << sizes[i];
+	return ss.str();
+}
+
+Autotuner::Autotuner(HydroGPUApp* app_)
+: app(app_)
+, filename("autotune.txt")
+, numSteps(10)
+, tolerance(1e-5)
+{
+	app->lua["autotuneSteps"] >> numSteps;
+	app->lua["autotuneTolerance"] >> tolerance;
+}
+
+std::string Autotuner::getKey(Solver* solver) {
+	cl::Device device = app->clCommon->device;
+	std::ostringstream ss;
+	ss << device.getInfo<CL_DEVICE_NAME>().c_str()
+		<< " " << device.getInfo<CL_DRIVER_VERSION>().c_str()
+		<< " " << solver->name()
+		<< " " << solver->precision;
+	for (int i = 0; i < app->dim; ++i) ss << " " << app->size.s[i];
+	//tabs and newlines separate the entries
+	std::string key = ss.str();
+	std::replace(key.begin(), key.end(), '\t', ' ');
+	std::replace(key.begin(), key.end(), '\n', ' ');
+	return key;
+}
+
+//file lines are key \t local sizes \t build options
+bool Autotuner::find(Solver* solver, std::vector<size_t>& localSize, std::string& buildOptions) {
+	if (!Common::File::exists(filename)) return false;
+	std::string key = getKey(solver);
+	for (const std::string& line : split(Common::File::read(filename), '\n')) {
+		std::vector<std::string> parts = split(line, '\t');
+		if (parts.size() < 2 || parts[0] != key) continue;
+		localSize.clear();
+		for (const std::string& s : split(parts[1], ' ')) {
+			if (!s.empty()) localSize.push_back(std::stoul(s));
+		}
+		buildOptions = parts.size() > 2 ? parts[2] : std::string();
+		return (int)localSize.size() == app->dim;
+	}
+	return false;
+}
+
+void Autotuner::save(const std::string& key, const std::vector<size_t>& localSize, const std::string& buildOptions) {
+	std::string contents;
+	if (Common::File::exists(filename)) {
+		for (const std::string& line : split(Common::File::read(filename), '\n')) {
+			if (line.empty() || split(line, '\t')[0] == key) continue;
+			contents += line + "\n";
+		}
+	}
+	contents += key + "\t" + sizesToString(localSize) + "\t" + buildOptions + "\n";
+	Common::File::write(filename, contents);
+}
+
+/*
+powers of two, x >= y >= z, with a volume from 32 up to what the device allows
+each no bigger than the next power of two of the grid size.  the solver launches are padded to the local size, and Plot's are over the next power of two, so they needn't divide the grid
+*/
+std::vector<std::vector<size_t>> Autotuner::getLocalSizeCandidates() {
+	cl::Device device = app->clCommon->device;
+	size_t maxWorkGroupSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+	std::vector<size_t> maxWorkItemSizes = device.getInfo<CL_DEVICE_MAX_WORK_ITEM_SIZES>();
+
+	size_t maxSize[3];
+	for (int i = 0; i < 3; ++i) {
+		maxSize[i] = 1;
+		if (i >= app->dim) continue;
+		while (maxSize[i] < (size_t)app->size.s[i]) maxSize[i] <<= 1;
+		maxSize[i] = std::min(maxSize[i], maxWorkItemSizes[i]);
+	}
+
+	std::vector<std::vector<size_t>> candidates;
+	for (size_t x = 1; x <= maxSize[0]; x <<= 1) {
+		for (size_t y = 1; y <= std::min(x, maxSize[1]); y <<= 1) {
+			for (size_t z = 1; z <= std::min(y, maxSize[2]); z <<= 1) {
+				size_t volume = x * y * z;
+				if (volume < 32 || volume > std::min<size_t>(maxWorkGroupSize, 256)) continue;
+				std::vector<size_t> candidate = {x, y, z};
+				candidate.resize(app->dim);
+				candidates.push_back(candidate);
+			}
+		}
+	}
+	return candidates;
+}
+
+double Autotuner::run(SolverGenFunc gen, const std::string& buildOptions, const std::vector<size_t>& localSize, std::vector<real>* result) {
+	std::cout << "autotune: trying local size " << (localSize.empty() ? std::string("default") : sizesToString(localSize))
+		<< " build options '" << buildOptions << "'" << std::endl;
+	try {
+		std::shared_ptr<Solver> solver = gen();
+		solver->tuning = true;
+		solver->tunedLocalSize = localSize;
+		solver->tunedBuildOptions = buildOptions;
+		solver->init();
+		solver->resetState();
+
+		//once untimed, to get any lazy setup out of the way
+		solver->update();
+		solver->commands.finish();
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < numSteps; ++i) {
+			solver->update();
+		}
+		solver->commands.finish();
+		double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		std::cout << "autotune: " << seconds << "s" << std::endl;
+
+		if (result) {
+			result->resize(solver->numStates() * solver->getVolume());
+			solver->readReals(solver->stateBuffer, result->data(), result->size(), solver->storageSize);
+		}
+		return seconds;
+	} catch (std::exception& err) {	//cl::Error or Common::Exception
+		std::cout << "autotune: failed: " << err.what() << std::endl;
+	}
+	return std::numeric_limits<double>::infinity();
+}
+
+void Autotuner::tune(SolverGenFunc gen, const std::string& key) {
+	std::cout << "autotune: tuning " << key << std::endl;
+
+	//the default build is the reference for the others' accuracy
+	std::vector<real> reference;
+	std::string bestOptions;
+	double bestTime = run(gen, bestOptions, std::vector<size_t>(), &reference);
+	if (bestTime == std::numeric_limits<double>::infinity()) {
+		std::cout << "autotune: the default settings failed -- not tuning" << std::endl;
+		return;
+	}
+	real referenceScale = 0;
+	for (real r : reference) referenceScale = std::max<real>(referenceScale, fabs(r));
+	if (referenceScale == 0) referenceScale = 1;
+
+	for (const std::string& options : {std::string("-cl-mad-enable"), std::string("-cl-fast-relaxed-math")}) {
+		std::vector<real> result;
+		double time = run(gen, options, std::vector<size_t>(), &result);
+		if (time >= bestTime) continue;
+
+		real error = 0;
+		for (size_t i = 0; i < result.size(); ++i) {
+			error = std::max<real>(error, fabs(result[i] - reference[i]));
+		}
+		error /= referenceScale;
+		if (!(error <= tolerance)) {	//catches NaNs too
+			std::cout << "autotune: rejecting '" << options << "', relative error " << error << std::endl;
+			continue;
+		}
+		bestTime = time;
+		bestOptions = options;
+	}
+
+	std::vector<size_t> bestLocalSize;
+	for (const std::vector<size_t>& localSize : getLocalSizeCandidates()) {
+		double time = run(gen, bestOptions, localSize, nullptr);
+		if (time >= bestTime) continue;
+		bestTime = time;
+		bestLocalSize = localSize;
+	}
+
+	//keep the default's, but spelled out, so find() has something to return
+	if (bestLocalSize.empty()) {
+		std::shared_ptr<Solver> solver = gen();
+		solver->tuning = true;
+		solver->tunedBuildOptions = bestOptions;
+		solver->init();
+		for (int i = 0; i < app->dim; ++i) bestLocalSize.push_back(solver->localSize[i]);
+	}
+
+	std::cout << "autotune: using local size " << sizesToString(bestLocalSize) << " build options '" << bestOptions << "'" << std::endl;
+	save(key, bestLocalSize, bestOptions);
+}
+
+}
+}
@@ -16,37 +16,64 @@ void EulerBurgers::initBuffers() {
 	
 	int volume = getVolume();
 
-	interfaceVelocityBuffer = cl.alloc(sizeof(real) * volume * app->dim, "EulerBurgers::interfaceVelocityBuffer");
-	pressureBuffer = cl.alloc(sizeof(real) * volume, "EulerBurgers::pressureBuffer");
+	interfaceVelocityBuffer = cl.alloc(realSize * volume * app->dim, "EulerBurgers::interfaceVelocityBuffer");
+	pressureBuffer = cl.alloc(realSize * volume, "EulerBurgers::pressureBuffer");
 
-	cl.zero(interfaceVelocityBuffer, volume * app->dim * sizeof(real));
+	cl.zero(interfaceVelocityBuffer, volume * app->dim * realSize);
 }
 
 void EulerBurgers::initKernels() {
 	Super::initKernels();
 	
+	cl::Buffer solidBuffer = selfgrav->getKernelSolidBuffer();
+
 	calcCellTimestepKernel = cl::Kernel(program, "calcCellTimestep");
-	CLCommon::setArgs(calcCellTimestepKernel, dtBuffer, stateBuffer, selfgrav->potentialBuffer, selfgrav->solidBuffer);
+	CLCommon::setArgs(calcCellTimestepKernel, dtBuffer, stateBuffer, selfgrav->potentialBuffer, defsBuffer, solidBuffer);
 	
 	calcInterfaceVelocityKernel = cl::Kernel(program, "calcInterfaceVelocity");
-	CLCommon::setArgs(calcInterfaceVelocityKernel, interfaceVelocityBuffer, stateBuffer, selfgrav->solidBuffer);
+	CLCommon::setArgs(calcInterfaceVelocityKernel, interfaceVelocityBuffer, stateBuffer, solidBuffer);
 	
 	calcFluxKernel.setArg(2, interfaceVelocityBuffer);
-	calcFluxKernel.setArg(3, selfgrav->solidBuffer);
+	calcFluxKernel.setArg(3, solidBuffer);
 	
-	calcFluxDerivKernel.setArg(2, selfgrav->solidBuffer);
+	calcFluxDerivKernel.setArg(2, solidBuffer);
 	
 	computePressureKernel = cl::Kernel(program, "computePressure");
-	CLCommon::setArgs(computePressureKernel, pressureBuffer, stateBuffer, selfgrav->potentialBuffer, selfgrav->solidBuffer);
+	CLCommon::setArgs(computePressureKernel, pressureBuffer, stateBuffer, selfgrav->potentialBuffer, defsBuffer, solidBuffer);
 	
 	diffuseMomentumKernel = cl::Kernel(program, "diffuseMomentum");
 	diffuseMomentumKernel.setArg(1, pressureBuffer);
-	diffuseMomentumKernel.setArg(2, selfgrav->solidBuffer);
+	diffuseMomentumKernel.setArg(2, solidBuffer);
 	
 	diffuseWorkKernel = cl::Kernel(program, "diffuseWork");
 	diffuseWorkKernel.setArg(1, stateBuffer);
 	diffuseWorkKernel.setArg(2, pressureBuffer);
-	diffuseWorkKernel.setArg(3, selfgrav->solidBuffer);
+	diffuseWorkKernel.setArg(3, solidBuffer);
+
+	if (selfgrav->fluidDispatch) {
+		calcCellTimestepKernel.setArg(5, selfgrav->fluidCellsBuffer);
+		calcInterfaceVelocityKernel.setArg(3, selfgrav->fluidInterfacesBuffer);
+		calcFluxKernel.setArg(6, selfgrav->fluidInterfacesBuffer);
+		calcFluxDerivKernel.setArg(3, selfgrav->fluidCellsBuffer);
+		diffuseMomentumKernel.setArg(3, selfgrav->fluidCellsBuffer);
+		diffuseWorkKernel.setArg(4, selfgrav->fluidCellsBuffer);
+	}
+}
+
+void EulerBurgers::enqueueCellKernel(cl::Kernel& kernel) {
+	if (selfgrav->fluidDispatch) {
+		selfgrav->enqueueFluidCells(kernel);
+	} else {
+		commands.enqueueNDRangeKernel(kernel, offsetInterior, globalSizeInterior, localSize);
+	}
+}
+
+void EulerBurgers::enqueueInterfaceKernel(cl::Kernel& kernel) {
+	if (selfgrav->fluidDispatch) {
+		selfgrav->enqueueFluidInterfaces(kernel);
+	} else {
+		commands.enqueueNDRangeKernel(kernel, offsetInterior, globalSizeInterface, localSize);
+	}
 }
 
 void EulerBurgers::createEquation() {
@@ -61,20 +88,47 @@ std::vector<std::string> EulerBurgers::getProgramSources() {
 }
 
 real EulerBurgers::calcTimestep() {
-	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetNd, globalSize, localSize);
+	enqueueCellKernel(calcCellTimestepKernel);
 
 	return findMinTimestep();
 }
 
 void EulerBurgers::step(real dt) {
+	if (singlePassRHS) {
+		//advection, gravity and both diffusions all into one deriv, so one integration and one boundary
+		integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
+			enqueueInterfaceKernel(calcInterfaceVelocityKernel);
+			
+			setRealArg(calcFluxKernel, 4, dt);
+			calcFluxKernel.setArg(5, slopeLimiter);
+			enqueueInterfaceKernel(calcFluxKernel);
+
+			calcFluxDerivKernel.setArg(0, derivBuffer);
+			enqueueCellKernel(calcFluxDerivKernel);
+
+			selfgrav->calcGravityDeriv(derivBuffer);
+
+			commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSizePadded, localSize);
+
+			diffuseMomentumKernel.setArg(0, derivBuffer);
+			enqueueCellKernel(diffuseMomentumKernel);
+
+			diffuseWorkKernel.setArg(0, derivBuffer);
+			enqueueCellKernel(diffuseWorkKernel);
+		});
+		boundary();
+		return;
+	}
+
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		commands.enqueueNDRangeKernel(calcInterfaceVelocityKernel, offsetNd, globalSize, localSize);
+		enqueueInterfaceKernel(calcInterfaceVelocityKernel);
 		
-		calcFluxKernel.setArg(4, dt);
-		commands.enqueueNDRangeKernel(calcFluxKernel, offsetNd, globalSize, localSize);
+		setRealArg(calcFluxKernel, 4, dt);
+		calcFluxKernel.setArg(5, slopeLimiter);
+		enqueueInterfaceKernel(calcFluxKernel);
 
 		calcFluxDerivKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetNd, globalSize, localSize);
+		enqueueCellKernel(calcFluxDerivKernel);
 	});
 	
 	boundary();
@@ -84,17 +138,17 @@ void EulerBurgers::step(real dt) {
 	//the Hydrodynamics ii paper says it's important to diffuse momentum before work
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
 		
-		commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSizePadded, localSize);
 
 		diffuseMomentumKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(diffuseMomentumKernel, offsetNd, globalSize, localSize);
+		enqueueCellKernel(diffuseMomentumKernel);
 	});
 	boundary();
 
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
 		//computePressureFunc(pressureBuffer, stateBuffer, selfgrav->potentialBuffer, selfgrav->solidBuffer);
 		diffuseWorkKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(diffuseWorkKernel, offsetNd, globalSize, localSize);
+		enqueueCellKernel(diffuseWorkKernel);
 	});
 	boundary();
 }
@@ -10,8 +10,13 @@ void EulerHLL::initKernels() {
 
 	//all Euler and MHD systems also have a separate potential buffer...
 	calcEigenvaluesKernel.setArg(2, selfgrav->potentialBuffer);
+	calcEigenvaluesKernel.setArg(3, defsBuffer);
 	
 	calcFluxKernel.setArg(3, selfgrav->potentialBuffer);
+	calcFluxKernel.setArg(5, defsBuffer);
+	
+	setPrimitiveBufferArg(calcEigenvaluesKernel);
+	setPrimitiveBufferArg(calcFluxKernel);
 }
 
 void EulerHLL::createEquation() {
@@ -22,9 +27,27 @@ std::string EulerHLL::getFluxSource() {
 	return "#include \"EulerHLL.cl\"\n";
 }
 
+void EulerHLL::initStep() {
+	updatePrimitives();
+	Super::initStep();
+}
+
 void EulerHLL::step(real dt) {
-	Super::step(dt);
-	selfgrav->applyPotential(dt);
+	if (!singlePassRHS) {
+		Super::step(dt);
+		selfgrav->applyPotential(dt);
+		return;
+	}
+	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
+		calcDeriv(derivBuffer, dt);
+		selfgrav->calcGravityDeriv(derivBuffer);
+	});
+}
+
+//primitives are needed once per stage by calcFlux
+void EulerHLL::calcDeriv(cl::Buffer derivBuffer, real dt) {
+	updatePrimitives();
+	Super::calcDeriv(derivBuffer, dt);
 }
 
 }
@@ -5,16 +5,42 @@
 namespace HydroGPU {
 namespace Solver {
 
+void EulerRoe::init() {
+	app->lua["sparseEigenTransform"] >> useSparseEigenTransform;
+	Super::init();
+}
+
+void EulerRoe::initBuffers() {
+	Super::initBuffers();
+	//the fluid interface list skips what's deep in the solid, so don't leave the limiter reading garbage there
+	if (selfgrav->fluidDispatch) cl.zero(deltaQTildeBuffer, realSize * getDeltaQTildeDim() * getVolume() * getFluxSides());
+}
+
 void EulerRoe::initKernels() {
 	Super::initKernels();
 	
 	//all Euler and MHD systems also have a separate potential buffer...
 	calcEigenBasisKernel.setArg(3, selfgrav->potentialBuffer);
-	calcEigenBasisKernel.setArg(4, selfgrav->solidBuffer);
-	calcCellTimestepKernel.setArg(2, selfgrav->solidBuffer);
-	calcDeltaQTildeKernel.setArg(3, selfgrav->solidBuffer);
-	calcFluxKernel.setArg(6, selfgrav->solidBuffer);
-	calcFluxDerivKernel.setArg(2, selfgrav->solidBuffer);
+	calcEigenBasisKernel.setArg(4, selfgrav->getKernelSolidBuffer());
+	calcEigenBasisKernel.setArg(5, defsBuffer);
+	calcCellTimestepKernel.setArg(2, selfgrav->getKernelSolidBuffer());
+	calcDeltaQTildeKernel.setArg(3, selfgrav->getKernelSolidBuffer());
+	calcFluxKernel.setArg(7, selfgrav->getKernelSolidBuffer());
+	calcFluxDerivKernel.setArg(2, selfgrav->getKernelSolidBuffer());
+	if (useLocalTimestep) calcLocalFluxDerivKernel.setArg(4, selfgrav->getKernelSolidBuffer());
+	
+	//the optional args after SOLID, in order
+	int eigenBasisArg = 6;
+	if (useActivityMask || useLocalTimestep) calcEigenBasisKernel.setArg(eigenBasisArg++, activeBlocksBuffer);
+	if (selfgrav->fluidDispatch) {
+		calcEigenBasisKernel.setArg(eigenBasisArg++, selfgrav->fluidInterfacesBuffer);
+		calcCellTimestepKernel.setArg(3, selfgrav->fluidCellsBuffer);
+		calcDeltaQTildeKernel.setArg(4, selfgrav->fluidInterfacesBuffer);
+		calcFluxKernel.setArg(8, selfgrav->fluidInterfacesBuffer);
+		calcFluxDerivKernel.setArg(3, selfgrav->fluidCellsBuffer);
+	}
+	if (boundaryRemap) calcEigenBasisKernel.setArg(eigenBasisArg++, boundaryMethodsBuffer);
+	if (usePrimitiveBuffer) calcEigenBasisKernel.setArg(eigenBasisArg++, primitiveBuffer);	//then the dimensionalSplit side
 }
 
 void EulerRoe::createEquation() {
@@ -28,9 +54,99 @@ std::vector<std::string> EulerRoe::getProgramSources() {
 	return sources;
 }
 	
+void EulerRoe::enqueueInterfaceKernel(cl::Kernel& kernel) {
+	if (selfgrav->fluidDispatch) {
+		selfgrav->enqueueFluidInterfaces(kernel);
+	} else {
+		Super::enqueueInterfaceKernel(kernel);
+	}
+}
+
+void EulerRoe::enqueueCellKernel(cl::Kernel& kernel) {
+	if (selfgrav->fluidDispatch) {
+		selfgrav->enqueueFluidCells(kernel);
+	} else {
+		Super::enqueueCellKernel(kernel);
+	}
+}
+
+void EulerRoe::initStep() {
+	//the potential changes everywhere each step, and the eigenbasis reads it
+	if (app->useGravity) activityReset = true;
+	Super::initStep();
+}
+
+void EulerRoe::initFlux() {
+	updatePrimitives();
+	Super::initFlux();
+}
+
+/*
+pattern of the side 0 basis in EulerRoe.cl
+the acoustic rows of the inverse share their transverse and energy columns,
+and the tangent rows of the inverse reuse the transverse velocities of the eigenvectors
+*/
+std::shared_ptr<SparseEigenTransform> EulerRoe::getSparseEigenTransform() {
+	if (!useSparseEigenTransform) return nullptr;
+	
+	int dim = app->dim;
+	int n = dim + 2;
+	std::shared_ptr<SparseEigenTransform> sparse = std::make_shared<SparseEigenTransform>(n);
+	sparse->rotatedVectors = {1};	//momentum
+	
+	std::vector<std::string>& r = sparse->right;
+	std::vector<std::string>& l = sparse->left;
+	const char* tangents[2] = {"vy", "vz"};
+	
+	//min, normal, and max columns
+	const char* normalSpeeds[3] = {"vxMinusC", "vx", "vxPlusC"};
+	const char* energies[3] = {"enthalpyMinusCVx", "halfVelocitySq", "enthalpyPlusCVx"};
+	for (int k = 0; k < 3; ++k) {
+		int j = k == 0 ? 0 : (k == 1 ? 1 : n-1);
+		r[0 + n * j] = "1";
+		r[1 + n * j] = normalSpeeds[k];
+		for (int t = 0; t < dim-1; ++t) r[2+t + n * j] = tangents[t];
+		r[n-1 + n * j] = energies[k];
+	}
+	//tangent columns
+	for (int t = 0; t < dim-1; ++t) {
+		r[2+t + n * (2+t)] = "1";
+		r[n-1 + n * (2+t)] = tangents[t];
+	}
+	
+	//min and max rows
+	for (int k = 0; k < 2; ++k) {
+		int i = k == 0 ? 0 : n-1;
+		std::string prefix = k == 0 ? "invMin" : "invMax";
+		l[i + n * 0] = prefix + "Density";
+		l[i + n * 1] = prefix + "MomentumX";
+		for (int t = 0; t < dim-1; ++t) l[i + n * (2+t)] = std::string("invAcoustic_") + tangents[t];
+		l[i + n * (n-1)] = "invAcousticEnergy";
+	}
+	//normal row
+	l[1 + n * 0] = "invNormalDensity";
+	l[1 + n * 1] = "invNormalMomentumX";
+	for (int t = 0; t < dim-1; ++t) l[1 + n * (2+t)] = std::string("invNormal_") + tangents[t];
+	l[1 + n * (n-1)] = "invNormalEnergy";
+	//tangent rows
+	for (int t = 0; t < dim-1; ++t) {
+		l[2+t + n * 0] = std::string("-") + tangents[t];
+		l[2+t + n * (2+t)] = "1";
+	}
+
+	return sparse;
+}
+
 void EulerRoe::step(real dt) {
-	Super::step(dt);
-	selfgrav->applyPotential(dt);
+	if (!singlePassRHS) {
+		Super::step(dt);
+		selfgrav->applyPotential(dt);
+		return;
+	}
+	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
+		calcDeriv(derivBuffer, dt);
+		selfgrav->calcGravityDeriv(derivBuffer);
+	});
 }
 
 }
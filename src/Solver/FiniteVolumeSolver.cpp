@@ -10,8 +10,12 @@ FiniteVolumeSolver::FiniteVolumeSolver(HydroGPUApp* app_)
 void FiniteVolumeSolver::initBuffers() {
 	Super::initBuffers();
 	
-	fluxBuffer = cl.alloc(sizeof(real) * getNumFluxStates() * getVolume() * app->dim, "FiniteVolumeSolver::fluxBuffer");
-	cl.zero(fluxBuffer, getNumFluxStates() * getVolume() * app->dim * sizeof(real));
+	fluxBuffer = cl.alloc(storageSize * getNumFluxStates() * getVolume() * getFluxSides(), "FiniteVolumeSolver::fluxBuffer");
+	cl.zero(fluxBuffer, getNumFluxStates() * getVolume() * getFluxSides() * storageSize);
+}
+
+int FiniteVolumeSolver::getFluxSides() {
+	return app->dim;
 }
 
 void FiniteVolumeSolver::initKernels() {
@@ -7,7 +7,7 @@ namespace Solver {
 void HLL::initBuffers() {
 	Super::initBuffers();
 
-	eigenvaluesBuffer = cl.alloc(sizeof(real) * numStates() * getVolume() * app->dim);
+	eigenvaluesBuffer = cl.alloc(realSize * numStates() * getVolume() * app->dim);
 }
 
 void HLL::initKernels() {
@@ -29,22 +29,26 @@ std::vector<std::string> HLL::getProgramSources() {
 }
 
 void HLL::initStep() {
-	commands.enqueueNDRangeKernel(calcEigenvaluesKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(calcEigenvaluesKernel, offsetInterior, globalSizeInterface, localSize);
 }
 
 real HLL::calcTimestep() {
-	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetInterior, globalSizeInterface, localSize);
 	return findMinTimestep();	
 }
 
 void HLL::step(real dt) {
-	calcFluxKernel.setArg(4, dt);
+	setRealArg(calcFluxKernel, 4, dt);
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		commands.enqueueNDRangeKernel(calcFluxKernel, offsetNd, globalSize, localSize);
-		calcFluxDerivKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetNd, globalSize, localSize);
+		calcDeriv(derivBuffer, dt);
 	});
 }
 
+void HLL::calcDeriv(cl::Buffer derivBuffer, real dt) {
+	commands.enqueueNDRangeKernel(calcFluxKernel, offsetInterior, globalSizeInterface, localSize);
+	calcFluxDerivKernel.setArg(0, derivBuffer);
+	commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetInterior, globalSizeInterior, localSize);
+}
+
 }
 }
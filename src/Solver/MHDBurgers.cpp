@@ -10,12 +10,12 @@ void MHDBurgers::initBuffers() {
 
 	int volume = getVolume();
 
-	interfaceVelocityBuffer = cl.alloc(sizeof(real) * volume * app->dim);
-	interfaceMagneticFieldBuffer = cl.alloc(sizeof(real) * volume * app->dim);
-	pressureBuffer = cl.alloc(sizeof(real) * volume);
+	interfaceVelocityBuffer = cl.alloc(realSize * volume * app->dim);
+	interfaceMagneticFieldBuffer = cl.alloc(realSize * volume * app->dim);
+	pressureBuffer = cl.alloc(realSize * volume);
 
-	cl.zero(interfaceVelocityBuffer, volume * app->dim * sizeof(real));
-	cl.zero(interfaceMagneticFieldBuffer, volume * app->dim * sizeof(real));
+	cl.zero(interfaceVelocityBuffer, volume * app->dim * realSize);
+	cl.zero(interfaceMagneticFieldBuffer, volume * app->dim * realSize);
 }
 
 void MHDBurgers::initKernels() {
@@ -58,7 +58,7 @@ std::vector<std::string> MHDBurgers::getProgramSources() {
 }
 
 real MHDBurgers::calcTimestep() {
-	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetInterior, globalSizeInterior, localSize);
 	return findMinTimestep();	
 }
 
@@ -74,23 +74,25 @@ void MHDBurgers::step(real dt) {
 }
 
 void MHDBurgers::advectVelocity(real dt) {
-	calcVelocityFluxKernel.setArg(3, dt);
+	setRealArg(calcVelocityFluxKernel, 3, dt);
+	calcVelocityFluxKernel.setArg(4, slopeLimiter);
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		commands.enqueueNDRangeKernel(calcInterfaceVelocityKernel, offsetNd, globalSize, localSize);
-		commands.enqueueNDRangeKernel(calcVelocityFluxKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(calcInterfaceVelocityKernel, offsetInterior, globalSizeInterface, localSize);
+		commands.enqueueNDRangeKernel(calcVelocityFluxKernel, offsetInterior, globalSizeInterface, localSize);
 		calcFluxDerivKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetInterior, globalSizeInterior, localSize);
 	});
 	boundary();
 }
 
 void MHDBurgers::advectMagneticField(real dt) {
-	calcMagneticFieldFluxKernel.setArg(3, dt);
+	setRealArg(calcMagneticFieldFluxKernel, 3, dt);
+	calcMagneticFieldFluxKernel.setArg(4, slopeLimiter);
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		commands.enqueueNDRangeKernel(calcInterfaceMagneticFieldKernel, offsetNd, globalSize, localSize);
-		commands.enqueueNDRangeKernel(calcMagneticFieldFluxKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(calcInterfaceMagneticFieldKernel, offsetInterior, globalSizeInterface, localSize);
+		commands.enqueueNDRangeKernel(calcMagneticFieldFluxKernel, offsetInterior, globalSizeInterface, localSize);
 		calcFluxDerivKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetInterior, globalSizeInterior, localSize);
 	});
 	boundary();
 }
@@ -98,18 +100,18 @@ void MHDBurgers::advectMagneticField(real dt) {
 void MHDBurgers::diffusePressure(real dt) {
 	//the Hydrodynamics ii paper says it's important to diffuse momentum before work
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSizePadded, localSize);
 		diffuseMomentumKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(diffuseMomentumKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(diffuseMomentumKernel, offsetInterior, globalSizeInterior, localSize);
 	});
 	boundary();
 }
 
 void MHDBurgers::diffuseWork(real dt) {
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		//commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSize, localSize);
+		//commands.enqueueNDRangeKernel(computePressureKernel, offsetNd, globalSizePadded, localSize);
 		diffuseWorkKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(diffuseWorkKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(diffuseWorkKernel, offsetInterior, globalSizeInterior, localSize);
 	});
 	boundary();
 }
@@ -15,9 +15,10 @@ void MHDRemoveDivergence::init() {
 	
 	int volume = solver->getVolume();
 	
-	magneticFieldDivergenceBuffer = solver->cl.alloc(sizeof(real) * volume);
-	magneticFieldPotentialBuffer = solver->cl.alloc(sizeof(real) * volume);
-	magneticFieldPotential2Buffer = solver->cl.alloc(sizeof(real) * volume);
+	magneticFieldDivergenceBuffer = solver->cl.alloc(solver->realSize * volume);
+	magneticFieldPotentialBuffer = solver->cl.alloc(solver->realSize * volume);
+	magneticFieldPotential2Buffer = solver->cl.alloc(solver->realSize * volume);
+	boundaryMethodsBuffer = solver->cl.alloc(sizeof(int) * 2 * solver->app->dim);
 
 	calcMagneticFieldDivergenceKernel = cl::Kernel(program, "calcMagneticFieldDivergence");
 	CLCommon::setArgs(calcMagneticFieldDivergenceKernel, magneticFieldDivergenceBuffer, solver->stateBuffer);
@@ -35,44 +36,41 @@ std::vector<std::string> MHDRemoveDivergence::getProgramSources() {
 
 void MHDRemoveDivergence::update() {
 	cl::CommandQueue commands = solver->commands;
-	cl::NDRange globalSize = solver->globalSize;
+	cl::NDRange globalSizeInterior = solver->globalSizeInterior;
 	cl::NDRange localSize = solver->localSize;
-	cl::NDRange offsetNd = solver->offsetNd;
+	cl::NDRange offsetInterior = solver->offsetInterior;
 
 	int volume = solver->getVolume();
 	
 	//calculate divergence
-	commands.enqueueNDRangeKernel(calcMagneticFieldDivergenceKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(calcMagneticFieldDivergenceKernel, offsetInterior, globalSizeInterior, localSize);
 	boundary(magneticFieldDivergenceBuffer);	//boundary to magnetic field potential buffer
 
 	//poisson relax divergence into potential buffer
-	solver->cl.zero(magneticFieldPotentialBuffer, volume * sizeof(real));
+	solver->cl.zero(magneticFieldPotentialBuffer, volume * solver->realSize);
 	for (int i = 0; i < solver->app->gaussSeidelMaxIter; ++i) {
 		magneticPotentialPoissonRelaxKernel.setArg(0, magneticFieldPotential2Buffer);
 		magneticPotentialPoissonRelaxKernel.setArg(1, magneticFieldPotentialBuffer);
-		commands.enqueueNDRangeKernel(magneticPotentialPoissonRelaxKernel, offsetNd, globalSize, localSize);
+		commands.enqueueNDRangeKernel(magneticPotentialPoissonRelaxKernel, offsetInterior, globalSizeInterior, localSize);
 		std::swap(magneticFieldPotential2Buffer, magneticFieldPotentialBuffer);
 		boundary(magneticFieldPotentialBuffer);	//boundary to magnetic field potential buffer
 	}
 	magneticFieldRemoveDivergenceKernel.setArg(1, magneticFieldPotentialBuffer);
-	commands.enqueueNDRangeKernel(magneticFieldRemoveDivergenceKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(magneticFieldRemoveDivergenceKernel, offsetInterior, globalSizeInterior, localSize);
 }
 
 //looks a lot like Solver::potentialBoundary
 // maybe I could merge them?
 void MHDRemoveDivergence::boundary(cl::Buffer buffer) {
-	cl::NDRange offset, global, local;
 	std::shared_ptr<HydroGPU::Equation::SelfGravitationInterface> gravEqn = std::dynamic_pointer_cast<HydroGPU::Equation::SelfGravitationInterface>(solver->equation);
+	std::vector<int> methods(2 * solver->app->dim);
 	for (int i = 0; i < solver->app->dim; ++i) {
 		for (int minmax = 0; minmax < 2; ++minmax) {
-			int boundaryKernelIndex = gravEqn->gravityGetBoundaryKernelForBoundaryMethod(i, minmax);
-			if (boundaryKernelIndex < 0 || boundaryKernelIndex >= (int)solver->boundaryKernels.size()) continue;
-			cl::Kernel& kernel = solver->boundaryKernels[boundaryKernelIndex][i][minmax];
-			CLCommon::setArgs(kernel, buffer, 1, 0);
-			solver->getBoundaryRanges(i, offset, global, local);
-			solver->commands.enqueueNDRangeKernel(kernel, offset, global, local);
+			methods[minmax + 2 * i] = gravEqn->gravityGetBoundaryKernelForBoundaryMethod(i, minmax);
 		}
 	}
+	solver->updateBoundaryMethods(boundaryMethodsBuffer, boundaryMethodsVec, methods);
+	solver->applyBoundary(buffer, 1, boundaryMethodsBuffer);
 }
 
 cl::Buffer MHDRemoveDivergence::getMagneticFieldDivergenceBuffer() {
@@ -29,6 +29,7 @@ void MHDRoe::initKernels() {
 	CLCommon::setArgs(calcMHDFluxKernel,
 		fluxBuffer, stateBuffer, eigenvaluesBuffer, eigenvectorsBuffer, deltaQTildeBuffer,
 		0, //dt
+		0, //slope limiter
 		//selfgrav->solidBuffer,
 		fluxFlagBuffer);
 }
@@ -75,8 +76,9 @@ void MHDRoe::initFlux() {
 //call this instead
 //it'll call through the CL code if it's needed
 void MHDRoe::calcFlux(real dt) {
-	calcMHDFluxKernel.setArg(5, dt);
-	commands.enqueueNDRangeKernel(calcMHDFluxKernel, offsetNd, globalSize, localSize);
+	setRealArg(calcMHDFluxKernel, 5, dt);
+	calcMHDFluxKernel.setArg(6, slopeLimiter);
+	commands.enqueueNDRangeKernel(calcMHDFluxKernel, offsetInterior, globalSizeInterface, localSize);
 }
 
 void MHDRoe::step(real dt) {
@@ -10,6 +10,9 @@ void MaxwellRoe::initKernels() {
 	
 	addSourceKernel = cl::Kernel(program, "addSource");
 	addSourceKernel.setArg(1, stateBuffer);
+
+	implicitSourceKernel = cl::Kernel(program, "implicitSource");
+	implicitSourceKernel.setArg(1, stateBuffer);
 }
 	
 void MaxwellRoe::createEquation() {
@@ -19,6 +22,7 @@ void MaxwellRoe::createEquation() {
 std::vector<std::string> MaxwellRoe::getProgramSources() {
 	std::vector<std::string> sources = Super::getProgramSources();
 	sources.push_back("#include \"MaxwellRoe.cl\"\n");
+	sources.push_back("#include \"ImplicitSource.cl\"\n");
 	return sources;
 }
 
@@ -36,13 +40,8 @@ std::vector<std::string> MaxwellRoe::getEigenProgramSources() {
 }
 
 void MaxwellRoe::step(real dt) {
-	Super::step(dt);
-	
 	//see ADM1DRoe::step() for my thoughts on source and separabe integration
-	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		addSourceKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(addSourceKernel, offsetNd, globalSize, localSize);
-	});
+	stepWithSource(dt, addSourceKernel, implicitSourceKernel);
 }
 
 }
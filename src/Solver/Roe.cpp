@@ -1,24 +1,63 @@
 #include "HydroGPU/Solver/Roe.h"
+#include "HydroGPU/Integrator/ForwardEuler.h"
 #include "HydroGPU/HydroGPUApp.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
 
 namespace HydroGPU {
 namespace Solver {
 
 Roe::Roe(HydroGPUApp* app_)
 : Super(app_)
-{}
+, constantTimestep(0)
+, useActivityMask(false)
+, activityTolerance(0)
+, activityMargin(2)
+, numBlocks(0)
+, numActiveBlocks(0)
+, activityReset(true)
+, activitySlopeLimiter(-1)
+, useLocalTimestep(false)
+, localTimestepMaxLevel(3)
+, numSubsteps(1)
+, dimensionalSplit(false)
+, splitBasisSide(-1)
+{
+	numBlocksPerSide[0] = numBlocksPerSide[1] = numBlocksPerSide[2] = 1;
+}
 
 void Roe::initBuffers() {
 	Super::initBuffers();
-	eigenvaluesBuffer = cl.alloc(sizeof(real) * getEigenSpaceDim() * getVolume() * app->dim, "Roe::eigenvaluesBuffer");
-	eigenvectorsBuffer = cl.alloc(sizeof(real) * getEigenTransformStructSize() * getVolume() * app->dim, "Roe::eigenvectorsBuffer");
-	deltaQTildeBuffer = cl.alloc(sizeof(real) * getEigenSpaceDim() * getVolume() * app->dim, "Roe::deltaQTildeBuffer");
+	int numBases = hasConstantEigenBasis() ? app->dim : getVolume() * getFluxSides();
+	eigenvaluesBuffer = cl.alloc(realSize * getEigenSpaceDim() * numBases, "Roe::eigenvaluesBuffer");
+	eigenvectorsBuffer = cl.alloc(realSize * getEigenTransformStructSize() * numBases, "Roe::eigenvectorsBuffer");
+	deltaQTildeBuffer = cl.alloc(realSize * getDeltaQTildeDim() * getVolume() * getFluxSides(), "Roe::deltaQTildeBuffer");
+	
+	if (useActivityMask) {
+		lastStateBuffer = cl.alloc(storageSize * numStates() * getVolume(), "Roe::lastStateBuffer");
+		activeCountBuffer = cl.alloc(sizeof(int), "Roe::activeCountBuffer");
+	}
+	if (useActivityMask || useLocalTimestep) {
+		activeBlocksBuffer = cl.alloc(sizeof(int) * numBlocks, "Roe::activeBlocksBuffer");
+	}
+	if (useLocalTimestep) {
+		blockTimestepsBuffer = cl.alloc(realSize * numBlocks, "Roe::blockTimestepsBuffer");
+		blockLevelsBuffer = cl.alloc(sizeof(int) * numBlocks, "Roe::blockLevelsBuffer");
+		resetLocalTimesteps();
+	}
+}
+
+int Roe::getFluxSides() {
+	return dimensionalSplit ? 1 : app->dim;
 }
 
 //if the eigen transform is transforming from/to conservative/characteristics
 //then it should be getEigenSpaceDim() * numStates * 2
 // but I don't think anyone who uses the default implementation changes the # of characteristics away from the # of conservative
 int Roe::getEigenTransformStructSize() {
+	std::shared_ptr<SparseEigenTransform> sparse = getSparseEigenTransform();
+	if (sparse) return sparse->getStructSize();
 	return getEigenSpaceDim() * getEigenSpaceDim() * 2;	//times two for forward and inverse
 }
 
@@ -51,19 +90,103 @@ void Roe::initKernels() {
 
 	calcDeltaQTildeKernel = cl::Kernel(program, "calcDeltaQTilde");
 	CLCommon::setArgs(calcDeltaQTildeKernel, deltaQTildeBuffer, eigenvectorsBuffer, stateBuffer);
+	
+	//boundary methods always go last, after any optional SOLID args, but before the side of a dimensionalSplit sweep
+	if (boundaryRemap) {
+		calcDeltaQTildeKernel.setArg(calcDeltaQTildeKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1 - dimensionalSplit, boundaryMethodsBuffer);
+		calcFluxKernel.setArg(calcFluxKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1 - dimensionalSplit, boundaryMethodsBuffer);
+	}
+
+	//likewise last, since it doesn't go with boundaryRemap
+	if (useActivityMask) {
+		calcActiveBlocksKernel = cl::Kernel(program, "calcActiveBlocks");
+		CLCommon::setArgs(calcActiveBlocksKernel, activeBlocksBuffer, activeCountBuffer, stateBuffer, lastStateBuffer);
+	}
+	if (useActivityMask || useLocalTimestep) {
+		calcDeltaQTildeKernel.setArg(calcDeltaQTildeKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1, activeBlocksBuffer);
+		//calcFlux takes the block levels after it, for each interface's dt
+		calcFluxKernel.setArg(calcFluxKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1 - useLocalTimestep, activeBlocksBuffer);
+	}
+	if (useLocalTimestep) {
+		calcFluxKernel.setArg(calcFluxKernel.getInfo<CL_KERNEL_NUM_ARGS>() - 1, blockLevelsBuffer);
+		
+		calcBlockTimestepsKernel = cl::Kernel(program, "calcBlockTimesteps");
+		CLCommon::setArgs(calcBlockTimestepsKernel, blockTimestepsBuffer, dtBuffer);
+		
+		calcLocalFluxDerivKernel = cl::Kernel(program, "calcLocalFluxDeriv");
+		calcLocalFluxDerivKernel.setArg(1, fluxBuffer);
+		calcLocalFluxDerivKernel.setArg(2, blockLevelsBuffer);
+	}
+	
+	if (dimensionalSplit) setSplitSide(0);
 }	
 
 void Roe::init() {
+	app->lua["activityMask"] >> useActivityMask;
+	app->lua["activityTolerance"] >> activityTolerance;
+	app->lua["activityMargin"] >> activityMargin;
+	app->lua["localTimestep"] >> useLocalTimestep;
+	app->lua["localTimestepMaxLevel"] >> localTimestepMaxLevel;
+	app->lua["dimensionalSplit"] >> dimensionalSplit;
 	Super::init();
 	calcFluxKernel.setArg(2, eigenvaluesBuffer);
 	calcFluxKernel.setArg(3, eigenvectorsBuffer);
 	calcFluxKernel.setArg(4, deltaQTildeBuffer); 
+
+	if (hasConstantEigenBasis()) {
+		//a single work item writes the basis of each side
+		commands.enqueueNDRangeKernel(calcEigenBasisKernel, offset1d, cl::NDRange(1), cl::NDRange(1));
+		commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetInterior, globalSizeInterior, localSize);
+		constantTimestep = findMinTimestep() / app->cfl;
+	}
 }
 
 std::vector<std::string> Roe::getProgramSources() {
 	std::vector<std::string> sources = Super::getProgramSources();
 	sources.push_back("#define EIGEN_TRANSFORM_STRUCT_SIZE "+std::to_string(getEigenTransformStructSize())+"\n");
 	sources.push_back("#define EIGEN_SPACE_DIM "+std::to_string(getEigenSpaceDim())+"\n");
+	if (hasConstantEigenBasis()) sources.push_back("#define CONSTANT_EIGENBASIS 1\n");
+	
+	if (useActivityMask && (!canActivityMask() || boundaryRemap)) {
+		std::cout << "solver " << name() << " can't use activityMask" << (boundaryRemap ? " with boundaryRemap" : "") << " -- computing every block" << std::endl;
+		useActivityMask = false;
+	}
+	//it picks the blocks of the interface launches the same way
+	if (useLocalTimestep && (!canActivityMask() || boundaryRemap || hasConstantEigenBasis())) {
+		std::cout << "solver " << name() << " can't use localTimestep" << (boundaryRemap ? " with boundaryRemap" : "") << " -- stepping everything at the smallest dt" << std::endl;
+		useLocalTimestep = false;
+	}
+	if (useLocalTimestep && useActivityMask) {
+		std::cout << "activityMask doesn't go with localTimestep -- computing every block" << std::endl;
+		useActivityMask = false;
+	}
+	if (dimensionalSplit && (!canDimensionalSplit() || useActivityMask || useLocalTimestep)) {
+		std::cout << "solver " << name() << " can't use dimensionalSplit" << (useActivityMask ? " with activityMask" : "") << (useLocalTimestep ? " with localTimestep" : "") << " -- updating all sides at once" << std::endl;
+		dimensionalSplit = false;
+	}
+	//before Common.cl, which picks INTERFACE_INDEX by it
+	if (dimensionalSplit) sources[0] += "#define DIMENSIONAL_SPLIT 1\n";
+	if (useActivityMask || useLocalTimestep) {
+		//blocks tile the interface launches, one work group each
+		int blockSize[3] = {1, 1, 1};
+		numBlocks = 1;
+		for (int n = 0; n < 3; ++n) {
+			numBlocksPerSide[n] = 1;
+		}
+		for (int n = 0; n < app->dim; ++n) {
+			blockSize[n] = localSize[n];
+			numBlocksPerSide[n] = globalSizeInterface[n] / localSize[n];
+			numBlocks *= numBlocksPerSide[n];
+		}
+		const char* xyz = "XYZ";
+		std::string defines = "#define ACTIVE_BLOCKS 1\n#define ACTIVE_BLOCKS_MARGIN " + std::to_string(activityMargin) + "\n";
+		for (int n = 0; n < 3; ++n) {
+			defines += std::string("#define ACTIVE_BLOCKS_") + xyz[n] + " " + std::to_string(numBlocksPerSide[n]) + "\n";
+			defines += std::string("#define ACTIVE_BLOCK_SIZE_") + xyz[n] + " " + std::to_string(blockSize[n]) + "\n";
+		}
+		if (useLocalTimestep) defines += "#define LOCAL_TIMESTEP 1\n";
+		sources.push_back(defines);
+	}
 	
 	std::vector<std::string> added = getEigenProgramSources();
 	sources.insert(sources.end(), added.begin(), added.end());
@@ -74,41 +197,296 @@ std::vector<std::string> Roe::getProgramSources() {
 }
 
 std::vector<std::string> Roe::getEigenProgramSources() {
+	std::shared_ptr<SparseEigenTransform> sparse = getSparseEigenTransform();
+	if (sparse) return {sparse->getProgramSource()};
 	return {
 		"#include \"RoeEigenfieldLinear.cl\"\n"
 	};
 }
 
 void Roe::initFlux() {
+	//constant eigenbases were computed in init()
+	if (hasConstantEigenBasis()) return;
+	
 	//compute eigenbasis here, once
 	//then, because we're not integrating separate dimensions separately, the states won't get intermediately changed and we won't have to update this value
-	commands.enqueueNDRangeKernel(calcEigenBasisKernel, offsetNd, globalSize, localSize);
+	enqueueInterfaceKernel(calcEigenBasisKernel);
+}
+
+void Roe::initStep() {
+	Super::initStep();
+	updateActiveBlocks();
+}
+
+//after the boundary, so ghost cells count as changes too
+void Roe::updateActiveBlocks() {
+	if (!useActivityMask) return;
+
+	//the cached fluxes depend on the limiter too
+	if (slopeLimiter != activitySlopeLimiter) activityReset = true;
+	activitySlopeLimiter = slopeLimiter;
+
+	int zero = 0;
+	commands.enqueueWriteBuffer(activeCountBuffer, CL_TRUE, 0, sizeof(int), &zero);
+	setRealArg(calcActiveBlocksKernel, 4, activityTolerance);
+	calcActiveBlocksKernel.setArg(5, (int)activityReset);
+	size_t l = localSize1d[0];
+	commands.enqueueNDRangeKernel(calcActiveBlocksKernel, offset1d, cl::NDRange((numBlocks + l - 1) / l * l), localSize1d);
+	//blocking, like the dt reduction
+	commands.enqueueReadBuffer(activeCountBuffer, CL_TRUE, 0, sizeof(int), &numActiveBlocks);
+	activityReset = false;
+
+	if (app->showTimestep) {
+		std::cout << "active blocks " << numActiveBlocks << " of " << numBlocks << std::endl;
+	}
+
+	//what next step compares against
+	commands.enqueueCopyBuffer(stateBuffer, lastStateBuffer, 0, 0, storageSize * numStates() * getVolume());
+}
+
+void Roe::enqueueInterfaceKernel(cl::Kernel& kernel) {
+	if (!useActivityMask && !useLocalTimestep) {
+		commands.enqueueNDRangeKernel(kernel, offsetInterior, globalSizeInterface, localSize);
+		return;
+	}
+	if (!numActiveBlocks) return;
+
+	//one work group per active block.  the kernels find their cells from activeBlocks, so no offset
+	cl::NDRange global;
+	switch (app->dim) {
+	case 1:
+		global = cl::NDRange(numActiveBlocks * localSize[0]);
+		break;
+	case 2:
+		global = cl::NDRange(numActiveBlocks * localSize[0], localSize[1]);
+		break;
+	default:
+		global = cl::NDRange(numActiveBlocks * localSize[0], localSize[1], localSize[2]);
+		break;
+	}
+	commands.enqueueNDRangeKernel(kernel, offsetNd, global, localSize);
+}
+
+void Roe::enqueueCellKernel(cl::Kernel& kernel) {
+	commands.enqueueNDRangeKernel(kernel, offsetInterior, globalSizeInterior, localSize);
 }
 
 real Roe::calcTimestep() {
+	if (hasConstantEigenBasis()) return constantTimestep * app->cfl;
+	if (dimensionalSplit) {
+		//a side at a time into dtBuffer, the first side swept last so its eigenbasis is still there for the step
+		for (int sweep = app->dim - 1; sweep >= 0; --sweep) {
+			setSplitSide(getSweepSide(sweep));
+			//after the first, only the side changes, so only the eigenbasis needs redoing
+			if (sweep == app->dim - 1) {
+				initFlux();
+			} else {
+				Roe::initFlux();
+			}
+			enqueueCellKernel(calcCellTimestepKernel);
+		}
+		splitBasisSide = getSweepSide(0);
+		return findMinTimestep();
+	}
 	initFlux();
-	commands.enqueueNDRangeKernel(calcCellTimestepKernel, offsetNd, globalSize, localSize);
+	enqueueCellKernel(calcCellTimestepKernel);
+	if (localTimestepActive()) return calcLocalTimesteps();
 	return findMinTimestep();
 }
 
+bool Roe::localTimestepActive() {
+	return useLocalTimestep
+		&& !app->useFixedDT
+		&& dynamic_cast<HydroGPU::Integrator::ForwardEuler*>(integrator.get());
+}
+
+//picks the block levels from dtBuffer, and returns the whole step: 2^(coarsest level) times the finest dt
+real Roe::calcLocalTimesteps() {
+	size_t l = localSize1d[0];
+	commands.enqueueNDRangeKernel(calcBlockTimestepsKernel, offset1d, cl::NDRange((numBlocks + l - 1) / l * l), localSize1d);
+	std::vector<real> blockTimesteps(numBlocks);
+	readReals(blockTimestepsBuffer, blockTimesteps.data(), numBlocks, realSize);
+	real minTimestep = *std::min_element(blockTimesteps.begin(), blockTimesteps.end());
+	
+	for (int block = 0; block < numBlocks; ++block) {
+		int level = 0;
+		while (level < localTimestepMaxLevel && blockTimesteps[block] >= minTimestep * (real)(2 << level)) ++level;
+		blockLevels[block] = level;
+	}
+
+	//lowest level of a block and the blocks around it
+	int nx = numBlocksPerSide[0];
+	int ny = numBlocksPerSide[1];
+	int nz = numBlocksPerSide[2];
+	auto neighborhoodLevel = [&](int block) -> int {
+		int bx = block % nx;
+		int by = (block / nx) % ny;
+		int bz = block / (nx * ny);
+		int level = blockLevels[block];
+		for (int z = std::max(bz - 1, 0); z <= std::min(bz + 1, nz - 1); ++z) {
+			for (int y = std::max(by - 1, 0); y <= std::min(by + 1, ny - 1); ++y) {
+				for (int x = std::max(bx - 1, 0); x <= std::min(bx + 1, nx - 1); ++x) {
+					level = std::min(level, blockLevels[x + nx * (y + ny * z)]);
+				}
+			}
+		}
+		return level;
+	};
+
+	//neighbors at most one level apart
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (int block = 0; block < numBlocks; ++block) {
+			int level = neighborhoodLevel(block) + 1;
+			if (level < blockLevels[block]) {
+				blockLevels[block] = level;
+				changed = true;
+			}
+		}
+	}
+	int coarsestLevel = *std::max_element(blockLevels.begin(), blockLevels.end());
+	numSubsteps = 1 << coarsestLevel;
+
+	/*
+	a block's fluxes are needed when an interface in or next to it is due, i.e. at multiples of 2^(its neighborhood's level).
+	sorted by that, the blocks for substeps that are multiples of 2^k are the first levelBlockCounts[k] of activeBlocks
+	*/
+	std::vector<int> neighborhoodLevels(numBlocks);
+	for (int block = 0; block < numBlocks; ++block) {
+		neighborhoodLevels[block] = neighborhoodLevel(block);
+	}
+	std::vector<int> sortedBlocks(numBlocks);
+	std::iota(sortedBlocks.begin(), sortedBlocks.end(), 0);
+	std::stable_sort(sortedBlocks.begin(), sortedBlocks.end(), [&](int a, int b) { return neighborhoodLevels[a] < neighborhoodLevels[b]; });
+	levelBlockCounts.assign(coarsestLevel + 1, 0);
+	for (int block = 0; block < numBlocks; ++block) {
+		for (int k = neighborhoodLevels[block]; k <= coarsestLevel; ++k) {
+			++levelBlockCounts[k];
+		}
+	}
+	
+	commands.enqueueWriteBuffer(activeBlocksBuffer, CL_TRUE, 0, sizeof(int) * numBlocks, sortedBlocks.data());
+	commands.enqueueWriteBuffer(blockLevelsBuffer, CL_TRUE, 0, sizeof(int) * numBlocks, blockLevels.data());
+
+	if (app->showTimestep) {
+		std::cout << "blocks per level";
+		for (int k = 0; k <= coarsestLevel; ++k) {
+			std::cout << " " << std::count(blockLevels.begin(), blockLevels.end(), k);
+		}
+		std::cout << ", " << numSubsteps << " substeps" << std::endl;
+	}
+
+	return minTimestep * app->cfl * (real)numSubsteps;
+}
+
+//everything at level 0, in block order
+void Roe::resetLocalTimesteps() {
+	blockLevels.assign(numBlocks, 0);
+	levelBlockCounts.assign(1, numBlocks);
+	numSubsteps = 1;
+	numActiveBlocks = numBlocks;
+	std::vector<int> blocks(numBlocks);
+	std::iota(blocks.begin(), blocks.end(), 0);
+	commands.enqueueWriteBuffer(activeBlocksBuffer, CL_TRUE, 0, sizeof(int) * numBlocks, blocks.data());
+	commands.enqueueWriteBuffer(blockLevelsBuffer, CL_TRUE, 0, sizeof(int) * numBlocks, blockLevels.data());
+}
+
+//ForwardEuler substeps of dt / numSubsteps, each only adding the fluxes of the interfaces due (calcLocalFluxDeriv)
+void Roe::stepLocalTimesteps(real dt) {
+	real substepDt = dt / (real)numSubsteps;
+	int coarsestLevel = (int)levelBlockCounts.size() - 1;
+	for (int substep = 0; substep < numSubsteps; ++substep) {
+		//the highest level due
+		int k = 0;
+		while (k < coarsestLevel && !(substep & (1 << k))) ++k;
+		numActiveBlocks = levelBlockCounts[k];
+		
+		//the first substep's eigenbasis is from calcTimestep
+		if (substep > 0) {
+			boundary();
+			initFlux();
+		}
+		
+		calcLocalFluxDerivKernel.setArg(3, substep);
+		integrator->integrate(substepDt, [&](cl::Buffer derivBuffer) {
+			enqueueInterfaceKernel(calcDeltaQTildeKernel);
+			calcFlux(substepDt);
+			calcLocalFluxDerivKernel.setArg(0, derivBuffer);
+			enqueueCellKernel(calcLocalFluxDerivKernel);
+		});
+	}
+	numActiveBlocks = numBlocks;
+}
+
+//x,y,z on even frames, z,y,x on odd ones
+int Roe::getSweepSide(int sweep) {
+	return frame % 2 == 0 ? sweep : app->dim - 1 - sweep;
+}
+
+//the side is the last arg of all the kernels that go over them
+void Roe::setSplitSide(int side) {
+	for (cl::Kernel* kernel : {&calcEigenBasisKernel, &calcCellTimestepKernel, &calcDeltaQTildeKernel, &calcFluxKernel, &calcFluxDerivKernel}) {
+		kernel->setArg(kernel->getInfo<CL_KERNEL_NUM_ARGS>() - 1, side);
+	}
+}
+
+void Roe::stepDimensionalSplit(real dt) {
+	for (int sweep = 0; sweep < app->dim; ++sweep) {
+		int side = getSweepSide(sweep);
+		setSplitSide(side);
+		if (sweep > 0) boundary();
+		if (side != splitBasisSide) initFlux();
+		integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
+			calcDeriv(derivBuffer, dt);
+		});
+	}
+	splitBasisSide = -1;
+}
+
 void Roe::step(real dt) {
+	if (dimensionalSplit) {
+		stepDimensionalSplit(dt);
+		return;
+	}
+	if (useLocalTimestep) {
+		//useFixedDT since the levels were picked
+		if (!localTimestepActive() && numSubsteps > 1) resetLocalTimesteps();
+		if (numSubsteps > 1) {
+			stepLocalTimesteps(dt);
+			return;
+		}
+	}
 	//no need to re-init flux here unless we are separating integraion per-side
 	integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
 		calcDeriv(derivBuffer, dt);
 	});
 }
 
+void Roe::stepWithSource(real dt, cl::Kernel& addSourceKernel, cl::Kernel& implicitSourceKernel) {
+	integrator->integrateIMEX(dt, [&](cl::Buffer derivBuffer) {
+		calcDeriv(derivBuffer, dt);
+	}, [&](cl::Buffer derivBuffer) {
+		addSourceKernel.setArg(0, derivBuffer);
+		commands.enqueueNDRangeKernel(addSourceKernel, offsetInterior, globalSizeInterior, localSize);
+	}, [&](cl::Buffer sourceBuffer, real sourceDt) {
+		implicitSourceKernel.setArg(0, sourceBuffer);
+		setRealArg(implicitSourceKernel, 2, sourceDt);
+		commands.enqueueNDRangeKernel(implicitSourceKernel, offsetInterior, globalSizeInterior, localSize);
+	});
+}
+
 void Roe::calcDeriv(cl::Buffer derivBuffer, real dt) {
-	commands.enqueueNDRangeKernel(calcDeltaQTildeKernel, offsetNd, globalSize, localSize);
+	enqueueInterfaceKernel(calcDeltaQTildeKernel);
 	calcFlux(dt);
 	
 	calcFluxDerivKernel.setArg(0, derivBuffer);
-	commands.enqueueNDRangeKernel(calcFluxDerivKernel, offsetNd, globalSize, localSize);
+	enqueueCellKernel(calcFluxDerivKernel);
 }
 
 void Roe::calcFlux(real dt) {
-	calcFluxKernel.setArg(5, dt);
-	commands.enqueueNDRangeKernel(calcFluxKernel, offsetNd, globalSize, localSize);
+	setRealArg(calcFluxKernel, 5, dt);
+	calcFluxKernel.setArg(6, slopeLimiter);
+	enqueueInterfaceKernel(calcFluxKernel);
 }
 
 }
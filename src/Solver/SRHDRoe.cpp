@@ -9,7 +9,7 @@ namespace Solver {
 void SRHDRoe::initBuffers() {
 	Super::initBuffers();
 	
-	primitiveBuffer = cl.alloc(sizeof(real) * numStates() * getVolume(), "SRHDRoe::initBuffers");
+	primitiveBuffer = cl.alloc(realSize * numStates() * getVolume(), "SRHDRoe::initBuffers");
 }
 
 void SRHDRoe::initKernels() {
@@ -41,7 +41,7 @@ void SRHDRoe::resetState() {
 	//store Newtonian Euler equation state variables in stateBuffer
 	Super::resetState();
 
-	commands.enqueueNDRangeKernel(initVariablesKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(initVariablesKernel, offsetNd, globalSizePadded, localSize);
 }
 
 /*
@@ -68,8 +68,8 @@ void SRHDRoe::step(real dt) {
 	But moving the two lines of 'constrainState' into the top of 'updatePrimitives' is causing the sim to explode. 
 	I blame AMD.
 	*/
-	commands.enqueueNDRangeKernel(constrainStateKernel, offsetNd, globalSize, localSize);
-	commands.enqueueNDRangeKernel(updatePrimitivesKernel, offsetNd, globalSize, localSize);
+	commands.enqueueNDRangeKernel(constrainStateKernel, offsetNd, globalSizePadded, localSize);
+	commands.enqueueNDRangeKernel(updatePrimitivesKernel, offsetInterior, globalSizeInterface, localSize);
 }
 
 /*
@@ -78,21 +78,7 @@ so just use the same kernels on them
 */
 void SRHDRoe::boundary() {
 	Super::boundary();
-	cl::NDRange offset, global, local;
-	for (int i = 0; i < app->dim; ++i) {
-		getBoundaryRanges(i, offset, global, local);
-		for (int j = 0; j < numStates(); ++j) {
-			for (int minmax = 0; minmax < 2; ++minmax) {
-				int boundaryKernelIndex = equation->stateGetBoundaryKernelForBoundaryMethod(i, j, minmax);
-				if (boundaryKernelIndex < 0 || boundaryKernelIndex >= (int)boundaryKernels.size()) continue;
-				cl::Kernel& kernel = boundaryKernels[boundaryKernelIndex][i][minmax];
-				kernel.setArg(0, primitiveBuffer);
-				kernel.setArg(1, numStates());
-				kernel.setArg(2, j);
-				commands.enqueueNDRangeKernel(kernel, offset, global, local);
-			}
-		}
-	}
+	applyBoundary(primitiveBuffer, numStates(), boundaryMethodsBuffer);
 }
 	
 cl::Buffer SRHDRoe::getPrimitiveBuffer() {
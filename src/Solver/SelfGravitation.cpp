@@ -5,23 +5,41 @@
 #include "HydroGPU/Plot/Plot.h"
 #include "HydroGPU/HydroGPUApp.h"
 #include "Image/Image.h"
+#include <iostream>
+#include <limits>
 
 namespace HydroGPU {
 namespace Solver {
 
-SelfGravitation::SelfGravitation(Solver* solver_) : solver(solver_) {}
+SelfGravitation::SelfGravitation(Solver* solver_)
+: solver(solver_)
+, fluidDispatch(false)
+, numFluidCells(0)
+, numFluidInterfaces(0)
+{
+	solver->app->lua["fluidDispatch"] >> fluidDispatch;
+}
 
 void SelfGravitation::initBuffers() {
 	int volume = solver->getVolume();
-	potentialBuffer = solver->cl.alloc(sizeof(real) * volume, "SelfGravitation::potentialBuffer");
+	potentialBuffer = solver->cl.alloc(solver->storageSize * volume, "SelfGravitation::potentialBuffer");
 	solidBuffer = solver->cl.alloc(sizeof(char) * volume, "SelfGravitation::solidBuffer");
+	potentialBoundaryMethodsBuffer = solver->cl.alloc(sizeof(int) * 2 * solver->app->dim, "SelfGravitation::potentialBoundaryMethodsBuffer");
+
+	if (fluidDispatch) {
+		size_t l = solver->localSize1d[0];
+		size_t maxListSize = (volume + l - 1) / l * l;
+		solidBitsBuffer = solver->cl.alloc(sizeof(cl_uint) * ((volume + 31) / 32), "SelfGravitation::solidBitsBuffer");
+		fluidCellsBuffer = solver->cl.alloc(sizeof(int) * maxListSize, "SelfGravitation::fluidCellsBuffer");
+		fluidInterfacesBuffer = solver->cl.alloc(sizeof(int) * maxListSize, "SelfGravitation::fluidInterfacesBuffer");
+	}
 }
 
 void SelfGravitation::initKernels() {
 	cl::Program program = solver->program;
 	
 	gravityPotentialPoissonRelaxKernel = cl::Kernel(program, "gravityPotentialPoissonRelax");
-	CLCommon::setArgs(gravityPotentialPoissonRelaxKernel, potentialBuffer, solver->stateBuffer);
+	CLCommon::setArgs(gravityPotentialPoissonRelaxKernel, potentialBuffer, solver->stateBuffer, solver->defsBuffer);
 	
 	calcGravityDerivKernel = cl::Kernel(program, "calcGravityDeriv");
 	calcGravityDerivKernel.setArg(1, solver->stateBuffer);
@@ -38,9 +56,9 @@ void SelfGravitation::resetState(
 	std::vector<char>& solidVec)
 {
 	cl::CommandQueue commands = solver->commands;
-	cl::NDRange globalSize = solver->globalSize;
+	cl::NDRange globalSizeInterior = solver->globalSizeInterior;
 	cl::NDRange localSize = solver->localSize;
-	cl::NDRange offsetNd = solver->offsetNd;
+	cl::NDRange offsetInterior = solver->offsetInterior;
 	
 	int volume = solver->getVolume();
 	
@@ -51,7 +69,7 @@ void SelfGravitation::resetState(
 			potentialVec[i] = -stateVec[0 + solver->numStates() * i];
 		}
 	}
-	commands.enqueueWriteBuffer(potentialBuffer, CL_TRUE, 0, sizeof(real) * volume, potentialVec.data());
+	solver->writeReals(potentialBuffer, potentialVec.data(), volume, solver->storageSize);
 
 	//HACK: if the Lua state has a solid filename then load that and use it for the solid channel ...
 	std::string solidFilename;
@@ -73,6 +91,7 @@ void SelfGravitation::resetState(
 		}
 	}
 	commands.enqueueWriteBuffer(solidBuffer, CL_TRUE, 0, sizeof(char) * volume, solidVec.data());
+	if (fluidDispatch) initFluidLists(solidVec);
 	
 	if (solver->app->useGravity) {
 		//solve for gravitational potential via gauss seidel
@@ -81,7 +100,7 @@ void SelfGravitation::resetState(
 		for (int tries = 0; tries < 100; ++tries) {
 			for (int i = 0; i < solver->app->gaussSeidelMaxIter; ++i) {
 				potentialBoundary();
-				commands.enqueueNDRangeKernel(gravityPotentialPoissonRelaxKernel, offsetNd, globalSize, localSize);
+				commands.enqueueNDRangeKernel(gravityPotentialPoissonRelaxKernel, offsetInterior, globalSizeInterior, localSize);
 			}
 		}
 	}
@@ -93,50 +112,118 @@ void SelfGravitation::resetState(
 		stateVec[energyTotalIndex + solver->numStates() * i] += potentialVec[i];
 	}
 
-	commands.enqueueWriteBuffer(solver->stateBuffer, CL_TRUE, 0, sizeof(real) * solver->numStates() * volume, stateVec.data());
+	solver->writeReals(solver->stateBuffer, stateVec.data(), solver->numStates() * volume, solver->storageSize);
 	commands.finish();
 }
 
 void SelfGravitation::applyPotential(real dt) {
-	cl::CommandQueue commands = solver->commands;
-	cl::NDRange globalSize = solver->globalSize;
-	cl::NDRange localSize = solver->localSize;
-	cl::NDRange offsetNd = solver->offsetNd;
-
 	//TODO I had an idea of using the potential buffer to create static source fields even in the absense of self-gravitation
 	//  ... but I'm getting weird stuff even when the potential buffer *should* be zero
 	// so *either* zero your deriv buffers beforehand (which I'm doing now) *or* find where the fill-deriv kernels are missing their writes
 	//if (!solver->app->useGravity) return;
 	
 	solver->integrator->integrate(dt, [&](cl::Buffer derivBuffer) {
-		if (solver->app->useGravity) {
-			for (int i = 0; i < solver->app->gaussSeidelMaxIter; ++i) {
-				potentialBoundary();
-				commands.enqueueNDRangeKernel(gravityPotentialPoissonRelaxKernel, offsetNd, globalSize, localSize);
-			}	
+		calcGravityDeriv(derivBuffer);
+	});
+}
+
+void SelfGravitation::calcGravityDeriv(cl::Buffer derivBuffer) {
+	cl::CommandQueue commands = solver->commands;
+	cl::NDRange globalSizeInterior = solver->globalSizeInterior;
+	cl::NDRange localSize = solver->localSize;
+	cl::NDRange offsetInterior = solver->offsetInterior;
+
+	if (solver->app->useGravity) {
+		for (int i = 0; i < solver->app->gaussSeidelMaxIter; ++i) {
+			potentialBoundary();
+			commands.enqueueNDRangeKernel(gravityPotentialPoissonRelaxKernel, offsetInterior, globalSizeInterior, localSize);
+		}	
+	}
+
+	calcGravityDerivKernel.setArg(0, derivBuffer);
+	commands.enqueueNDRangeKernel(calcGravityDerivKernel, offsetInterior, globalSizeInterior, localSize);
+	
+	solver->boundary();	
+}
+
+void SelfGravitation::initFluidLists(const std::vector<char>& solidVec) {
+	cl::CommandQueue commands = solver->commands;
+	int volume = solver->getVolume();
+	int dim = solver->app->dim;
+	const cl_int* size = solver->app->size.s;
+	int stepsize[3] = {1, size[0], size[0] * size[1]};
+
+	std::vector<cl_uint> solidBits((volume + 31) / 32);
+	for (int i = 0; i < volume; ++i) {
+		if (solidVec[i]) solidBits[i >> 5] |= 1u << (i & 31);
+	}
+	commands.enqueueWriteBuffer(solidBitsBuffer, CL_TRUE, 0, sizeof(cl_uint) * solidBits.size(), solidBits.data());
+
+	//interior cells that aren't solid, and interfaces (on the min side of their cell) in [2, size-1) with fluid on either side of any of them,
+	// plus the next interface out along each side, since the slope limiter reads the deltaQTilde of its neighbors
+	std::vector<int> fluidCells, fluidInterfaces;
+	int index[3];
+	for (index[2] = 0; index[2] < size[2]; ++index[2]) {
+		for (index[1] = 0; index[1] < size[1]; ++index[1]) {
+			for (index[0] = 0; index[0] < size[0]; ++index[0]) {
+				bool interior = true;
+				bool isInterface = true;
+				for (int n = 0; n < dim; ++n) {
+					interior &= index[n] >= 2 && index[n] < size[n] - 2;
+					isInterface &= index[n] >= 2 && index[n] < size[n] - 1;
+				}
+				int cellIndex = index[0] + size[0] * (index[1] + size[1] * index[2]);
+				if (interior && !solidVec[cellIndex]) fluidCells.push_back(cellIndex);
+				if (isInterface) {
+					//cells [-2, 1] along n touch this interface or its neighbors on side n
+					bool fluid = false;
+					for (int n = 0; n < dim; ++n) {
+						for (int offset = -2; offset <= 1; ++offset) {
+							fluid |= !solidVec[cellIndex + offset * stepsize[n]];
+						}
+					}
+					if (fluid) fluidInterfaces.push_back(cellIndex);
+				}
+			}
 		}
+	}
+	std::cout << "fluid cells " << fluidCells.size() << " interfaces " << fluidInterfaces.size() << " of " << volume << std::endl;
 
-		calcGravityDerivKernel.setArg(0, derivBuffer);
-		commands.enqueueNDRangeKernel(calcGravityDerivKernel, offsetNd, globalSize, localSize);
-		
-		solver->boundary();	
-	});
+	//pad to the 1D local size with the last cell, a ghost cell that every kernel's bounds check skips
+	size_t l = solver->localSize1d[0];
+	for (std::vector<int>* list : {&fluidCells, &fluidInterfaces}) {
+		list->resize((list->size() + l - 1) / l * l, volume - 1);
+	}
+	numFluidCells = (int)fluidCells.size();
+	numFluidInterfaces = (int)fluidInterfaces.size();
+	if (numFluidCells) commands.enqueueWriteBuffer(fluidCellsBuffer, CL_TRUE, 0, sizeof(int) * numFluidCells, fluidCells.data());
+	if (numFluidInterfaces) commands.enqueueWriteBuffer(fluidInterfacesBuffer, CL_TRUE, 0, sizeof(int) * numFluidInterfaces, fluidInterfaces.data());
+
+	//solid cells aren't launched any more, so don't leave them the timesteps of whatever was there before
+	std::vector<real> dtVec(volume * dim, std::numeric_limits<real>::max());
+	solver->writeReals(solver->dtBuffer, dtVec.data(), dtVec.size(), solver->realSize);
+}
+
+void SelfGravitation::enqueueFluidCells(cl::Kernel& kernel) {
+	if (!numFluidCells) return;
+	solver->commands.enqueueNDRangeKernel(kernel, solver->offset1d, cl::NDRange(numFluidCells), solver->localSize1d);
+}
+
+void SelfGravitation::enqueueFluidInterfaces(cl::Kernel& kernel) {
+	if (!numFluidInterfaces) return;
+	solver->commands.enqueueNDRangeKernel(kernel, solver->offset1d, cl::NDRange(numFluidInterfaces), solver->localSize1d);
 }
 
 void SelfGravitation::potentialBoundary() {
-	cl::CommandQueue commands = solver->commands;
-	cl::NDRange offset, global, local;
 	std::shared_ptr<HydroGPU::Equation::SelfGravitationInterface> gravEqn = std::dynamic_pointer_cast<HydroGPU::Equation::SelfGravitationInterface>(solver->equation);
+	std::vector<int> methods(2 * solver->app->dim);
 	for (int i = 0; i < solver->app->dim; ++i) {
 		for (int minmax = 0; minmax < 2; ++minmax) {
-			int boundaryKernelIndex = gravEqn->gravityGetBoundaryKernelForBoundaryMethod(i, minmax);
-			if (boundaryKernelIndex < 0 || boundaryKernelIndex >= (int)solver->boundaryKernels.size()) continue;
-			cl::Kernel& kernel = solver->boundaryKernels[boundaryKernelIndex][i][minmax];
-			CLCommon::setArgs(kernel, potentialBuffer, 1, 0);
-			solver->getBoundaryRanges(i, offset, global, local);
-			commands.enqueueNDRangeKernel(kernel, offset, global, local);
+			methods[minmax + 2 * i] = gravEqn->gravityGetBoundaryKernelForBoundaryMethod(i, minmax);
 		}
 	}
+	solver->updateBoundaryMethods(potentialBoundaryMethodsBuffer, potentialBoundaryMethodsVec, methods);
+	solver->applyBoundary(potentialBuffer, 1, potentialBoundaryMethodsBuffer);
 }
 	
 cl::Buffer SelfGravitation::getPotentialBuffer() {
@@ -147,5 +234,9 @@ cl::Buffer SelfGravitation::getSolidBuffer() {
 	return solidBuffer;
 }
 
+cl::Buffer SelfGravitation::getKernelSolidBuffer() {
+	return fluidDispatch ? solidBitsBuffer : solidBuffer;
+}
+
 }
 }
@@ -1,7 +1,11 @@
 #include "HydroGPU/Solver/Solver.h"
+#include "HydroGPU/Solver/Autotuner.h"
 #include "HydroGPU/Integrator/ForwardEuler.h"
 #include "HydroGPU/Integrator/RungeKutta.h"
-#include "HydroGPU/Integrator/BackwardEulerConjugateGradient.h"
+#include "HydroGPU/Integrator/LowStorageRungeKutta.h"
+#include "HydroGPU/Integrator/EmbeddedRungeKutta.h"
+#include "HydroGPU/Integrator/BackwardEulerNewtonKrylov.h"
+#include "HydroGPU/Integrator/IMEXRungeKutta.h"
 #include "HydroGPU/Plot/VectorField.h"
 #include "HydroGPU/Plot/Plot.h"
 #include "HydroGPU/Boundary/Boundary.h"
@@ -10,6 +14,18 @@
 #include "HydroGPU/toNumericString.h"
 #include "Image/Image.h"
 #include "Common/File.h"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 namespace HydroGPU {
 namespace Solver {
@@ -28,7 +44,12 @@ CL_DEVICE_VERSION:	OpenCL 1.2
 CL_DRIVER_VERSION:	1.2 (Jan 11 2016 18:56:15)
 */
 	cl::Event event;
-	solver->commands.enqueueFillBuffer(buffer, 0.f, 0, size, NULL, &event);
+	if (size % sizeof(float)) {
+		//half storage buffers needn't be a multiple of the float pattern size
+		solver->commands.enqueueFillBuffer(buffer, (cl_ushort)0, 0, size, NULL, &event);
+	} else {
+		solver->commands.enqueueFillBuffer(buffer, 0.f, 0, size, NULL, &event);
+	}
 }
 
 cl::Buffer Solver::CL::alloc(size_t size, const std::string& name) {
@@ -40,17 +61,135 @@ cl::Buffer Solver::CL::alloc(size_t size, const std::string& name) {
 Solver::Solver(HydroGPUApp* app_)
 : app(app_)
 , commands(app->clCommon->commands)
+, boundaryRemap(false)
+, derivOverwrite(false)
+, singlePassRHS(false)
+, precision("double")
+, realSize(sizeof(double))
+, storageSize(sizeof(double))
+, conservationDiagnostic(false)
 , frame(0)
 , cl(this)
 {
 }
 
+//order matches the SLOPE_LIMITER_* values in SlopeLimiter.cl
+const std::vector<std::string> Solver::slopeLimiterNames = {
+	"DonorCell",
+	"LaxWendroff",
+	"BeamWarming",
+	"Fromm",
+	"CHARM",
+	"HCUS",
+	"HQUICK",
+	"Koren",
+	"MinMod",
+	"Oshker",
+	"Ospre",
+	"Smart",
+	"Sweby",
+	"UMIST",
+	"VanAlbada1",
+	"VanAlbada2",
+	"VanLeer",
+	"MonotizedCentral",
+	"Superbee",
+	"BarthJespersen",
+};
+
 void Solver::init() {
 	//we need this first, so don't trust child classes to assign it prior to calling Super::init
 	//instead make them provide this method
 	//TODO non-virtual init() and make it call out construction code in a particular order
 	createEquation();
 
+	app->lua["boundaryRemap"] >> boundaryRemap;
+	if (boundaryRemap && !canRemapBoundary()) {
+		std::cout << "solver " << name() << " doesn't support boundaryRemap -- using ghost cells" << std::endl;
+		boundaryRemap = false;
+	}
+
+	app->lua["singlePassRHS"] >> singlePassRHS;
+	if (singlePassRHS && !canSinglePassRHS()) {
+		std::cout << "solver " << name() << " doesn't support singlePassRHS -- integrating its terms separately" << std::endl;
+		singlePassRHS = false;
+	}
+
+	app->lua["precision"] >> precision;
+	if (precision != "double" && precision != "single" && precision != "mixed" && precision != "half") {
+		throw Common::Exception() << "unknown precision " << precision;
+	}
+	if (precision == "half" && !app->hasFP16) {
+		std::cout << "device doesn't support fp16 -- using mixed precision" << std::endl;
+		precision = "mixed";
+	}
+	if ((precision == "mixed" || precision == "half") && !canMixPrecision()) {
+		std::cout << "solver " << name() << " doesn't support " << precision << " precision -- using double" << std::endl;
+		precision = "double";
+	}
+	if (!app->hasFP64 && precision != "single") {
+		std::cout << "device doesn't support fp64 -- using single precision arithmetic" << std::endl;
+		if (precision != "half") precision = "single";
+	}
+	realSize = precision == "single" || !app->hasFP64 ? sizeof(float) : sizeof(double);
+	if (precision == "double") {
+		storageSize = sizeof(double);
+	} else if (precision == "half") {
+		storageSize = sizeof(cl_half);
+	} else {
+		storageSize = sizeof(float);
+	}
+
+	app->lua["conservationDiagnostic"] >> conservationDiagnostic;
+
+	std::string slopeLimiterName = "Superbee";
+	app->lua["slopeLimiter"] >> slopeLimiterName;
+	std::vector<std::string>::const_iterator slopeLimiterIter = std::find(slopeLimiterNames.begin(), slopeLimiterNames.end(), slopeLimiterName);
+	if (slopeLimiterIter == slopeLimiterNames.end()) throw Common::Exception() << "unknown slope limiter " << slopeLimiterName;
+	slopeLimiter = slopeLimiterIter - slopeLimiterNames.begin();
+
+	runtimeDefs = canRuntimeDefs();
+	readDefs();
+
+	//the integrator is picked here, but constructed once the program is built
+	typedef std::function<std::shared_ptr<HydroGPU::Integrator::Integrator>()> gen_t;
+	typedef std::map<std::string, std::pair<gen_t, bool>> gensMap_t;
+	gensMap_t gens;
+#define MAKE_INTEGRATOR(integrator) gens[#integrator] = std::make_pair([=]()->std::shared_ptr<HydroGPU::Integrator::Integrator> { return std::make_shared<HydroGPU::Integrator::integrator>(this); }, (bool)HydroGPU::Integrator::integrator::accumulatesDeriv)
+	MAKE_INTEGRATOR(ForwardEuler);
+	MAKE_INTEGRATOR(RungeKutta2);
+	MAKE_INTEGRATOR(RungeKutta2Heun);
+	MAKE_INTEGRATOR(RungeKutta2Ralston);
+	MAKE_INTEGRATOR(RungeKutta3);
+	MAKE_INTEGRATOR(RungeKutta4);
+	MAKE_INTEGRATOR(RungeKutta4_3_8thsRule);
+	MAKE_INTEGRATOR(BackwardEulerNewtonKrylov);
+	MAKE_INTEGRATOR(RungeKutta2TVD);
+	MAKE_INTEGRATOR(RungeKutta2NonTVD);
+	MAKE_INTEGRATOR(RungeKutta3TVD);
+	MAKE_INTEGRATOR(RungeKutta4TVD);
+	MAKE_INTEGRATOR(RungeKutta4NonTVD);
+	MAKE_INTEGRATOR(LowStorageRungeKutta3);
+	MAKE_INTEGRATOR(LowStorageRungeKutta4);
+	MAKE_INTEGRATOR(BogackiShampine32);
+	MAKE_INTEGRATOR(DormandPrince54);
+	MAKE_INTEGRATOR(IMEXRungeKuttaARS222);
+	MAKE_INTEGRATOR(IMEXRungeKuttaSSP2_222);
+#undef MAKE_INTEGRATOR
+	//pick the integrator
+	std::string integratorName = "ForwardEuler";
+	app->lua["integratorName"] >> integratorName;
+	
+	gensMap_t::iterator i = gens.find(integratorName);
+	if (i == gens.end()) {
+		throw Common::Exception() << "failed to find integrator named " << integratorName;
+	}
+	gen_t makeIntegrator = i->second.first;
+	derivOverwrite = canDerivOverwrite() && !i->second.second;
+
+	app->lua["programCache"] >> programCache;
+	app->lua["programCacheDir"] >> programCacheDir;
+
 	cl::Device device = app->clCommon->device;
 	
 	// NDRanges
@@ -127,25 +266,170 @@ OR I could just have the debug printfs also output their thread ID and filter al
 		break;
 	}
 
+	//a local size of 1 would never reduce anything
+	reduceLocalSize = cl::NDRange(std::max<size_t>(localSize1d[0], 16));
+
+	if (!tuning && app->autotune) Autotuner(app).find(this, tunedLocalSize, tunedBuildOptions);
+	if ((int)tunedLocalSize.size() == app->dim) {
+		switch (app->dim) {
+		case 1:
+			localSize = cl::NDRange(tunedLocalSize[0]);
+			break;
+		case 2:
+			localSize = cl::NDRange(tunedLocalSize[0], tunedLocalSize[1]);
+			break;
+		case 3:
+			localSize = cl::NDRange(tunedLocalSize[0], tunedLocalSize[1], tunedLocalSize[2]);
+			break;
+		}
+	}
+
+	{
+		size_t offsetVec[3], interiorVec[3], interfaceVec[3], paddedVec[3];
+		for (int n = 0; n < app->dim; ++n) {
+			size_t l = localSize[n];
+			auto roundUp = [&](size_t x) -> size_t { return (x + l - 1) / l * l; };
+			offsetVec[n] = 2;
+			interiorVec[n] = roundUp(app->size.s[n] - 4);
+			interfaceVec[n] = roundUp(app->size.s[n] - 3);
+			paddedVec[n] = roundUp(app->size.s[n]);
+		}
+		auto makeRange = [&](const size_t* v) -> cl::NDRange {
+			switch (app->dim) {
+			case 1:
+				return cl::NDRange(v[0]);
+			case 2:
+				return cl::NDRange(v[0], v[1]);
+			}
+			return cl::NDRange(v[0], v[1], v[2]);
+		};
+		offsetInterior = makeRange(offsetVec);
+		globalSizeInterior = makeRange(interiorVec);
+		globalSizeInterface = makeRange(interfaceVec);
+		globalSizePadded = makeRange(paddedVec);
+	}
+
 	std::cout << "global_size\t" << globalSize << std::endl;
 	std::cout << "local_size\t" << localSize << std::endl;
 	
-	{
-		std::vector<std::string> sourceStrs = getProgramSources();
+	buildProgram();
+
+	initBuffers();
+	initKernels();
+	
+	integrator = makeIntegrator();
+}
+
+
+//adds every file #include'd by 'source' (recursively), found the same way as the "-I include -I ." build options
+static void appendIncludes(std::string& key, const std::string& source, std::set<std::string>& visited) {
+	std::istringstream ss(source);
+	std::string line;
+	while (std::getline(ss, line)) {
+		size_t start = line.find("#include \"");
+		if (start == std::string::npos) continue;
+		start += strlen("#include \"");
+		size_t end = line.find('"', start);
+		if (end == std::string::npos) continue;
+		std::string name = line.substr(start, end - start);
+		if (!visited.insert(name).second) continue;
+		for (const std::string& dir : {std::string("include/"), std::string()}) {
+			std::string filename = dir + name;
+			if (!Common::File::exists(filename)) continue;
+			std::string contents = Common::File::read(filename);
+			key += filename + "\n" + contents;
+			appendIncludes(key, contents, visited);
+			break;
+		}
+	}
+}
+
+std::string Solver::getProgramCacheKey(const std::vector<std::string>& sourceStrs, const std::string& buildOptions) {
+	cl::Device device = app->clCommon->device;
+	std::string key = buildOptions + "\n"
+		+ device.getInfo<CL_DEVICE_NAME>() + "\n"
+		+ device.getInfo<CL_DEVICE_VENDOR>() + "\n"
+		+ device.getInfo<CL_DEVICE_VERSION>() + "\n"
+		+ device.getInfo<CL_DRIVER_VERSION>() + "\n";
+	std::set<std::string> visited;
+	for (const std::string& source : sourceStrs) {
+		key += source;
+		appendIncludes(key, source, visited);
+	}
+	return key;
+}
+
+static void makeDirectory(const std::string& dir) {
+#ifdef _WIN32
+	_mkdir(dir.c_str());
+#else
+	mkdir(dir.c_str(), 0755);
+#endif
+}
+
+//the hash only picks the file.  the file starts with the whole key, which is checked before its binary is used
+std::string Solver::getProgramCacheFilename(const std::string& key) {
+	std::ostringstream ss;
+	ss << programCacheDir << "/program-" << std::hex << std::hash<std::string>()(key) << ".cl.bin";
+	return ss.str();
+}
+
+//"<key length>\n<key><binary>"
+static bool readProgramCache(const std::string& filename, const std::string& key, std::string& binary) {
+	std::string contents = Common::File::read(filename);
+	size_t newline = contents.find('\n');
+	if (newline == std::string::npos) return false;
+	size_t keyLength = (size_t)strtoull(contents.substr(0, newline).c_str(), nullptr, 10);
+	if (contents.size() - newline - 1 < keyLength || contents.compare(newline + 1, keyLength, key) != 0) return false;
+	binary = contents.substr(newline + 1 + keyLength);
+	return !binary.empty();
+}
+
+void Solver::buildProgram() {
+	cl::Device device = app->clCommon->device;
+	std::string buildOptions = "-I include -I .";// -Werror -cl-fast-relaxed-math";
+	if (!tunedBuildOptions.empty()) buildOptions += " " + tunedBuildOptions;
+	std::vector<std::string> sourceStrs = getProgramSources();
+
+	std::string cacheKey, cacheFilename;
+	if (programCache) {
+		cacheKey = getProgramCacheKey(sourceStrs, buildOptions);
+		cacheFilename = getProgramCacheFilename(cacheKey);
+	}
+
+	std::string binary;
+	if (!cacheFilename.empty() && Common::File::exists(cacheFilename) && !readProgramCache(cacheFilename, cacheKey, binary)) {
+		std::cout << "cached program " << cacheFilename << " is for a different program -- rebuilding" << std::endl;
+	}
+	if (!binary.empty()) {
+		try {
 #if defined(CL_HPP_TARGET_OPENCL_VERSION) && CL_HPP_TARGET_OPENCL_VERSION>=200
-		program = cl::Program(app->clCommon->context, sourceStrs);
+			cl::Program::Binaries binaries = {std::vector<unsigned char>(binary.begin(), binary.end())};
 #else
-		std::vector<std::pair<const char *, size_t>> sources;
-		for (const std::string &s : sourceStrs) {
-std::cout << s;
-			sources.push_back(std::pair<const char *, size_t>(s.c_str(), s.length()));
-		}
-		program = cl::Program(app->clCommon->context, sources);
+			cl::Program::Binaries binaries = {std::make_pair((const void*)binary.data(), binary.size())};
 #endif	//CL_HPP_TARGET_OPENCL_VERSION
+			program = cl::Program(app->clCommon->context, {device}, binaries);
+			program.build({device}, buildOptions.c_str());
+			std::cout << "loaded cached program " << cacheFilename << std::endl;
+			return;
+		} catch (std::exception& err) {	//cl::Error.  i.e. a driver that won't take an old binary
+			std::cout << "failed to load cached program " << cacheFilename << " -- rebuilding" << std::endl;
+		}
+	}
+
+#if defined(CL_HPP_TARGET_OPENCL_VERSION) && CL_HPP_TARGET_OPENCL_VERSION>=200
+	program = cl::Program(app->clCommon->context, sourceStrs);
+#else
+	std::vector<std::pair<const char *, size_t>> sources;
+	for (const std::string &s : sourceStrs) {
+std::cout << s;
+		sources.push_back(std::pair<const char *, size_t>(s.c_str(), s.length()));
 	}
+	program = cl::Program(app->clCommon->context, sources);
+#endif	//CL_HPP_TARGET_OPENCL_VERSION
 
 	try {
-		program.build({device}, "-I include -I .");// -Werror -cl-fast-relaxed-math");
+		program.build({device}, buildOptions.c_str());
 	} catch (std::exception& err) {	//cl::Error
 		throw Common::Exception() 
 			<< "failed to build program executable!\n"
@@ -154,112 +438,81 @@ std::cout << s;
 
 	//warnings?
 	std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << std::endl;
-	
-	//for curiousity's sake
-#ifndef PLATFORM_linux
-	if (app->clCommon->useGPU) {
-		cl_int err;
-		
-		size_t size = 0;
-		err = clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &size, nullptr);
-		if (err != CL_SUCCESS) throw Common::Exception() << "failed to get binary size";
-	
-		std::vector<char> binary(size);
-		err = clGetProgramInfo(program(), CL_PROGRAM_BINARIES, size, &binary[0], nullptr);
-		if (err != CL_SUCCESS) throw Common::Exception() << "failed to get binary";
 
-		Common::File::write("program.cl.bin", std::string(&binary[0], binary.size()));
+	if (cacheFilename.empty()) return;
+
+	cl_int err;
+	size_t size = 0;
+	err = clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &size, nullptr);
+	if (err != CL_SUCCESS || !size) {
+		std::cout << "failed to get program binary size -- not caching" << std::endl;
+		return;
 	}
-#endif
 
-	initBuffers();
-	initKernels();
-	
-	typedef std::map<std::string, std::function<std::shared_ptr<HydroGPU::Integrator::Integrator>()>> gensMap_t;
-	gensMap_t gens;
-#define MAKE_INTEGRATOR(integrator) gens[#integrator] = [=]()->std::shared_ptr<HydroGPU::Integrator::Integrator> { return std::make_shared<HydroGPU::Integrator::integrator>(this); }
-	MAKE_INTEGRATOR(ForwardEuler);
-	MAKE_INTEGRATOR(RungeKutta2);
-	MAKE_INTEGRATOR(RungeKutta2Heun);
-	MAKE_INTEGRATOR(RungeKutta2Ralston);
-	MAKE_INTEGRATOR(RungeKutta3);
-	MAKE_INTEGRATOR(RungeKutta4);
-	MAKE_INTEGRATOR(RungeKutta4_3_8thsRule);
-	MAKE_INTEGRATOR(BackwardEulerConjugateGradient);
-	MAKE_INTEGRATOR(RungeKutta2TVD);
-	MAKE_INTEGRATOR(RungeKutta2NonTVD);
-	MAKE_INTEGRATOR(RungeKutta3TVD);
-	MAKE_INTEGRATOR(RungeKutta4TVD);
-	MAKE_INTEGRATOR(RungeKutta4NonTVD);
-#undef MAKE_INTEGRATOR
-	//create integrator
-	std::string integratorName = "ForwardEuler";
-	app->lua["integratorName"] >> integratorName;
-	
-	gensMap_t::iterator i = gens.find(integratorName);
-	if (i == gens.end()) {
-		throw Common::Exception() << "failed to find integrator named " << integratorName;
+	//CL_PROGRAM_BINARIES wants an array of pointers, one per device
+	std::vector<char> built(size);
+	char* binaryPtr = &built[0];
+	err = clGetProgramInfo(program(), CL_PROGRAM_BINARIES, sizeof(binaryPtr), &binaryPtr, nullptr);
+	if (err != CL_SUCCESS) {
+		std::cout << "failed to get program binary -- not caching" << std::endl;
+		return;
 	}
 
-	integrator = i->second();
+	makeDirectory(programCacheDir);
+	Common::File::write(cacheFilename, std::to_string(cacheKey.size()) + "\n" + cacheKey + std::string(&built[0], built.size()));
 }
 
-
 void Solver::initBuffers() {
 	int volume = getVolume();
 
 	//not necessary for fixed timestep.  TODO don't allocate in that case.
-	dtBuffer = cl.alloc(sizeof(real) * volume * app->dim, "Solver::dtBuffer");
-	dtSwapBuffer = cl.alloc(sizeof(real) * volume * app->dim / localSize1d[0], "Solver::dtSwapBuffer");
+	dtBuffer = cl.alloc(realSize * volume * app->dim, "Solver::dtBuffer");
+	//one result per work group of the first findMinTimestep pass
+	dtSwapBuffer = cl.alloc(realSize * ((volume * app->dim + reduceLocalSize[0] - 1) / reduceLocalSize[0]), "Solver::dtSwapBuffer");
 	
-	stateBuffer = cl.alloc(sizeof(real) * numStates() * volume, "Solver::stateBuffer");
+	stateBuffer = cl.alloc(storageSize * numStates() * volume, "Solver::stateBuffer");
+	
+	boundaryMethodsBuffer = cl.alloc(sizeof(int) * numStates() * 2 * app->dim, "Solver::boundaryMethodsBuffer");
+
+	defsBuffer = cl.alloc(realSize * std::max<size_t>(1, defNames.size()), "Solver::defsBuffer");
+	updateDefs();
+
+	if (conservationDiagnostic) {
+		size_t numGroups = (volume + localSize1d[0] - 1) / localSize1d[0];
+		stateSumsBuffer = cl.alloc(realSize * numStates() * numGroups, "Solver::stateSumsBuffer");
+	}
 	
 	//get the edges, so reduction doesn't
 	{
 		std::vector<real> dtVec(volume * app->dim);
 		for (real &r : dtVec) { r = std::numeric_limits<real>::max(); }
-		commands.enqueueWriteBuffer(dtBuffer, CL_TRUE, 0, sizeof(real) * volume * app->dim, &dtVec[0]);
+		writeReals(dtBuffer, dtVec.data(), dtVec.size(), realSize);
 	}
 }
 
-static std::string boundaryKernelNames[NUM_BOUNDARY_KERNELS] = {
-	"Periodic",
-	"Mirror",
-	"Reflect",
-	"FreeFlow"
-};
-
 void Solver::initKernels() {
 	
 	int volume = getVolume();
 
-	boundaryKernels.resize(NUM_BOUNDARY_KERNELS);
-	for (std::vector<std::vector<cl::Kernel>>& v : boundaryKernels) {
-		v.resize(app->dim);
-		for (std::vector<cl::Kernel>& u : v) {
-			u.resize(2);
-		}
-	}
-
-	std::vector<std::string> dimNames = {"X", "Y", "Z"};
-	std::vector<std::string> minmaxNames = {"Min", "Max"};
-	for (int boundaryIndex = 0; boundaryIndex < NUM_BOUNDARY_KERNELS; ++boundaryIndex) {
-		for (int dimIndex = 0; dimIndex < app->dim; ++dimIndex) {
-			for (int minmaxIndex = 0; minmaxIndex < 2; ++minmaxIndex) {
-				std::string name = "stateBoundary" + boundaryKernelNames[boundaryIndex] + dimNames[dimIndex] + minmaxNames[minmaxIndex];
-				cl::Kernel kernel = cl::Kernel(program, name.c_str());
-				boundaryKernels[boundaryIndex][dimIndex][minmaxIndex] = kernel;
-			}
-		}
-	}
+	boundaryKernel = cl::Kernel(program, "stateBoundary");
 	
 	findMinTimestepKernel = cl::Kernel(program, "findMinTimestep");
-	CLCommon::setArgs(findMinTimestepKernel, dtBuffer, cl::Local(localSize1d[0] * sizeof(real)), volume * app->dim, dtSwapBuffer);
+	CLCommon::setArgs(findMinTimestepKernel, dtBuffer, cl::Local(reduceLocalSize[0] * realSize), volume * app->dim, dtSwapBuffer);
+
+	if (conservationDiagnostic) {
+		sumStatesKernel = cl::Kernel(program, "sumStates");
+		CLCommon::setArgs(sumStatesKernel, stateSumsBuffer, stateBuffer, cl::Local(localSize1d[0] * realSize));
+	}
 }
 
 std::vector<std::string> Solver::getProgramSources() {
+	std::string precisionDefine;
+	if (realSize == sizeof(float)) precisionDefine += "#define PRECISION_SINGLE 1\n";
+	if (precision == "mixed") precisionDefine += "#define PRECISION_MIXED 1\n";
+	if (precision == "half") precisionDefine += "#define PRECISION_HALF 1\n";
+
 	std::vector<std::string> sourceStrs = std::vector<std::string>{
-		std::string() +
+		precisionDefine +
 		"#include \"HydroGPU/Shared/Common.h\"\n" +
 		"#define DIM " + std::to_string(app->dim) + "\n" +
 		"#define SIZE_X " + std::to_string(app->size.s[0]) + "\n" +
@@ -279,31 +532,46 @@ std::vector<std::string> Solver::getProgramSources() {
 		"#define YMAX " + toNumericString<real>(app->xmax.s[1]) + "\n" +
 		"#define ZMAX " + toNumericString<real>(app->xmax.s[2]) + "\n" +
 		"#define NUM_STATES " + std::to_string(numStates()) + "\n" +
-		"#define NUM_FLUX_STATES "+std::to_string(getNumFluxStates())+"\n"
+		"#define NUM_FLUX_STATES "+std::to_string(getNumFluxStates())+"\n" +
+		"#define BOUNDARY_KERNEL_NONE " + std::to_string(BOUNDARY_KERNEL_NONE) + "\n" +
+		"#define BOUNDARY_KERNEL_PERIODIC " + std::to_string(BOUNDARY_KERNEL_PERIODIC) + "\n" +
+		"#define BOUNDARY_KERNEL_MIRROR " + std::to_string(BOUNDARY_KERNEL_MIRROR) + "\n" +
+		"#define BOUNDARY_KERNEL_REFLECT " + std::to_string(BOUNDARY_KERNEL_REFLECT) + "\n" +
+		"#define BOUNDARY_KERNEL_FREEFLOW " + std::to_string(BOUNDARY_KERNEL_FREEFLOW) + "\n"
 	};
 
-	std::string slopeLimiterName = "Superbee";
-	app->lua["slopeLimiter"] >> slopeLimiterName;
-	sourceStrs[0] += "#define SLOPE_LIMITER_" + slopeLimiterName + "\n";
+	if (boundaryRemap) sourceStrs[0] += "#define BOUNDARY_REMAP 1\n";
+	if (derivOverwrite) sourceStrs[0] += "#define DERIV_OVERWRITE 1\n";
+	if (singlePassRHS) sourceStrs[0] += "#define SINGLE_PASS_RHS 1\n";
+
+	for (int i = 0; i < (int)slopeLimiterNames.size(); ++i) {
+		sourceStrs[0] += "#define SLOPE_LIMITER_" + slopeLimiterNames[i] + " " + std::to_string(i) + "\n";
+	}
+
+	//there's no OpenCL equivalent of OpenGL uniforms, so the numeric defs go in a struct that the kernels using them take as a __constant arg
+	//it has to be declared before the #defines below, or its members would get expanded
+	sourceStrs[0] += "typedef struct {\n";
+	for (const std::string& name : defNames) {
+		sourceStrs[0] += "\treal " + name + ";\n";
+	}
+	if (defNames.empty()) sourceStrs[0] += "\treal unused;\n";	//no empty structs
+	sourceStrs[0] += "} Defs;\n";
 
 	LuaCxx::Ref defs = app->lua["defs"];
 	for (LuaCxx::Ref::iterator i = defs.begin(); i != defs.end(); ++i) {
 		std::string keyStr = (std::string)i.key;
+		
+		//a macro doesn't expand inside its own expansion, so this leaves the member name alone
+		if (runtimeDefs && std::find(defNames.begin(), defNames.end(), keyStr) != defNames.end()) {
+			sourceStrs[0] += "#define " + keyStr + " (defs->" + keyStr + ")\n";
+			continue;
+		}
+
 		//TODO 'toNumericString' should be 'toOpenCLNumber' ?
 		//NOTICE - I'm wrapping all strings with ()'s, incase they are expressions
 		// is there any situation where that's a bad idea?
 		std::string valueStr = (std::string)i.value;
-		
-		//if you want to define them ...
 		sourceStrs[0] += std::string("#define ") + keyStr + std::string(" ((real)") + valueStr + ")\n";
-		//if you want them as variables (for further manipulation)
-		//sourceStrs[0] += std::string("constant real ") + keyStr + " = (real)" + valueStr + ";\n";
-		//honestly there's no difference.  there's nothing in OpenCL to let you maniuplate it from the outside. 
-		// there's no OpenCL equivalent of OpenGL uniforms.
-		//sites say to use a single structure of parameters and pass that into all kernels
-		//but my kernels are getting full as it is...
-		//one fix for that (the AoS way?) is to just pass a single pointer in, and have the kernels offset into it accordingly
-		//but that means ugly memory management on the C++ and OpenCL side of things...
 	}
 
 	sourceStrs.push_back("#include \"SlopeLimiter.cl\"\n");
@@ -332,12 +600,12 @@ void Solver::Converter::setValues(int index, const std::vector<real>& cellValues
 
 void Solver::Converter::toGPU() {
 	//write state density first for gravity potential, to then update energy
-	solver->commands.enqueueWriteBuffer(solver->stateBuffer, CL_TRUE, 0, sizeof(real) * solver->numStates() * solver->getVolume(), stateVec.data());
+	solver->writeReals(solver->stateBuffer, stateVec.data(), stateVec.size(), solver->storageSize);
 	solver->commands.finish();
 }
 
 void Solver::Converter::fromGPU() {
-	solver->commands.enqueueReadBuffer(solver->stateBuffer, CL_TRUE, 0, sizeof(real) * solver->numStates() * solver->getVolume(), stateVec.data());
+	solver->readReals(solver->stateBuffer, stateVec.data(), stateVec.size(), solver->storageSize);
 	solver->commands.finish();
 }
 
@@ -349,6 +617,10 @@ real Solver::Converter::getValue(int index, int channel) {
 
 void Solver::resetState() {
 	if (!app->lua["initState"].isFunction()) throw Common::Exception() << "expected initState to be defined in config file";
+	
+	//initial conditions' setup() can change defs (like the heat capacity ratio)
+	readDefs();
+	updateDefs();
 	std::cout << "initializing..." << std::endl;
 	
 	std::shared_ptr<Converter> converter = createConverter();
@@ -389,6 +661,36 @@ void Solver::resetState() {
 
 	//pass context to child class 
 	converter->toGPU();
+
+	if (conservationDiagnostic) {
+		initialStateSums = getStateSums();
+		
+		//compare against the CPU copy to see what storing it cost
+		int n = numStates();
+		std::vector<real> cpuSums(n);
+		for (index[2] = 0; index[2] < app->size.s[2]; ++index[2]) {
+			for (index[1] = 0; index[1] < app->size.s[1]; ++index[1]) {
+				for (index[0] = 0; index[0] < app->size.s[0]; ++index[0]) {
+					bool interior = true;
+					for (int i = 0; i < app->dim; ++i) {
+						interior &= index[i] >= 2 && index[i] < app->size.s[i] - 2;
+					}
+					if (!interior) continue;
+					int cellIndex = index[0] + app->size.s[0] * (index[1] + app->size.s[1] * index[2]);
+					for (int j = 0; j < n; ++j) {
+						cpuSums[j] += converter->stateVec[j + n * cellIndex];
+					}
+				}
+			}
+		}
+		std::cout << "conservation storage error";
+		for (int j = 0; j < n; ++j) {
+			real error = initialStateSums[j] - cpuSums[j];
+			if (cpuSums[j] != 0) error /= fabs(cpuSums[j]);
+			std::cout << " " << equation->states[j] << " " << error;
+		}
+		std::cout << std::endl;
+	}
 }
 
 int Solver::numStates() {
@@ -410,29 +712,31 @@ int Solver::getVolume() {
 }
 
 void Solver::getBoundaryRanges(int dimIndex, cl::NDRange &offset, cl::NDRange &global, cl::NDRange &local) {
+	//the boundary kernel skips the padding past SIZE_*, so round up to the local size
+	auto roundUp = [](size_t x, size_t l) -> size_t { return (x + l - 1) / l * l; };
 	switch (app->dim) {
 	case 1:
 		offset = offset1d;
 		local = localSize1d;
-		global = cl::NDRange(app->size.s[dimIndex]);
+		global = cl::NDRange(roundUp(app->size.s[dimIndex], localSize1d[0]));
 		break;
 	case 2:
 		offset = offset1d;
 		local = localSize1d;
-		global = cl::NDRange(app->size.s[!dimIndex]);
+		global = cl::NDRange(roundUp(app->size.s[!dimIndex], localSize1d[0]));
 		break;
 	case 3:
 		offset = cl::NDRange(0, 0);
 		local = cl::NDRange(localSize[0], localSize[1]);
 		switch (dimIndex) {
 		case 0:
-			global = cl::NDRange(app->size.s[1], app->size.s[2]);
+			global = cl::NDRange(roundUp(app->size.s[1], localSize[0]), roundUp(app->size.s[2], localSize[1]));
 			break;
 		case 1:
-			global = cl::NDRange(app->size.s[0], app->size.s[2]);
+			global = cl::NDRange(roundUp(app->size.s[0], localSize[0]), roundUp(app->size.s[2], localSize[1]));
 			break;
 		case 2:
-			global = cl::NDRange(app->size.s[0], app->size.s[1]);
+			global = cl::NDRange(roundUp(app->size.s[0], localSize[0]), roundUp(app->size.s[1], localSize[1]));
 			break;
 		default:
 			throw Common::Exception() << "can't handle dim " << dimIndex;
@@ -443,26 +747,47 @@ void Solver::getBoundaryRanges(int dimIndex, cl::NDRange &offset, cl::NDRange &g
 	}
 }
 
+std::vector<int> Solver::getBoundaryMethods() {
+	int n = numStates();
+	std::vector<int> methods(n * 2 * app->dim);
+	for (int i = 0; i < app->dim; ++i) {
+		for (int minmax = 0; minmax < 2; ++minmax) {
+			for (int j = 0; j < n; ++j) {
+				int boundaryKernelIndex = equation->stateGetBoundaryKernelForBoundaryMethod(i, j, minmax);
+				if (boundaryKernelIndex < 0 || boundaryKernelIndex >= NUM_BOUNDARY_KERNELS) boundaryKernelIndex = BOUNDARY_KERNEL_NONE;
+				methods[j + n * (minmax + 2 * i)] = boundaryKernelIndex;
+			}
+		}
+	}
+	return methods;
+}
+
+void Solver::updateBoundaryMethods(cl::Buffer methodsBuffer, std::vector<int>& cachedVec, const std::vector<int>& methodsVec) {
+	//the boundary methods can be changed from the gui at any time, but rarely are
+	if (cachedVec == methodsVec) return;
+	cachedVec = methodsVec;
+	commands.enqueueWriteBuffer(methodsBuffer, CL_TRUE, 0, sizeof(int) * cachedVec.size(), cachedVec.data());
+}
+
 //on AMD, 2D problem boundaries <512 work fine (once variables are manually inlined in the kernels).
 // beyond 512 gets mysery errors.
-void Solver::boundary() {
+void Solver::applyBoundary(cl::Buffer buffer, int spacing, cl::Buffer methodsBuffer) {
 	cl::NDRange offset, global, local;
+	CLCommon::setArgs(boundaryKernel, buffer, spacing, 0, methodsBuffer);
 	for (int i = 0; i < app->dim; ++i) {
 		getBoundaryRanges(i, offset, global, local);
-		for (int j = 0; j < numStates(); ++j) {
-			for (int minmax = 0; minmax < 2; ++minmax) {
-				int boundaryKernelIndex = equation->stateGetBoundaryKernelForBoundaryMethod(i, j, minmax);
-				if (boundaryKernelIndex < 0 || boundaryKernelIndex >= (int)boundaryKernels.size()) continue;
-				cl::Kernel& kernel = boundaryKernels[boundaryKernelIndex][i][minmax];
-				kernel.setArg(0, stateBuffer);
-				kernel.setArg(1, numStates());
-				kernel.setArg(2, j);
-				commands.enqueueNDRangeKernel(kernel, offset, global, local);
-			}
-		}
+		boundaryKernel.setArg(2, i);
+		commands.enqueueNDRangeKernel(boundaryKernel, offset, global, local);
 	}
 }
 
+void Solver::boundary() {
+	updateBoundaryMethods(boundaryMethodsBuffer, boundaryMethodsVec, getBoundaryMethods());
+	//the kernels read through the boundary methods themselves
+	if (boundaryRemap) return;
+	applyBoundary(stateBuffer, numStates(), boundaryMethodsBuffer);
+}
+
 real Solver::findMinTimestep() {
 	int reduceSize = getVolume() * app->dim;
 	cl::Buffer dst = dtSwapBuffer;
@@ -472,7 +797,7 @@ real Solver::findMinTimestep() {
 auto debugPrint = [&](cl::Buffer buffer, int size){
 	commands.finish();	
 	std::vector<real> dtVec(size);
-	commands.enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(real) * size, dtVec.data());
+	readReals(buffer, dtVec.data(), size, realSize);
 	real dtMin = std::numeric_limits<real>::infinity();
 	int imax = size;
 	for (int i = 0; i < imax; ++i) {
@@ -490,15 +815,15 @@ auto debugPrint = [&](cl::Buffer buffer, int size){
 std::cout << std::endl << "dtBuffer:" << std::endl;
 debugPrint(dtBuffer, reduceSize);
 #endif
+	size_t l = reduceLocalSize[0];
 	while (reduceSize > 1) {
-		//TODO instead of >> 4, make sure it matches whatever localSize1d is
-		// ... which just so happens to be 16 (i.e. 1 << 4) at the moment
-		int nextSize = (reduceSize >> 4) + !!(reduceSize & ((1 << 4) - 1));
-		cl::NDRange reduceGlobalSize(std::max<int>(reduceSize, localSize[0]));
+		//one result per work group.  the kernel only reads [0, reduceSize), so pad up to the local size
+		int nextSize = (reduceSize + l - 1) / l;
+		cl::NDRange reduceGlobalSize(nextSize * l);
 		findMinTimestepKernel.setArg(0, src);
 		findMinTimestepKernel.setArg(2, reduceSize);
 		findMinTimestepKernel.setArg(3, dst);
-		commands.enqueueNDRangeKernel(findMinTimestepKernel, offset1d, reduceGlobalSize, cl::NDRange(std::min(reduceGlobalSize[0], localSize1d[0])));
+		commands.enqueueNDRangeKernel(findMinTimestepKernel, offset1d, reduceGlobalSize, reduceLocalSize);
 		if (app->clCommon->useGPU) commands.finish();
 		std::swap(dst, src);
 		reduceSize = nextSize;
@@ -508,13 +833,175 @@ debugPrint(src, reduceSize);
 #endif
 	}
 	real dt = real();
-	commands.enqueueReadBuffer(src, CL_TRUE, 0, sizeof(real), &dt);
+	readReals(src, &dt, 1, realSize);
 #if 0
 std::cout << "min dt by gpu: " << dt << std::endl;
 #endif
 	return dt * app->cfl;
 }
 
+//whether 'str' is entirely a number, i.e. a def that can go in the Defs struct
+static bool parseReal(const std::string& str, real& value) {
+	const char* begin = str.c_str();
+	char* end = nullptr;
+	value = (real)strtod(begin, &end);
+	return end != begin && *end == '\0';
+}
+
+void Solver::readDefs() {
+	bool firstRead = defValues.empty();
+	LuaCxx::Ref defs = app->lua["defs"];
+	for (LuaCxx::Ref::iterator i = defs.begin(); i != defs.end(); ++i) {
+		std::string name = (std::string)i.key;
+		real value;
+		if (!parseReal((std::string)i.value, value)) continue;
+		std::vector<std::string>::iterator iter = std::find(defNames.begin(), defNames.end(), name);
+		if (iter != defNames.end()) {
+			defValues[iter - defNames.begin()] = value;
+		} else if (firstRead) {
+			defNames.push_back(name);
+			defValues.push_back(value);
+		}
+	}
+}
+
+void Solver::updateDefs() {
+	if (defValues.empty()) return;
+	writeReals(defsBuffer, defValues.data(), defValues.size(), realSize);
+}
+
+void Solver::setRealArg(cl::Kernel& kernel, int index, real value) {
+	if (realSize == sizeof(float)) {
+		kernel.setArg(index, (float)value);
+	} else {
+		kernel.setArg(index, (double)value);
+	}
+}
+
+/*
+host side of half storage: IEEE 754 binary16, round to nearest even
+converts through float, which is exact for every half
+*/
+struct Half {
+	cl_half bits;
+	Half() : bits(0) {}
+	Half(real value) : bits(fromFloat((float)value)) {}
+	operator real() const { return (real)toFloat(bits); }
+
+	static cl_half fromFloat(float f) {
+		uint32_t x;
+		memcpy(&x, &f, sizeof(x));
+		uint32_t sign = (x >> 16) & 0x8000;
+		int exponent = (int)((x >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = x & 0x7fffff;
+		if (((x >> 23) & 0xff) == 0xff) return sign | 0x7c00 | (mantissa ? 0x200 : 0);	//inf, nan
+		if (exponent >= 0x1f) return sign | 0x7c00;	//overflow
+		if (exponent <= 0) {	//subnormal
+			if (exponent < -10) return sign;
+			mantissa |= 0x800000;
+			int shift = 14 - exponent;
+			uint32_t result = mantissa >> shift;
+			uint32_t remainder = mantissa & ((1u << shift) - 1);
+			uint32_t halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (result & 1))) ++result;
+			return sign | result;
+		}
+		uint32_t result = ((uint32_t)exponent << 10) | (mantissa >> 13);
+		uint32_t remainder = mantissa & 0x1fff;
+		if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) ++result;	//carries into the exponent, up to inf
+		return sign | result;
+	}
+
+	static float toFloat(cl_half h) {
+		uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+		uint32_t exponent = (h >> 10) & 0x1f;
+		uint32_t mantissa = h & 0x3ff;
+		uint32_t x;
+		if (exponent == 0x1f) {
+			x = sign | 0x7f800000 | (mantissa << 13);
+		} else if (exponent) {
+			x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		} else if (!mantissa) {
+			x = sign;
+		} else {	//subnormal, normalize it
+			exponent = 113;
+			while (!(mantissa & 0x400)) {
+				mantissa <<= 1;
+				--exponent;
+			}
+			x = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+		float f;
+		memcpy(&f, &x, sizeof(f));
+		return f;
+	}
+};
+
+template<typename T>
+static void writeConverted(cl::CommandQueue& commands, cl::Buffer buffer, const real* src, size_t count) {
+	std::vector<T> converted(src, src + count);
+	commands.enqueueWriteBuffer(buffer, CL_TRUE, 0, sizeof(T) * count, converted.data());
+}
+
+template<typename T>
+static void readConverted(cl::CommandQueue& commands, cl::Buffer buffer, real* dst, size_t count) {
+	std::vector<T> converted(count);
+	commands.enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(T) * count, converted.data());
+	std::copy(converted.begin(), converted.end(), dst);
+}
+
+void Solver::writeReals(cl::Buffer buffer, const real* src, size_t count, size_t elementSize) {
+	if (elementSize == sizeof(real)) {
+		commands.enqueueWriteBuffer(buffer, CL_TRUE, 0, sizeof(real) * count, src);
+	} else if (elementSize == sizeof(float)) {
+		writeConverted<float>(commands, buffer, src, count);
+	} else if (elementSize == sizeof(cl_half)) {
+		writeConverted<Half>(commands, buffer, src, count);
+	} else {
+		writeConverted<double>(commands, buffer, src, count);
+	}
+}
+
+void Solver::readReals(cl::Buffer buffer, real* dst, size_t count, size_t elementSize) {
+	if (elementSize == sizeof(real)) {
+		commands.enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(real) * count, dst);
+	} else if (elementSize == sizeof(float)) {
+		readConverted<float>(commands, buffer, dst, count);
+	} else if (elementSize == sizeof(cl_half)) {
+		readConverted<Half>(commands, buffer, dst, count);
+	} else {
+		readConverted<double>(commands, buffer, dst, count);
+	}
+}
+
+std::vector<real> Solver::getStateSums() {
+	int n = numStates();
+	size_t numGroups = (getVolume() + localSize1d[0] - 1) / localSize1d[0];
+	commands.enqueueNDRangeKernel(sumStatesKernel, offset1d, cl::NDRange(numGroups * localSize1d[0]), localSize1d);
+	
+	std::vector<real> partialSums(n * numGroups);
+	readReals(stateSumsBuffer, partialSums.data(), partialSums.size(), realSize);
+	
+	std::vector<real> sums(n);
+	for (size_t group = 0; group < numGroups; ++group) {
+		for (int j = 0; j < n; ++j) {
+			sums[j] += partialSums[j + n * group];
+		}
+	}
+	return sums;
+}
+
+void Solver::reportConservation() {
+	std::vector<real> sums = getStateSums();
+	std::cout << "conservation drift";
+	for (int j = 0; j < numStates(); ++j) {
+		real drift = sums[j] - initialStateSums[j];
+		if (initialStateSums[j] != 0) drift /= fabs(initialStateSums[j]);
+		std::cout << " " << equation->states[j] << " " << drift;
+	}
+	std::cout << std::endl;
+}
+
 void Solver::initStep() {
 }
 
@@ -525,13 +1012,24 @@ void Solver::update() {
 	
 	initStep();
 
-	real dt = app->useFixedDT ? app->fixedDT : calcTimestep();
+	real dt = app->useFixedDT ? app->fixedDT : integrator->limitTimestep(calcTimestep());
 
 	if (app->showTimestep) {
 		std::cout << "dt " << dt << std::endl;
 	}
 
+	integrator->beginStep();
 	step(dt);
+	
+	//the embedded integrators can reject the step, with a fixed dt there's nothing to retry with
+	while (!app->useFixedDT && !integrator->endStep(dt)) {
+		if (app->showTimestep) {
+			std::cout << "rejected, retrying with dt " << dt << std::endl;
+		}
+		step(dt);
+	}
+
+	if (conservationDiagnostic) reportConservation();
 
 	++frame;
 /* 
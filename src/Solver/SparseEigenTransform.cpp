@@ -0,0 +1,165 @@
+#include "HydroGPU/Solver/SparseEigenTransform.h"
+#include "Common/Exception.h"
+#include <algorithm>
+#include <sstream>
+
+namespace HydroGPU {
+namespace Solver {
+
+SparseEigenTransform::SparseEigenTransform(int n_)
+: n(n_)
+, left(n_ * n_, "0")
+, right(n_ * n_, "0")
+{}
+
+static bool isNegated(const std::string& entry) {
+	return !entry.empty() && entry[0] == '-';
+}
+
+static std::string getName(const std::string& entry) {
+	return isNegated(entry) ? entry.substr(1) : entry;
+}
+
+std::vector<std::string> SparseEigenTransform::getSymbols() const {
+	std::vector<std::string> symbols;
+	for (const std::vector<std::string>* matrix : {&left, &right}) {
+		for (const std::string& entry : *matrix) {
+			std::string name = getName(entry);
+			if (name == "0" || name == "1") continue;
+			if (std::find(symbols.begin(), symbols.end(), name) == symbols.end()) symbols.push_back(name);
+		}
+	}
+	return symbols;
+}
+
+int SparseEigenTransform::getSlot(const std::string& symbol) const {
+	std::vector<std::string> symbols = getSymbols();
+	std::vector<std::string>::iterator iter = std::find(symbols.begin(), symbols.end(), symbol);
+	if (iter == symbols.end()) throw Common::Exception() << "SparseEigenTransform couldn't find symbol " << symbol;
+	return iter - symbols.begin();
+}
+
+int SparseEigenTransform::getStructSize() const {
+	//keep at least one so the buffer alloc and pointer math still work for an all-constant pattern
+	return std::max<int>(1, getSymbols().size());
+}
+
+std::string SparseEigenTransform::getRotation(const std::string& var) const {
+	if (rotatedVectors.empty()) return "";
+	std::ostringstream ss;
+	ss << "#if DIM > 1\n";
+	for (int side = 1; side < 3; ++side) {
+		if (side == 2) ss << "#if DIM > 2\n";
+		ss << "\t" << (side == 1 ? "if" : "else if") << " (side == " << side << ") {\n";
+		for (int s : rotatedVectors) {
+			ss << "\t\treal tmp" << s << " = " << var << "[" << s << "]; "
+				<< var << "[" << s << "] = " << var << "[" << (s + side) << "]; "
+				<< var << "[" << (s + side) << "] = tmp" << s << ";\n";
+		}
+		ss << "\t}\n";
+		if (side == 2) ss << "#endif\n";
+	}
+	ss << "#endif\n";
+	return ss.str();
+}
+
+/*
+one line per row, with zeros skipped, +-1 folded,
+and terms of the row that share a stored value pulled into one multiply
+*/
+std::string SparseEigenTransform::getTransformBody(const std::vector<std::string>& matrix, const std::string& input, const std::string& output) const {
+	std::ostringstream ss;
+	for (int i = 0; i < n; ++i) {
+		std::vector<std::string> unitTerms;
+		std::vector<int> groupSlots;
+		std::vector<std::vector<std::string>> groupTerms;
+		for (int j = 0; j < n; ++j) {
+			const std::string& entry = matrix[i + n * j];
+			std::string name = getName(entry);
+			if (name == "0") continue;
+			std::string term = std::string(isNegated(entry) ? "- " : "+ ") + input + "[" + std::to_string(j) + "]";
+			if (name == "1") {
+				unitTerms.push_back(term);
+				continue;
+			}
+			int slot = getSlot(name);
+			std::vector<int>::iterator iter = std::find(groupSlots.begin(), groupSlots.end(), slot);
+			if (iter == groupSlots.end()) {
+				groupSlots.push_back(slot);
+				groupTerms.push_back({term});
+			} else {
+				groupTerms[iter - groupSlots.begin()].push_back(term);
+			}
+		}
+
+		std::string expr;
+		for (const std::string& term : unitTerms) expr += " " + term;
+		for (int k = 0; k < (int)groupSlots.size(); ++k) {
+			std::string coeff = "eigenvector[" + std::to_string(groupSlots[k]) + "]";
+			const std::vector<std::string>& terms = groupTerms[k];
+			if (terms.size() == 1) {
+				expr += " " + terms[0].substr(0, 2) + coeff + " * " + terms[0].substr(2);
+			} else {
+				std::string sum;
+				for (const std::string& term : terms) sum += " " + term;
+				if (sum.substr(0, 3) == " + ") sum = sum.substr(3); else sum = "-" + sum.substr(3);
+				expr += " + " + coeff + " * (" + sum + ")";
+			}
+		}
+		if (expr.empty()) {
+			expr = "0.f";
+		} else if (expr.substr(0, 3) == " + ") {
+			expr = expr.substr(3);
+		} else {
+			expr = "-" + expr.substr(3);
+		}
+		ss << "\t" << output << "[" << i << "] = " << expr << ";\n";
+	}
+	return ss.str();
+}
+
+std::string SparseEigenTransform::getProgramSource() const {
+	std::vector<std::string> symbols = getSymbols();
+	std::ostringstream ss;
+
+	ss << "#include \"HydroGPU/Roe.h\"\n"
+		<< "#define SPARSE_EIGEN_TRANSFORM 1\n"
+		<< "#if EIGEN_SPACE_DIM != NUM_STATES || NUM_STATES != " << n << "\n"
+		<< "#error sparse eigen transform size doesn't match the number of states\n"
+		<< "#endif\n";
+
+	//copy the first appearance of each symbol out of the dense matrices
+	ss << "void packEigenBasis(__global real* dst, const real* left, const real* right);\n"
+		<< "void packEigenBasis(__global real* dst, const real* left, const real* right) {\n";
+	for (int k = 0; k < (int)symbols.size(); ++k) {
+		for (int m = 0; m < 2; ++m) {
+			const std::vector<std::string>& matrix = m == 0 ? left : right;
+			std::vector<std::string>::const_iterator iter = std::find_if(matrix.begin(), matrix.end(), [&](const std::string& entry) -> bool {
+				return getName(entry) == symbols[k];
+			});
+			if (iter == matrix.end()) continue;
+			ss << "\tdst[" << k << "] = " << (isNegated(*iter) ? "-" : "") << (m == 0 ? "left" : "right") << "[" << (iter - matrix.begin()) << "];\n";
+			break;
+		}
+	}
+	ss << "}\n";
+
+	ss << "void leftEigenvectorTransform(real* results, const __global real* eigenvector, const real* input, int side) {\n"
+		<< "\treal x[" << n << "];\n"
+		<< "\tfor (int i = 0; i < " << n << "; ++i) x[i] = input[i];\n"
+		<< getRotation("x")
+		<< getTransformBody(left, "x", "results")
+		<< "}\n";
+
+	ss << "void rightEigenvectorTransform(__global real_storage* results, const __global real* eigenvector, const real* input, int side) {\n"
+		<< "\treal y[" << n << "];\n"
+		<< getTransformBody(right, "input", "y")
+		<< getRotation("y")
+		<< "\tfor (int i = 0; i < " << n << "; ++i) results[i] = y[i];\n"
+		<< "}\n";
+
+	return ss.str();
+}
+
+}
+}